@@ -0,0 +1,612 @@
+// astrolograph-headless -- evaluates a project file without a GUI and dumps chart data (JSON/CSV)
+#include "version/version.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <limits>
+#include <cstring>
+
+#include "astro.hpp"
+#include "angleBatch.hpp"
+#include "aspectPatterns.hpp"
+#include "aspectSweep.hpp"
+#include "ephemeris.hpp"
+#include "ephemerisFiles.hpp"
+#include "projectFile.hpp"
+#include "projectBinary.hpp"
+#include "headlessGraph.hpp"
+
+using namespace astro;
+
+
+// synthetic project -- chains of time/location --> chart --> view nodes (params as saved by the GUI)
+ProjectFile makeSyntheticProject(int nodeCount)
+{
+  static const std::vector<std::pair<std::string, std::map<std::string, std::string>>> CHAIN =
+    { {"TimeNode",      {{"date", "1903 4 22 9 30 0 -5 0"}, {"live", "0"}, {"savedName", ""}}},
+      {"LocationNode",  {{"location", "40.706833333333 -74.011027777778 200 \"America/New_York\" -5"}, {"savedName", "nyse"}}},
+      {"ChartNode",     {{"opt", "active:0|hsys:active;0/choices;Campanus,Equal,Koch,Porphyrius,Placidus,Regiomontanus,Whole Sign,/value;4/|"
+                                 "truePos:active;0/value;0/|zodiac:active;0/choices;Tropical,Sidereal,Draconic,/value;0/|"}}},
+      {"ChartDataNode", {{"showObjs", "1111111111111111111100000"}}} };
+  ProjectFile project;
+  for(int i = 0; i < nodeCount; i++)
+    {
+      int c = i % CHAIN.size();
+      ProjectNode node;
+      node.id     = i;
+      node.type   = CHAIN[c].first;
+      node.name   = "Node" + std::to_string(i);
+      node.params = CHAIN[c].second;
+      node.params["nodeType"]    = node.type;
+      node.params["nodeName"]    = node.name;
+      node.params["nodeId"]      = std::to_string(i);
+      node.params["nodePos"]     = Vec2f((i / CHAIN.size())*420.0f, c*240.0f).toString();
+      node.params["nodeSize"]    = Vec2f(380, 200).toString();
+      node.params["bodySize"]    = Vec2f(320, 180).toString();
+      node.params["inputsSize"]  = Vec2f(40, 60).toString();
+      node.params["outputsSize"] = Vec2f(40, 60).toString();
+      project.addNode(node);
+
+      int base = i - c; // (first node of chain)
+      if(c == 2 && base+1 < nodeCount)
+        {
+          project.addConnection(ProjectConnection{base,   0, i, 0}); // time --> chart date
+          project.addConnection(ProjectConnection{base+1, 0, i, 1}); // location --> chart location
+        }
+      else if(c == 3) { project.addConnection(ProjectConnection{base+2, 0, i, 0}); } // chart --> view
+    }
+  return project;
+}
+
+// times text/binary loading of a synthetic project
+int benchmarkLoad(int nodeCount, std::ostream &out)
+{
+  typedef std::chrono::steady_clock Clock;
+  auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+  const std::string textPath   = "./bench-load.ags";
+  const std::string binaryPath = std::string("./bench-load") + PROJECT_BINARY_EXT;
+  const int runs = 5;
+
+  ProjectFile project = makeSyntheticProject(nodeCount);
+  auto t0 = Clock::now();
+  project.save(textPath);
+  auto t1 = Clock::now();
+  project.save(binaryPath);
+  auto t2 = Clock::now();
+  out << "synthetic project: " << project.nodes().size() << " nodes, " << project.connections().size() << " connections\n"
+      << "  save text:   " << ms(t1-t0) << " ms\n"
+      << "  save binary: " << ms(t2-t1) << " ms\n";
+
+  // best of N runs
+  double textMs = 1e9, openMs = 1e9, convertMs = 1e9;
+  size_t checksum = 0;
+  for(int r = 0; r < runs; r++)
+    {
+      ProjectFile textProject;
+      t0 = Clock::now();
+      textProject.load(textPath);
+      t1 = Clock::now();
+      textMs = std::min(textMs, ms(t1-t0));
+
+      // binary view -- touch every param in place
+      ProjectBinary binary;
+      t0 = Clock::now();
+      binary.open(binaryPath);
+      checksum = 0;
+      for(int i = 0; i < binary.nodeCount(); i++)
+        {
+          const ProjectBinaryParam *p = binary.params(i);
+          for(uint32_t j = 0; j < binary.node(i).paramCount; j++) { checksum += binary.str(p[j].key).size() + binary.str(p[j].value).size(); }
+        }
+      t1 = Clock::now();
+      openMs = std::min(openMs, ms(t1-t0));
+
+      ProjectFile binaryProject;
+      t0 = Clock::now();
+      binary.toProject(binaryProject);
+      t1 = Clock::now();
+      convertMs = std::min(convertMs, ms(t1-t0));
+    }
+  out << "  load text (parse):              " << textMs << " ms\n"
+      << "  load binary (mmap + read all):  " << openMs << " ms  (" << checksum << " param bytes)\n"
+      << "  binary --> project data:        " << convertMs << " ms\n";
+
+  // round trip (text --> binary --> text)
+  ProjectFile fromText, fromBinary;
+  fromText.load(textPath);
+  fromBinary.load(binaryPath);
+  std::ostringstream textStr, binaryStr;
+  std::ifstream f(textPath);
+  std::stringstream original; original << f.rdbuf();
+  fromText.save(textStr);
+  fromBinary.save(binaryStr);
+  bool same = (textStr.str() == original.str() && binaryStr.str() == original.str());
+  out << "  round trip: " << (same ? "identical" : "MISMATCH") << "\n";
+
+  std::remove(textPath.c_str());
+  std::remove(binaryPath.c_str());
+  return (same ? 0 : 1);
+}
+
+// times a random date scrub through the ephemeris with stdio and memory-mapped file reads
+//  (cold --> first pass after switching, files opened/mapped and headers read; warm --> best of the following passes)
+int benchmarkEphemeris(int dateCount, std::ostream &out)
+{
+  typedef std::chrono::steady_clock Clock;
+  auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+  const int runs = 5;
+  if(!EphemerisFiles::supported()) { out << "memory-mapped files not supported on this platform\n"; return 1; }
+
+  // random dates over 2300 years (crosses the 600-year file boundaries -- fixed seed, same scrub every run)
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> dist(1976730.5, 1976730.5 + 2300*365.25); // (700 AD -->)
+  std::vector<double> dates(dateCount);
+  for(auto &jd : dates) { jd = dist(rng); }
+
+  Ephemeris swe;
+  long flags = (SEFLG_SWIEPH | SEFLG_SPEED);
+  ObjMask objects = ObjMask().set(); // (numbered asteroid files only cover 1500-2100)
+  objects.reset(OBJ_QUAOAR); objects.reset(OBJ_LILITH); objects.reset(OBJ_FORTUNA);
+  std::vector<ObjDataArray> results[2];
+  double cold[2] = { 0.0, 0.0 };
+  double warm[2] = { 1e9, 1e9 };
+  for(int m = 0; m < 2; m++)
+    {
+      Ephemeris::setMemoryMapped(m == 1); // (resets ephemeris path -- files reopened)
+      std::vector<ObjDataArray> &data = results[m];
+      data.resize(dates.size());
+      for(int r = 0; r <= runs; r++)
+        {
+          auto t0 = Clock::now();
+          for(int i = 0; i < dateCount; i++) { swe.calcObjects(dates[i], objects, flags, data[i]); }
+          auto t1 = Clock::now();
+          if(r == 0) { cold[m] = ms(t1-t0); }
+          else       { warm[m] = std::min(warm[m], ms(t1-t0)); }
+        }
+    }
+  Ephemeris::setMemoryMapped(false);
+
+  bool same = true;
+  for(int i = 0; i < dateCount && same; i++)
+    {
+      for(int o = 0; o < OBJ_COUNT; o++)
+        {
+          if(!objects[o]) { continue; }
+          if(results[0][i].longitude[o] != results[1][i].longitude[o] || results[0][i].latitude[o] != results[1][i].latitude[o] ||
+             results[0][i].distance[o]  != results[1][i].distance[o]  || results[0][i].lonSpeed[o] != results[1][i].lonSpeed[o])
+            { same = false; break; }
+        }
+    }
+  out << "random scrub: " << dateCount << " dates x " << objects.count() << " objects, 700-3000 AD (warm --> best of " << runs << " runs)\n"
+      << "  stdio:         cold " << cold[0] << " ms | warm " << warm[0] << " ms\n"
+      << "  memory-mapped: cold " << cold[1] << " ms | warm " << warm[1] << " ms  (" << EphemerisFiles::instance().fileCount() << " files, "
+      << EphemerisFiles::instance().mappedBytes()/1024 << " KiB mapped)\n"
+      << "  positions: " << (same ? "identical" : "MISMATCH") << "\n";
+  return (same ? 0 : 1);
+}
+
+// times AspectSweep against the brute-force pair loop on random point sets (N = 25, 250, 2500), and checks the results are identical
+//  (within one set -- pairs with index1 < index2 -- and between two sets -- every pair)
+int benchmarkAspects(std::ostream &out)
+{
+  typedef std::chrono::steady_clock Clock;
+  auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+  auto sameBits = [](double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; };
+  const int runs = 5;
+
+  std::array<bool,   ASPECT_COUNT> aspVisible;
+  std::array<double, ASPECT_COUNT> aspOrbs;
+  for(auto &iter : ASPECTS) { aspVisible[iter.second.type] = true; aspOrbs[iter.second.type] = iter.second.orb; }
+
+  // (old loop -- every pair, then ASPECTS in order)
+  auto bruteForce = [&](const std::vector<AspectPoint> &points1, const std::vector<AspectPoint> &points2, bool ordered,
+                        std::vector<AspectSweep::Match> &matches)
+  {
+    matches.clear();
+    for(const auto &p1 : points1)
+      {
+        for(const auto &p2 : points2)
+          {
+            if(ordered && p1.index >= p2.index) { continue; }
+            double diff = angleDiffDegrees(p1.lon, p2.lon);
+            for(auto &iter : ASPECTS)
+              {
+                AspectType a = iter.second.type;
+                if(!aspVisible[a]) { continue; }
+                double aDiff = angleDiffDegrees(diff, iter.second.angle);
+                double orb   = std::min(aspOrbs[a], std::min(p1.orb, p2.orb));
+                if(std::abs(aDiff) <= orb)
+                  { matches.push_back(AspectSweep::Match{p1.index, p2.index, a, aDiff, 1.0 - (std::abs(aDiff) / orb)}); }
+              }
+          }
+      }
+  };
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> circle(0.0, 360.0);
+  std::uniform_real_distribution<double> orbs(1.0, 10.0);
+  auto randomPoints = [&](int n)
+  {
+    std::vector<AspectPoint> points(n);
+    for(int i = 0; i < n; i++) { points[i].index = i; points[i].lon = circle(rng); points[i].orb = orbs(rng); }
+    return points;
+  };
+
+  bool same = true;
+  out << "aspects: sweep vs brute force (best of " << runs << " runs)\n";
+  for(int n : { 25, 250, 2500 })
+    {
+      std::vector<AspectPoint> points1 = randomPoints(n);
+      std::vector<AspectPoint> points2 = randomPoints(n);
+      for(int mode = 0; mode < 2; mode++)
+        {
+          bool ordered = (mode == 0);
+          const std::vector<AspectPoint> &other = (ordered ? points1 : points2);
+          AspectSweep sweep;
+          std::vector<AspectSweep::Match> brute;
+          double tSweep = 1e9, tBrute = 1e9;
+          for(int r = 0; r < runs; r++)
+            {
+              auto t0 = Clock::now();
+              sweep.find(points1, other, aspVisible, aspOrbs, ordered);
+              auto t1 = Clock::now();
+              bruteForce(points1, other, ordered, brute);
+              auto t2 = Clock::now();
+              tSweep = std::min(tSweep, ms(t1-t0));
+              tBrute = std::min(tBrute, ms(t2-t1));
+            }
+          const std::vector<AspectSweep::Match> &found = sweep.matches();
+          bool match = (found.size() == brute.size());
+          for(int i = 0; match && i < (int)found.size(); i++)
+            {
+              match = (found[i].index1 == brute[i].index1 && found[i].index2 == brute[i].index2 && found[i].type == brute[i].type &&
+                       sameBits(found[i].orb, brute[i].orb) && sameBits(found[i].strength, brute[i].strength));
+            }
+          same &= match;
+          out << "  N = " << std::setw(4) << n << (ordered ? " (one set):  " : " (two sets): ") << "sweep " << tSweep << " ms | brute force " << tBrute
+              << " ms  (" << brute.size() << " aspects) --> " << (match ? "identical" : "MISMATCH") << "\n";
+        }
+    }
+  return (same ? 0 : 1);
+}
+
+// checks batch angle kernels (every supported ISA) and HouseSearch against the scalar helpers
+int checkKernels(int count, std::ostream &out)
+{
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> wide(-1000.0, 1000.0);
+  std::uniform_real_distribution<double> circle(0.0, 360.0);
+  auto sameBits = [](double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; };
+
+  // random values, plus edges around 0/360/720 and non-finite values
+  std::vector<double> values;
+  const double edges[] = { 0.0, -0.0, 30.0, 180.0, 330.0, 360.0, -360.0, 720.0, -720.0, 1e300, -1e300,
+                           std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::quiet_NaN() };
+  for(double e : edges)
+    {
+      values.push_back(e);
+      values.push_back(std::nextafter(e,  1e308));
+      values.push_back(std::nextafter(e, -1e308));
+    }
+  while((int)values.size() < count) { values.push_back(wide(rng)); }
+  std::vector<double> others(values.size());
+  for(auto &v : others) { v = wide(rng); }
+  std::shuffle(others.begin(), others.end(), rng);
+  int n = values.size();
+
+  // scalar reference
+  std::vector<double> refDiff(n), refDiff1(n);
+  std::vector<int>    refSign(n);
+  for(int i = 0; i < n; i++)
+    {
+      refDiff[i]  = angleDiffDegrees(values[i], others[i]);
+      refDiff1[i] = angleDiffDegrees(values[i], others[0]);
+      refSign[i]  = (int)std::floor(fmod(values[i], 360.0)/30.0); // (same as Chart::getSign)
+    }
+
+  int failures = 0;
+  AngleIsa best = getAngleIsa();
+  const char *isaNames[] = { "scalar", "sse2", "avx2" };
+  for(int isa = ANGLE_ISA_SCALAR; isa <= best; isa++)
+    {
+      setAngleIsa((AngleIsa)isa);
+      std::vector<double> diff(n), diff1(n);
+      std::vector<int>    sign(n);
+      angleDiffDegrees(values.data(), others.data(), diff.data(), n);
+      angleDiffDegrees(values.data(), others[0], diff1.data(), n);
+      getSigns(values.data(), sign.data(), n);
+      int bad = 0;
+      for(int i = 0; i < n; i++)
+        { bad += ((!sameBits(diff[i], refDiff[i]) || !sameBits(diff1[i], refDiff1[i]) || sign[i] != refSign[i]) ? 1 : 0); }
+      out << "  " << isaNames[isa] << ": " << n << " values --> " << (bad == 0 ? "bit-identical" : "MISMATCH (" + std::to_string(bad) + ")") << "\n";
+      failures += bad;
+    }
+  setAngleIsa(best);
+
+  // house search vs scan (ordered, degenerate and unordered cusps)
+  auto scan = [](const std::array<double, 12> &cusps, double longitude) -> int
+  {
+    for(int i = 1; i <= 12; i++) { if(anglesContainDegrees(cusps[i-1], cusps[i % 12], longitude)) { return i; } }
+    return -1;
+  };
+  int lookups = 0, bad = 0;
+  int cuspSets = std::max(1, count/1000);
+  for(int c = 0; c < cuspSets; c++)
+    {
+      std::array<double, 12> cusps;
+      for(auto &cusp : cusps) { cusp = circle(rng); }
+      int kind = c % 4;
+      if(kind != 3) { std::sort(cusps.begin(), cusps.end()); std::rotate(cusps.begin(), cusps.begin() + rng() % 12, cusps.end()); } // (ordered)
+      if(kind == 1) { cusps[rng() % 12] = cusps[rng() % 12]; }   // (duplicate cusp)
+      if(kind == 2) { cusps.fill(cusps[0]); }                     // (degenerate)
+      HouseSearch search;
+      search.setCusps(cusps);
+      for(int i = 0; i < 1000; i++, lookups++)
+        {
+          double lon = (i < 12 ? cusps[i] : (i < 24 ? std::nextafter(cusps[i-12], -1.0) : circle(rng)));
+          bad += (search.getHouse(lon) != scan(cusps, lon) ? 1 : 0);
+        }
+    }
+  out << "  house search: " << lookups << " lookups --> " << (bad == 0 ? "matches scan" : "MISMATCH (" + std::to_string(bad) + ")") << "\n";
+  failures += bad;
+  return (failures == 0 ? 0 : 1);
+}
+
+// checks incremental PatternFinder results against a brute-force search over random moving charts
+int checkPatterns(int trials, std::ostream &out)
+{
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  typedef std::pair<int, PatternMask> Key; // (type, objects)
+  const int N = OBJ_END;
+
+  int failures = 0, updates = 0;
+  size_t patternCount = 0;
+  for(int t = 0; t < trials; t++)
+    {
+      PatternFinder finder;
+      std::array<double, OBJ_END> lon, objOrbs;
+      std::array<bool,   ASPECT_COUNT> aspVisible;
+      std::array<double, ASPECT_COUNT> aspOrbs;
+      PatternMask active = 0;
+      // longitudes clustered near multiples of 30 degrees (many aspects/patterns)
+      auto place = [&](int o) { lon[o] = fmod(30.0*(int)(unit(rng)*12) + (unit(rng) - 0.5)*10.0 + 360.0, 360.0); };
+      auto randomize = [&]()
+      {
+        for(int o = 0; o < N; o++) { objOrbs[o] = 2.0 + unit(rng)*6.0; }
+        for(int a = 0; a < ASPECT_COUNT; a++) { aspVisible[a] = (unit(rng) > 0.1); aspOrbs[a] = 2.0 + unit(rng)*6.0; }
+        active = 0;
+        for(int o = 0; o < N; o++) { active |= (unit(rng) > 0.2 ? (PatternMask(1) << o) : 0); }
+      };
+      for(int o = 0; o < N; o++) { place(o); }
+      randomize();
+
+      for(int step = 0; step < 20; step++, updates++)
+        {
+          if(step > 0)
+            { // move a few objects (small steps and jumps), sometimes change params
+              for(int o = 0; o < N; o++)
+                {
+                  double r = unit(rng);
+                  if(r < 0.15)      { lon[o] = fmod(lon[o] + (unit(rng) - 0.5)*2.0 + 360.0, 360.0); }
+                  else if(r < 0.20) { place(o); }
+                }
+              if(unit(rng) < 0.1) { randomize(); }
+              else if(unit(rng) < 0.2) { active ^= (PatternMask(1) << (rng() % N)); }
+            }
+          finder.update(lon.data(), active, objOrbs.data(), aspVisible, aspOrbs);
+
+          // brute force (same aspect test as Chart::calcAspects -- node axis excluded)
+          std::array<std::array<std::array<bool, OBJ_END>, OBJ_END>, ASPECT_COUNT> edges;
+          for(int a = 0; a < ASPECT_COUNT; a++)
+            for(int i = 0; i < N; i++)
+              for(int j = 0; j < N; j++)
+                {
+                  bool e = (i != j && (active & (PatternMask(1) << i)) && (active & (PatternMask(1) << j)) && aspVisible[a] &&
+                            !((i == OBJ_NORTHNODE && j == OBJ_SOUTHNODE) || (i == OBJ_SOUTHNODE && j == OBJ_NORTHNODE)));
+                  double diff = angleDiffDegrees(lon[i], lon[j]);
+                  edges[a][i][j] = (e && std::abs(angleDiffDegrees(diff, getAspectInfo((AspectType)a)->angle)) <=
+                                    std::min(aspOrbs[a], std::min(objOrbs[i], objOrbs[j])));
+                }
+          auto is = [&edges](int i, int j, AspectType a) { return edges[a][i][j]; };
+          auto opp = [&](int i, int j) { return is(i, j, ASPECT_OPPOSITION); };
+          auto sqr = [&](int i, int j) { return is(i, j, ASPECT_SQUARE); };
+          auto tri = [&](int i, int j) { return is(i, j, ASPECT_TRINE); };
+          auto sxt = [&](int i, int j) { return is(i, j, ASPECT_SEXTILE); };
+          auto qnx = [&](int i, int j) { return is(i, j, ASPECT_QUINCUNX); };
+          auto mask = [](std::initializer_list<int> objs) { PatternMask m = 0; for(int o : objs) { m |= (PatternMask(1) << o); } return m; };
+
+          std::vector<Key> expected;
+          std::vector<std::array<int, 3>> trines;
+          for(int a = 0; a < N; a++)
+            for(int b = a+1; b < N; b++)
+              {
+                for(int c = 0; c < N; c++)
+                  {
+                    if(opp(a, b) && sqr(a, c) && sqr(b, c)) { expected.push_back(Key(PATTERN_TSQUARE, mask({a, b, c}))); }
+                    if(sxt(a, b) && qnx(a, c) && qnx(b, c)) { expected.push_back(Key(PATTERN_YOD,     mask({a, b, c}))); }
+                    if(c > b && tri(a, b) && tri(a, c) && tri(b, c))
+                      {
+                        trines.push_back({a, b, c});
+                        expected.push_back(Key(PATTERN_GRAND_TRINE, mask({a, b, c})));
+                      }
+                  }
+              }
+          for(int a = 0; a < N; a++)
+            for(int b = 0; b < N; b++)
+              for(int c = 0; c < N; c++)
+                for(int d = 0; d < N; d++)
+                  {
+                    if(!opp(a, c) && !opp(a, d) && !sqr(a, b)) { continue; } // (every 4-object pattern has one of these)
+                    if(b > a && d > b && c > a && sqr(a, b) && sqr(b, c) && sqr(c, d) && sqr(d, a))
+                      {
+                        expected.push_back(Key(PATTERN_GRAND_SQUARE, mask({a, b, c, d})));
+                        if(opp(a, c) && opp(b, d)) { expected.push_back(Key(PATTERN_GRAND_CROSS, mask({a, b, c, d}))); }
+                      }
+                    if(d > a && opp(a, d) && sxt(a, b) && tri(b, d) && sxt(b, c) && sxt(c, d) && tri(a, c))
+                      { expected.push_back(Key(PATTERN_CRADLE, mask({a, b, c, d}))); }
+                    if(b > a && c > a && d > a && opp(a, c) && opp(b, d) && sxt(a, b) && sxt(c, d) && tri(b, c) && tri(a, d))
+                      {
+                        expected.push_back(Key(PATTERN_MYSTIC_RECTANGLE, mask({a, b, c, d})));
+                        for(int e = 0; e < N; e++)
+                          {
+                            if(sxt(b, e) && sxt(c, e) && tri(a, e) && tri(d, e)) { expected.push_back(Key(PATTERN_ENVELOPE, mask({a, b, c, d, e}))); }
+                            if(sxt(a, e) && sxt(d, e) && tri(b, e) && tri(c, e)) { expected.push_back(Key(PATTERN_ENVELOPE, mask({a, b, c, d, e}))); }
+                          }
+                      }
+                  }
+          for(int t1 = 0; t1 < (int)trines.size(); t1++)
+            {
+              const auto &g = trines[t1];
+              for(int i = 0; i < 3; i++)
+                for(int d = 0; d < N; d++)
+                  {
+                    if(opp(g[i], d) && sxt(g[(i+1)%3], d) && sxt(g[(i+2)%3], d))
+                      { expected.push_back(Key(PATTERN_KITE, mask({g[0], g[1], g[2], d}))); }
+                  }
+              for(int t2 = t1+1; t2 < (int)trines.size(); t2++)
+                {
+                  const auto &h = trines[t2];
+                  bool linked = true;
+                  for(int i = 0; i < 3; i++)
+                    {
+                      int n1 = 0, n2 = 0;
+                      for(int j = 0; j < 3; j++) { n1 += (sxt(g[i], h[j]) ? 1 : 0); n2 += (sxt(h[i], g[j]) ? 1 : 0); if(g[i] == h[j]) { linked = false; } }
+                      linked &= (n1 == 2 && n2 == 2);
+                    }
+                  if(linked) { expected.push_back(Key(PATTERN_GRAND_SEXTILE, mask({g[0], g[1], g[2], h[0], h[1], h[2]}))); }
+                }
+            }
+
+          std::vector<Key> found;
+          for(const auto &p : finder.patterns()) { found.push_back(Key(p.type, p.mask)); }
+          std::sort(expected.begin(), expected.end());
+          std::sort(found.begin(), found.end());
+          patternCount += found.size();
+          if(found != expected)
+            {
+              if(failures == 0)
+                { out << "  MISMATCH (trial " << t << ", step " << step << ") --> found " << found.size() << ", expected " << expected.size() << "\n"; }
+              failures++;
+            }
+        }
+    }
+  out << "  patterns: " << updates << " incremental updates (" << patternCount << " patterns) --> "
+      << (failures == 0 ? "matches brute force" : "MISMATCH (" + std::to_string(failures) + " updates)") << "\n";
+  return (failures == 0 ? 0 : 1);
+}
+
+void printUsage(const char *name)
+{
+  std::cerr << "usage: " << name << " [--csv] [-o OUTPUT] PROJECT\n"
+            << "       " << name << " --convert OUTPUT PROJECT\n"
+            << "       " << name << " --bench-load NODES\n"
+            << "       " << name << " --bench-ephem DATES\n"
+            << "       " << name << " --bench-aspects\n"
+            << "       " << name << " --check-kernels VALUES\n"
+            << "       " << name << " --check-patterns CHARTS\n"
+            << "  evaluates the calculation nodes of PROJECT (.ags or " PROJECT_BINARY_EXT ") and writes every chart's data (JSON by default)\n"
+            << "    --csv             write CSV (one row per chart object/house cusp)\n"
+            << "    -o OUTPUT         write to file OUTPUT instead of stdout\n"
+            << "    --convert OUTPUT  convert PROJECT to text/binary (format from OUTPUT extension -- .ags/" PROJECT_BINARY_EXT ")\n"
+            << "    --mmap            read ephemeris files through memory mappings\n"
+            << "    --bench-load N    time loading a synthetic N-node project in each format\n"
+            << "    --bench-ephem N   time a random N-date ephemeris scrub with stdio and memory-mapped files\n"
+            << "    --bench-aspects   time aspect search (sorted sweep vs every pair) on 25/250/2500 random points\n"
+            << "    --check-kernels N check batch angle kernels (each ISA) and house search against scalar code on N values\n"
+            << "    --check-patterns N check incremental aspect pattern search against brute force on N random moving charts\n"
+            << "    --version         print version\n"
+            << "  (run from the astrolograph directory -- ephemeris/tzdata paths are relative)\n";
+}
+
+int main(int argc, char **argv)
+{
+  std::string projectPath = "";
+  std::string outPath     = "";
+  std::string convertPath = "";
+  int         benchNodes  = 0;
+  int         benchDates  = 0;
+  int         checkValues = 0;
+  int         checkCharts = 0;
+  bool        benchAspects = false;
+  bool        mmap        = false;
+  bool        csv         = false;
+  for(int i = 1; i < argc; i++)
+    {
+      std::string arg = argv[i];
+      if(arg == "--csv")                     { csv = true; }
+      else if(arg == "--json")               { csv = false; }
+      else if(arg == "-o" && i+1 < argc)     { outPath = argv[++i]; }
+      else if(arg == "--convert" && i+1 < argc)    { convertPath = argv[++i]; }
+      else if(arg == "--mmap")               { mmap = true; }
+      else if(arg == "--bench-load" && i+1 < argc)  { benchNodes = std::max(1, std::atoi(argv[++i])); }
+      else if(arg == "--bench-ephem" && i+1 < argc) { benchDates = std::max(1, std::atoi(argv[++i])); }
+      else if(arg == "--bench-aspects")           { benchAspects = true; }
+      else if(arg == "--check-kernels" && i+1 < argc)  { checkValues = std::max(1, std::atoi(argv[++i])); }
+      else if(arg == "--check-patterns" && i+1 < argc) { checkCharts = std::max(1, std::atoi(argv[++i])); }
+      else if(arg == "-h" || arg == "--help") { printUsage(argv[0]); return 0; }
+      else if(arg == "--version")
+        { std::cout << "Astrolograph Headless (v" << ASTROLOGRAPH_VERSION_MAJOR << "." << ASTROLOGRAPH_VERSION_MINOR << ")\n"; return 0; }
+      else if(projectPath.empty() && arg[0] != '-') { projectPath = arg; }
+      else { printUsage(argv[0]); return 1; }
+    }
+  if(benchNodes > 0)       { return benchmarkLoad(benchNodes, std::cout); }
+  if(benchDates > 0)       { return benchmarkEphemeris(benchDates, std::cout); }
+  if(benchAspects)         { return benchmarkAspects(std::cout); }
+  if(checkValues > 0)      { return checkKernels(checkValues, std::cout); }
+  if(checkCharts > 0)      { return checkPatterns(checkCharts, std::cout); }
+  if(projectPath.empty()) { printUsage(argv[0]); return 1; }
+  if(!convertPath.empty())
+    {
+      ProjectFile project;
+      if(!project.load(projectPath)) { std::cerr << "ERROR: Could not load project '" << projectPath << "'\n"; return 1; }
+      if(!project.save(convertPath)) { std::cerr << "ERROR: Could not save project '" << convertPath << "'\n"; return 1; }
+      return 0;
+    }
+
+  // output goes to stdout (or file) -- library messages redirected to stderr
+  std::ostream out(std::cout.rdbuf());
+  std::streambuf *coutBuf = std::cout.rdbuf(std::cerr.rdbuf());
+  std::ofstream outFile;
+  if(!outPath.empty())
+    {
+      outFile.open(outPath, std::ios::out);
+      if(!outFile) { std::cerr << "ERROR: Could not open output file '" << outPath << "'\n"; std::cout.rdbuf(coutBuf); return 1; }
+      out.rdbuf(outFile.rdbuf());
+    }
+
+  int status = 0;
+  if(mmap) { Ephemeris::setMemoryMapped(true); } // (before any worker threads start)
+  {
+    Ephemeris swe; // (initializes swe context on main thread)
+    ProjectFile project;
+    if(project.load(projectPath))
+      {
+        HeadlessGraph graph;
+        graph.load(project);
+        for(int id : graph.skipped())
+          {
+            const ProjectNode *n = project.getNode(id);
+            std::cerr << "(skipped node " << id << " -- " << (n ? n->type : "?") << ")\n";
+          }
+        graph.update();
+        if(csv) { graph.writeCsv(out); }
+        else    { graph.writeJson(out); }
+      }
+    else
+      {
+        std::cerr << "ERROR: Could not load project '" << projectPath << "'\n";
+        status = 1;
+      }
+  }
+  out.flush();
+  std::cout.rdbuf(coutBuf);
+  return status;
+}
@@ -0,0 +1,46 @@
+#ifndef ANGLE_BATCH_HPP
+#define ANGLE_BATCH_HPP
+
+#include <array>
+
+#include "astro.hpp"
+
+namespace astro
+{
+  // instruction set used by batch angle functions (best supported is chosen at runtime)
+  enum AngleIsa
+    {
+      ANGLE_ISA_SCALAR = 0,
+      ANGLE_ISA_SSE2,
+      ANGLE_ISA_AVX2,
+    };
+  AngleIsa getAngleIsa();
+  void     setAngleIsa(AngleIsa isa); // (clamped to best supported -- for testing/comparison)
+  
+  // Batch versions of the scalar angle helpers in astro.hpp, over arrays of n longitudes (degrees).
+  //  - results are bit-identical to the scalar helpers (same IEEE operations, lanes outside the fast path use the scalar helper)
+  //  - used by AspectSweep/PatternFinder candidate tests (house containment is batched by HouseSearch::getHouses instead)
+  void angleDiffDegrees(const double *angles1, const double *angles2, double *out, int n); // (unsigned difference, [0, 180])
+  void angleDiffDegrees(const double *angles, double angle, double *out, int n);
+  void getSigns(const double *longitudes, int *out, int n); // (sign index -- same as Chart::getSign)
+
+  // Finds houses by binary search over cusps sorted by longitude.
+  //  - same result as scanning houses with anglesContainDegrees (falls back to the scan if cusps aren't cyclically ordered)
+  class HouseSearch
+  {
+  private:
+    std::array<double, 12> mCusps;  // (house order)
+    std::array<double, 12> mSorted; // cusps sorted by longitude
+    std::array<int,    12> mHouses; // house number (1-12) starting at each sorted cusp
+    bool mOrdered = false;          // cusps increase around the circle (binary search valid)
+
+    int scan(double longitude) const;
+    
+  public:
+    void setCusps(const std::array<double, 12> &cusps);
+    int  getHouse(double longitude) const; // returns house number (1-12), or -1
+    void getHouses(const double *longitudes, int *out, int n) const;
+  };
+}
+
+#endif // ANGLE_BATCH_HPP
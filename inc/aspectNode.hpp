@@ -23,8 +23,12 @@ namespace astro
 
     bool mListOpen = true;
     bool mOrbsOpen = true;
+    bool mPatternsOpen = false;
     std::vector<bool> mAspVisible;
     std::vector<double> mAspOrbs;
+
+    // params of listed aspects (chart's last requested aspect set, limited to objects/aspects shown by this node)
+    ChartParams listParams(Chart *chart) const;
     
     virtual void onUpdate() override;
     virtual void onDraw() override;
@@ -33,6 +37,7 @@ namespace astro
     {
       params.emplace("listOpen", (mListOpen ? "1" : "0"));
       params.emplace("orbsOpen", (mOrbsOpen ? "1" : "0"));
+      params.emplace("patternsOpen", (mPatternsOpen ? "1" : "0"));
       std::string visStr;
       std::string orbStr;
       for(int a = 0; a < ASPECT_COUNT; a++) // start with all aspects visible
@@ -49,6 +54,7 @@ namespace astro
     {
       auto iter = params.find("listOpen"); if(iter != params.end()) { mListOpen = (iter->second != "0"); }
       iter = params.find("orbsOpen"); if(iter != params.end()) { mOrbsOpen = (iter->second != "0"); }
+      iter = params.find("patternsOpen"); if(iter != params.end()) { mPatternsOpen = (iter->second != "0"); }
       
       iter = params.find("aspVisible");
       if(iter != params.end())
@@ -81,6 +87,7 @@ namespace astro
         {
           ((AspectNode*)other)->mListOpen = mListOpen;
           ((AspectNode*)other)->mOrbsOpen = mOrbsOpen;
+          ((AspectNode*)other)->mPatternsOpen = mPatternsOpen;
           for(int a = 0; a < ASPECT_COUNT; a++) // start with all aspects visible
             {
               ((AspectNode*)other)->mAspVisible[a] = mAspVisible[a];
@@ -0,0 +1,79 @@
+#ifndef ASPECT_PATTERNS_HPP
+#define ASPECT_PATTERNS_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "astro.hpp"
+
+#define PATTERN_MAX_OBJECTS 6 // (grand sextile)
+
+namespace astro
+{
+  typedef uint32_t PatternMask; // one bit per object (ObjType)
+  static_assert(OBJ_END <= 32, "PatternMask too small for object list");
+
+  // objects forming a pattern (order depends on pattern -- see PatternFinder)
+  struct AspectPattern
+  {
+    PatternType type  = PATTERN_INVALID;
+    PatternMask mask  = 0;
+    int         count = 0;
+    std::array<ObjType, PATTERN_MAX_OBJECTS> objects;
+  };
+
+  // Finds aspect patterns (PatternType) from per-aspect adjacency masks.
+  //  - mAdjacency[aspect][obj] --> objects in that aspect with obj, so each step of a search is an and of masks
+  //    (e.g. T-square apexes of opposition a-b --> square[a] & square[b])
+  //  - positions are compared to the last update -- only edges of moved objects are retested, and patterns are
+  //    only searched again if an edge was added/removed (then only patterns touching those objects are replaced)
+  //  - pentagram needs quintiles (not an AspectType) -- never found
+  //  - north node/south node opposition is permanent -- excluded (no nodal-axis T-squares, cradles, ...)
+  //
+  // object order in patterns:
+  //  - T-square:         opposition (2), apex
+  //  - grand trine:      trine (3)
+  //  - yod:              sextile (2), apex
+  //  - grand square:     squares in cycle (4)
+  //  - grand cross:      squares in cycle (4) (also opposite across cycle)
+  //  - kite:             grand trine (3), point opposite first trine object
+  //  - grand sextile:    sextiles in cycle (6)
+  //  - envelope:         sextiles in chain (5)
+  //  - cradle:           sextiles in chain (4) (ends opposite)
+  //  - mystic rectangle: sextile (2), opposite sextile (2) -- (a,b,c,d) with a-c and b-d in opposition
+  class PatternFinder
+  {
+  private:
+    typedef std::array<PatternMask, OBJ_END> Adjacency;
+    std::array<Adjacency, ASPECT_COUNT> mAdjacency;
+    std::array<double, ASPECT_COUNT>    mAngles;
+
+    // last update
+    bool        mValid  = false;
+    PatternMask mActive = 0;
+    std::array<double, OBJ_END>       mLon;
+    std::array<double, OBJ_END>       mObjOrbs;
+    std::array<bool,   ASPECT_COUNT>  mAspVisible;
+    std::array<double, ASPECT_COUNT>  mAspOrbs;
+    std::vector<AspectPattern>        mPatterns;
+
+    void updateEdges(int obj, PatternMask &touched);
+    void findPatterns(PatternMask required);
+    void addPattern(PatternType type, PatternMask required, std::initializer_list<int> objects);
+
+  public:
+    PatternFinder();
+
+    // updates patterns for object longitudes (active --> visible/valid objects)
+    // returns true if patterns changed
+    bool update(const double *longitudes, PatternMask active, const double *objOrbs,
+                const std::array<bool, ASPECT_COUNT> &aspVisible, const std::array<double, ASPECT_COUNT> &aspOrbs);
+    const std::vector<AspectPattern>& patterns() const { return mPatterns; }
+    // objects in aspect with obj (bit per ObjType)
+    PatternMask adjacent(AspectType asp, ObjType obj) const { return mAdjacency[asp][obj]; }
+    void clear() { mValid = false; mPatterns.clear(); }
+  };
+}
+
+#endif // ASPECT_PATTERNS_HPP
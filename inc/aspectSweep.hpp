@@ -0,0 +1,64 @@
+#ifndef ASPECT_SWEEP_HPP
+#define ASPECT_SWEEP_HPP
+
+#include <array>
+#include <vector>
+
+#include "astro.hpp"
+
+// padding added to sweep windows (degrees) -- candidates are checked exactly, so only needs to cover rounding
+#define ASPECT_SWEEP_PAD 1.0e-9
+
+namespace astro
+{
+  // point in a set of aspected objects
+  struct AspectPoint
+  {
+    int    index = -1;  // caller's object index (returned in matches)
+    double lon   = 0.0; // ecliptic longitude [0, 360)
+    double orb   = 0.0; // object orb (aspect orb is min(aspect orb, object orbs))
+  };
+  
+  // Finds aspects between two sets of points without testing every pair.
+  //  - second set is sorted by longitude once (doubled past 360 so windows can wrap)
+  //  - for each aspect angle, each point in the first set only visits points within (angle +/- orb) of itself
+  //  - candidates are tested with the same formula as the brute-force loop (batched -- bit-identical), so results are identical
+  class AspectSweep
+  {
+  public:
+    struct Match
+    {
+      int        index1 = -1;
+      int        index2 = -1;
+      AspectType type   = ASPECT_INVALID;
+      double     orb      = 0.0; // angle difference from exact aspect
+      double     strength = 0.0; // 1.0 - orb/(max orb)
+    };
+    
+  private:
+    struct Entry
+    {
+      double lon;   // wrapped to [0, 360) (+360 in second half)
+      int    point; // index in second set
+    };
+    std::vector<Entry> mSorted;
+    std::vector<Match> mMatches;
+    std::vector<int>    mCandidates; // points in current window (second set index)
+    std::vector<double> mDiffs;      // (candidate longitudes --> angle differences -- see angleBatch.hpp)
+    
+    std::array<double, ASPECT_COUNT> mAngles;
+    std::array<int,    ASPECT_COUNT> mRanks; // order in ASPECTS (matches ordered like the brute-force loop)
+    
+  public:
+    AspectSweep();
+
+    // ordered --> only pairs with (index1 < index2)
+    // matches are ordered by index1, then index2, then aspect (same order as looping over pairs, then ASPECTS)
+    const std::vector<Match>& find(const std::vector<AspectPoint> &points1, const std::vector<AspectPoint> &points2,
+                                   const std::array<bool, ASPECT_COUNT> &aspVisible, const std::array<double, ASPECT_COUNT> &aspOrbs,
+                                   bool ordered);
+    const std::vector<Match>& matches() const { return mMatches; }
+  };
+}
+
+#endif // ASPECT_SWEEP_HPP
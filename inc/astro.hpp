@@ -11,6 +11,7 @@
 #include <sstream>
 #include <iomanip>
 #include <type_traits>
+#include <bitset>
 
 #include "vector.hpp"
 #include "tools.hpp"
@@ -226,6 +227,9 @@ namespace astro
   static const std::vector<std::string> ASPECT_NAMES =
     { "conjunction", "opposition", "square", "trine", "sextile", 
       "quincunx", "semisextile", "sesquiquadrate", "octile", "novile" };
+  static const std::vector<std::string> PATTERN_NAMES =
+    { "t-square", "grand trine", "yod", "grand square", "grand cross", "kite",
+      "grand sextile", "pentagram", "envelope", "cradle", "mystic rectangle" };
 
   static const std::vector<double> OBJECT_ORBS_DEFAULT =
     { 10.0, 10.0,
@@ -395,6 +399,15 @@ namespace astro
       { return "<UNKNOWN_ASPECT>"; }
   }
 
+  //// PATTERNS
+  inline std::string getPatternName(PatternType type)
+  {
+    if(type > PATTERN_INVALID && type < PATTERN_COUNT)
+      { return PATTERN_NAMES[(int)type]; }
+    else
+      { return "<UNKNOWN_PATTERN>"; }
+  }
+
   //// HOUSE SYSTEMS
   inline std::string getHouseSystemName(HouseSystem hs)
   { return HOUSE_SYSTEM_NAMES[hs]; }
@@ -436,6 +449,13 @@ namespace astro
   template<typename T>
   inline T angleDiffDegrees(T angle1, T angle2)
   { return static_cast<T>(180-std::abs(std::abs(angle2-angle1)-180)); }
+  // finds signed difference (angle1 - angle2), wrapped to [-180, 180) (degrees)
+  template<typename T>
+  inline T angleDiffSignedDegrees(T angle1, T angle2)
+  {
+    T diff = std::fmod(angle1 - angle2 + 180, static_cast<T>(360));
+    return (diff < 0 ? diff + 360 : diff) - 180;
+  }
 
   // tests if angleTest is between angle1 and angle2
   template<typename T>
@@ -490,6 +510,27 @@ namespace astro
     double distSpeed = 0.0;   // dRadius
     bool   valid     = false; // valid data
   };
+
+  // selects a subset of objects (bit index matches ObjType)
+  typedef std::bitset<OBJ_COUNT> ObjMask;
+  
+  // batched object data (structure of arrays -- indexed by ObjType)
+  struct ObjDataArray
+  {
+    std::array<double, OBJ_COUNT> longitude;
+    std::array<double, OBJ_COUNT> latitude;
+    std::array<double, OBJ_COUNT> distance;
+    std::array<double, OBJ_COUNT> lonSpeed;
+    std::array<double, OBJ_COUNT> latSpeed;
+    std::array<double, OBJ_COUNT> distSpeed;
+    ObjMask                       valid;
+    
+    ObjData get(ObjType o) const
+    {
+      if(o < OBJ_SUN || o >= OBJ_COUNT) { return ObjData{}; }
+      return ObjData{longitude[o], latitude[o], distance[o], lonSpeed[o], latSpeed[o], distSpeed[o], valid[o]};
+    }
+  };
   
 }
 
@@ -0,0 +1,86 @@
+#ifndef BACKGROUND_JOB_HPP
+#define BACKGROUND_JOB_HPP
+
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+#include "ephemeris.hpp"
+#include "snapshot.hpp"
+
+namespace astro
+{
+  // Runs a job function on a background thread, publishing each result as a snapshot.
+  //  - request() queues input for the next run -- replaces a request that hasn't started yet (latest wins)
+  //  - result() is the last complete result (readers keep drawing it while the next one is calculated)
+  //  - the thread initializes its own swe context (started on first request -- joined on destruction, after the running job)
+  //  (job function only touches the request, the result, and state owned by the job)
+  template<typename Request, typename Result>
+  class BackgroundJob
+  {
+  public:
+    typedef std::function<void(const Request &request, Result &result)> JobFunc;
+
+  private:
+    JobFunc                  mFunc;
+    std::thread              mThread;
+    std::mutex               mMutex;
+    std::condition_variable  mCv;
+    std::unique_ptr<Request> mPending;       // next request
+    bool                     mBusy = false;  // request pending or running
+    bool                     mQuit = false;
+    unsigned long            mRequested = 0; // number of requests (result version --> request number)
+    Snapshot<Result>         mResult;
+
+    void workerLoop()
+    {
+      Ephemeris swe; // (constructed on this thread -- initializes thread-local swe context)
+      std::unique_lock<std::mutex> lock(mMutex);
+      while(true)
+        {
+          mCv.wait(lock, [&]() { return (mQuit || mPending); });
+          if(mQuit) { return; }
+          std::unique_ptr<Request> request = std::move(mPending);
+          unsigned long number = mRequested;
+          lock.unlock();
+
+          mFunc(*request, mResult.back());
+          mResult.publish(number);
+
+          lock.lock();
+          mBusy = (mPending != nullptr);
+        }
+    }
+
+  public:
+    BackgroundJob(const JobFunc &func) : mFunc(func) { }
+    ~BackgroundJob()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+      }
+      mCv.notify_all();
+      if(mThread.joinable()) { mThread.join(); }
+    }
+
+    void request(const Request &request)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if(!mThread.joinable()) { mThread = std::thread(&BackgroundJob::workerLoop, this); }
+      mPending.reset(new Request(request));
+      mRequested++;
+      mBusy = true;
+      mCv.notify_one();
+    }
+    bool busy()                     { std::lock_guard<std::mutex> lock(mMutex); return mBusy; }
+    unsigned long requested()       { std::lock_guard<std::mutex> lock(mMutex); return mRequested; }
+
+    std::shared_ptr<const Result> result() const { return mResult.get(); }     // (nullptr until first job is done)
+    unsigned long resultVersion() const          { return mResult.version(); } // request number of result
+  };
+}
+
+#endif // BACKGROUND_JOB_HPP
@@ -4,8 +4,28 @@
 #include "astro.hpp"
 #include "vector.hpp"
 #include "ephemeris.hpp"
+#include "ephemerisCache.hpp"
+#include "aspectSweep.hpp"
+#include "aspectPatterns.hpp"
+#include "angleBatch.hpp"
+#include "objectRegistry.hpp"
 
 #include <vector>
+#include <atomic>
+
+// number of consecutive small date steps before object positions are interpolated (see EphemerisCache)
+#define CHART_SWEEP_UPDATES 8
+
+// chart update stages (dirty bits -- only invalidated stages are recalculated in Chart::update)
+#define CHART_STAGE_OBJECTS 0x01 // date (+ location if topocentric)  --> object positions
+#define CHART_STAGE_HOUSES  0x02 // date + location + house system     --> house cusps/angles
+#define CHART_STAGE_ZODIAC  0x04 // zodiac transform (draconic)        --> oriented positions/cusps
+#define CHART_STAGE_ASPECTS 0x08 // aspect params (nothing recalculated -- aspects found on demand by calcAspects)
+#define CHART_STAGE_EXTRAS  0x10 // objects stage or registry change   --> registry object positions (see ObjectRegistry)
+#define CHART_STAGE_ALL     (CHART_STAGE_OBJECTS | CHART_STAGE_HOUSES | CHART_STAGE_ZODIAC | CHART_STAGE_ASPECTS | CHART_STAGE_EXTRAS)
+
+// number of aspect sets kept per chart (one per distinct ChartParams in use -- least recently used replaced)
+#define ASPECT_CACHE_SIZE 8
 
 namespace astro
 {
@@ -34,23 +54,100 @@ namespace astro
     }
   };
   
-  // represents the position of an object in the chart
+  // represents the position of an object in the chart (fields refer to ChartObjects arrays)
   struct ChartObject
   {
-    ObjType type = OBJ_INVALID;
-    double angle = 0.0;
-    bool visible = true;
-    bool focused = false;
+    ObjType type;
+    double &angle;
+    bool   &visible;
+    bool   &focused;
+
+    bool   &valid;      // valid data
+    bool   &retrograde; // object is in retrograde motion
+  };
+
+  // per-object chart data (one contiguous array per field -- indexed by ObjType)
+  struct ChartObjectArrays
+  {
+    // ephemeris data (angles from calculated houses)
+    std::array<double, OBJ_END> longitude;
+    std::array<double, OBJ_END> latitude;
+    std::array<double, OBJ_END> distance;
+    std::array<double, OBJ_END> lonSpeed;
+    std::array<double, OBJ_END> latSpeed;
+    std::array<double, OBJ_END> distSpeed;
+    // chart state
+    std::array<double, OBJ_END> angle;      // chart position (longitude with zodiac transform)
+    std::array<bool,   OBJ_END> valid;
+    std::array<bool,   OBJ_END> retrograde;
+    std::array<bool,   OBJ_END> visible;
+    std::array<bool,   OBJ_END> focused;
+
+    ChartObjectArrays()
+    {
+      longitude.fill(0.0); latitude.fill(0.0); distance.fill(0.0); lonSpeed.fill(0.0); latSpeed.fill(0.0); distSpeed.fill(0.0);
+      angle.fill(0.0); valid.fill(false); retrograde.fill(false); visible.fill(true); focused.fill(false);
+    }
+  };
+  
+  // Chart object storage -- ChartObject views are bound to this instance's arrays (rebound on copy)
+  class ChartObjects
+  {
+  private:
+    ChartObjectArrays         mArrays;
+    std::vector<ChartObject>  mViews;
+    std::vector<ChartObject*> mPointers;
+    void bind();
+    
+  public:
+    ChartObjects()                          { bind(); }
+    ChartObjects(const ChartObjects &other) : mArrays(other.mArrays) { bind(); }
+    ChartObjects& operator=(const ChartObjects &other) { mArrays = other.mArrays; return *this; }
 
-    bool valid      = false; // valid data
-    bool retrograde = false; // object is in retrograde motion
+    ChartObjectArrays& arrays()             { return mArrays; }
+    const ChartObjectArrays& arrays() const { return mArrays; }
+    ChartObject* get(ObjType o)             { return mPointers[o]; }
+    const std::vector<ChartObject*>& list() const { return mPointers; }
+    ObjData getData(ObjType o) const
+    {
+      return ObjData{mArrays.longitude[o], mArrays.latitude[o], mArrays.distance[o],
+                     mArrays.lonSpeed[o],  mArrays.latSpeed[o], mArrays.distSpeed[o], mArrays.valid[o]};
+    }
+    void setData(ObjType o, const ObjData &data)
+    {
+      mArrays.longitude[o] = data.longitude; mArrays.latitude[o] = data.latitude; mArrays.distance[o]  = data.distance;
+      mArrays.lonSpeed[o]  = data.lonSpeed;  mArrays.latSpeed[o] = data.latSpeed; mArrays.distSpeed[o] = data.distSpeed;
+      mArrays.valid[o]     = data.valid;
+    }
+  };
+  
+  // immutable copy of a chart's inputs, settings and object positions (see Snapshot)
+  //  - published by chart connectors after each change -- safe to read on any thread
+  //  - a private Chart can be rebuilt from it on another thread (Chart::setSnapshot)
+  //  (registry object positions/visibility not included -- rebuilt charts calculate them from registry)
+  struct ChartSnapshot
+  {
+    unsigned long version         = 0; // (Chart::version/settingsVersion when taken)
+    unsigned long settingsVersion = 0;
+    DateTime    date;
+    Location    location;
+    HouseSystem houseSystem = HOUSE_PLACIDUS;
+    ZodiacType  zodiac      = ZODIAC_TROPICAL;
+    bool        truePos     = false;
+    ChartObjectArrays                objects;
+    std::array<double, 12>           houseCusps;
+    std::array<double, ASPECT_COUNT> aspectOrbs;
+    std::array<bool,   ASPECT_COUNT> aspectFocus;
+    std::array<bool,   ASPECT_COUNT> aspectVisible;
+    std::shared_ptr<const ObjectList> registry; // (registry objects as of snapshot)
   };
+  
   // represents an aspect between chart objects
   struct ChartAspect
   {
-    AspectType   type = ASPECT_INVALID;
-    ChartObject *obj1 = nullptr;
-    ChartObject *obj2 = nullptr;
+    AspectType type = ASPECT_INVALID;
+    ObjType    obj1 = OBJ_INVALID; // (object in first chart)
+    ObjType    obj2 = OBJ_INVALID; // (object in second chart -- same chart unless compared)
     
     double orb      = 0.0; // angle difference from perfectly aligned aspect (orb)
     double strength = 0.0; // aspect strength ([0.0, 1.0] -- currently squared)
@@ -60,9 +157,40 @@ namespace astro
     bool   focused = false;
 
     ChartAspect() { }
-    ChartAspect(ChartObject *o1, ChartObject *o2, AspectType type_, double orb_, double strength_)
+    ChartAspect(ObjType o1, ObjType o2, AspectType type_, double orb_, double strength_)
       : obj1(o1), obj2(o2), type(type_), orb(orb_), strength(strength_), valid(true) { }
   };
+
+  // Keeps recently calculated aspect sets, keyed by (source chart versions, ChartParams).
+  //  - object/aspect focus is not part of the key (doesn't change which aspects are found)
+  class AspectCache
+  {
+  private:
+    struct Entry
+    {
+      bool          valid    = false;
+      unsigned long version1 = 0;
+      unsigned long version2 = 0;
+      size_t        hash     = 0;
+      unsigned long lastUse  = 0;
+      ChartParams   params;
+      std::vector<ChartAspect> aspects;
+    };
+    std::array<Entry, ASPECT_CACHE_SIZE> mEntries;
+    unsigned long mUseCount = 0;
+    int           mLast     = -1; // most recently used entry
+    
+    static size_t hashParams(const ChartParams &params);
+    
+  public:
+    // true if params give the same aspects (object/aspect visibility and orbs)
+    static bool sameParams(const ChartParams &p1, const ChartParams &p2);
+    // returns the cached set for key (hit --> true), or an emptied entry to fill (hit --> false)
+    std::vector<ChartAspect>& get(unsigned long version1, unsigned long version2, const ChartParams &params, bool &hit);
+    const std::vector<ChartAspect>& last() const; // most recently requested set
+    const ChartParams* lastParams() const;        // params of most recently requested set (nullptr if none)
+    void clear();
+  };
   
   class Chart
   {
@@ -80,11 +208,17 @@ namespace astro
     ZodiacType  mZodiac      = ZODIAC_TROPICAL;
     bool        mTruePos     = false;
     
-    std::vector<ChartObject*> mObjects;
-    std::vector<ObjData>      mObjectData;
-    std::vector<ChartAspect>  mAspects;
+    ChartObjects              mObjects;
+    ExtraObjectArrays         mExtras;          // registry objects (asteroids/fixed stars)
+    std::shared_ptr<const ObjectList> mRegistry; // registry snapshot from setSnapshot (otherwise ObjectRegistry::snapshot())
+    int                       mExtrasChunk = 0; // next chunk refreshed while interpolating
+    std::vector<AspectPoint>  mAspectPoints;
+    AspectSweep               mAspectSweep;
+    AspectCache               mAspectCache;
+    PatternFinder             mPatternFinder;
 
     std::array<double, 12>    mHouseCusps;
+    HouseSearch               mHouseSearch;
     
     // global per-aspect params
     std::array<double, ASPECT_COUNT> mAspectOrbs;
@@ -92,12 +226,32 @@ namespace astro
     std::array<bool,   ASPECT_COUNT> mAspectVisible;
     
     Ephemeris mSwe;
-    bool mNeedUpdate = true;
+    int mDirty = CHART_STAGE_ALL; // stages needing update (CHART_STAGE_*)
+    // change versions (monotonic and unique across charts/compares -- see nextVersion)
+    unsigned long mVersion          = 0; // positions or houses changed
+    unsigned long mPositionsVersion = 0; // object positions changed (objects/zodiac/registry object stages)
+    unsigned long mHousesVersion    = 0; // house cusps/angles changed
+    unsigned long mSettingsVersion  = 0; // house system/zodiac/true pos/interpolation/aspect/visibility settings changed
+    static std::atomic<unsigned long> mNextVersion;
+    void settingsChanged() { mSettingsVersion = nextVersion(); }
+
+    void calcAspects(const ChartParams &params, std::vector<ChartAspect> &out);
+    void calcExtras();
+    std::shared_ptr<const ObjectList> registry() const;
+    unsigned long registryVersion() const;
+
+    // interpolated positions while date is being swept (scrubbing/playback)
+    EphemerisCache mCache;
+    bool   mInterpolate   = true;  // allow interpolation
+    bool   mInterpolated  = false; // current positions are interpolated
+    bool   mDateChanged   = false; // date changed since last update
+    bool   mLocChanged    = false; // location changed since last update
+    int    mSweepUpdates  = 0;     // number of consecutive small date steps
+    double mLastJulDay    = 0.0;   // julian day (ET) of last update
     
   public:
     Chart();
     Chart(const DateTime &dt, const Location &loc);
-    ~Chart();
 
     static std::string getInsideDegreeTextShort(int sign, int degree);
     static std::string getInsideDegreeTextLong(int sign, int degree);
@@ -105,10 +259,11 @@ namespace astro
     void setDate(const DateTime &dt);
     void setLocation(const Location &loc);
     
-    void setHouseSystem(HouseSystem hs) { mNeedUpdate |= (mHouseSystem != hs); mHouseSystem = hs; }
+    void setHouseSystem(HouseSystem hs)
+    { if(hs != mHouseSystem) { mDirty |= CHART_STAGE_HOUSES; mHouseSystem = hs; settingsChanged(); } }
     HouseSystem getHouseSystem() const  { return mHouseSystem; }
     // position calculation
-    void setZodiac(ZodiacType zodiac)   { mNeedUpdate |= (zodiac != mZodiac); mZodiac = zodiac; }
+    void setZodiac(ZodiacType zodiac);
     void setZodiac(const std::string &zodiacStr)
     { // (string should be a number -- value of zodiac type enum)
       int zodiac;
@@ -116,20 +271,39 @@ namespace astro
       setZodiac((ZodiacType)zodiac);
     }
     ZodiacType getZodiac() const   { return mZodiac; }
-    void setTruePos(bool state)    { mNeedUpdate |= (state != mTruePos);  mTruePos = state; }
+    void setTruePos(bool state)    { if(state != mTruePos) { mDirty |= CHART_STAGE_OBJECTS; mTruePos = state; settingsChanged(); } }
     bool getTruePos() const        { return mTruePos; }
+    // interpolate object positions while sweeping (within EphemerisCache error bound -- exact positions restored when date stops changing)
+    void setInterpolate(bool state)
+    {
+      if(state == mInterpolate) { return; }
+      mDirty |= (mInterpolated ? CHART_STAGE_OBJECTS : 0);
+      mInterpolate = state;
+      settingsChanged();
+    }
+    bool getInterpolate() const     { return mInterpolate; }
 
-    std::vector<ChartAspect> calcAspects(const ChartParams &params);
+    // aspects between visible objects (cached -- recalculated when positions or params change)
+    const std::vector<ChartAspect>& getAspects(const ChartParams &params);
+    // aspect patterns between visible objects (updated incrementally -- only moved objects retested)
+    const std::vector<AspectPattern>& getPatterns(const ChartParams &params);
     void update();
     double getSingleAngle(ObjType obj);
     ChartAspect getAspect(ObjType obj1, ObjType obj2);
 
-    bool hasChanged() const { return mNeedUpdate; }
+    bool hasChanged() const { return (mDirty != 0 || mExtras.registryVersion != registryVersion()); }
+    // change versions -- compare with the last seen value to skip work (updated by update(), settings versions by setters)
+    static unsigned long nextVersion() { return ++mNextVersion; }
+    unsigned long version() const          { return mVersion; }
+    unsigned long positionsVersion() const { return mPositionsVersion; }
+    unsigned long housesVersion() const    { return mHousesVersion; }
+    unsigned long settingsVersion() const  { return mSettingsVersion; }
 
     double getHouseCusp(int house) const;
     double getSignCusp(int sign) const;
     double getSignCusp(const std::string &name) const;    
     int getHouse(double longitude) const; // returns house number (1-12)
+    void getHouses(const double *longitudes, int *out, int n) const { mHouseSearch.getHouses(longitudes, out, n); }
     int getSign(double longitude) const;  // returns sign index   (0-11)
 
     int aspectCount(AspectType a);
@@ -142,16 +316,27 @@ namespace astro
     bool getAspectVisible(AspectType asp);
 
     Ephemeris& swe() { return mSwe; }
-    const std::vector<ChartAspect>&  aspects() const { return mAspects; }
-    const std::vector<ChartObject*>& objects() const { return mObjects; }
+    const std::vector<ChartAspect>&  aspects() const { return mAspectCache.last(); } // (last requested set)
+    const ChartParams* aspectParams() const { return mAspectCache.lastParams(); }   // (params of last requested set)
+    const std::vector<ChartObject*>& objects() const { return mObjects.list(); }
+    const ChartObjectArrays& objectArrays() const    { return mObjects.arrays(); }
+    const ExtraObjectArrays& extraObjects() const    { return mExtras; } // (indexed like ObjectRegistry)
 
-    ChartObject* getObject(ObjType o)         { return mObjects[o]; }    //(o<OBJ_COUNT ? o-OBJ_SUN : OBJ_COUNT+o-ANGLE_OFFSET)]; }
-    ObjData getObjectData(ObjType o)          { return mObjectData[o]; } //(o<OBJ_COUNT ? o-OBJ_SUN : OBJ_COUNT+o-ANGLE_OFFSET)]; }
-    void showObject(ObjType o, bool visible)  { getObject(o)->visible = visible; }
-    void setObjFocus(ObjType o, bool focused) { getObject(o)->focused = focused; }
+    ChartObject* getObject(ObjType o)         { return mObjects.get(o); }
+    ObjData getObjectData(ObjType o) const    { return mObjects.getData(o); }
+    void showObject(ObjType o, bool visible)
+    { if(visible != mObjects.arrays().visible[o]) { mObjects.arrays().visible[o] = visible; settingsChanged(); } }
+    void setObjFocus(ObjType o, bool focused) { mObjects.arrays().focused[o] = focused; }
+    void showExtraObject(int i, bool visible)
+    { if(visible != mExtras.visible[i]) { mExtras.visible.set(i, visible); settingsChanged(); } }
 
     const DateTime& date() const     { return mDate; }
     const Location& location() const { return mLocation; }
+
+    // copies chart state into snapshot (call after update)
+    void getSnapshot(ChartSnapshot &out) const;
+    // sets chart inputs and settings from snapshot (positions recalculated by next update)
+    void setSnapshot(const ChartSnapshot &snapshot);
   };
   
 }
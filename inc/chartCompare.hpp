@@ -21,45 +21,80 @@ namespace astro
     std::array<bool,   astro::ASPECT_COUNT> mAspectVisible;
     
     // Ephemeris swe;
-    std::vector<ChartAspect> mAspects; // obj1 --> outer chart, obj2 --> inner chart
-    bool mNeedUpdate = true;
+    std::vector<AspectPoint> mPointsOuter;
+    std::vector<AspectPoint> mPointsInner;
+    AspectSweep              mAspectSweep;
+    AspectCache              mAspectCache; // (keyed by outer/inner chart versions)
+
+    // change versions (from Chart::nextVersion -- unique across charts/compares)
+    unsigned long mVersion         = 0;     // either chart changed (positions/houses) or was replaced
+    unsigned long mSettingsVersion = 0;     // compare aspect settings changed
+    unsigned long mOuterVersion    = 0;     // (last seen chart versions)
+    unsigned long mInnerVersion    = 0;
+    bool          mChartsChanged   = true;  // chart pointer changed since last update
+
+    void calcAspects(const ChartParams &params, std::vector<ChartAspect> &out);
     
   public:
     ChartCompare();
     ~ChartCompare();
 
     void setAspectOrb(astro::AspectType asp, double orb)
-    { if(asp > ASPECT_INVALID && asp < ASPECT_COUNT) { mAspectOrbs[(int)asp] = orb; } }
+    {
+      if(asp > ASPECT_INVALID && asp < ASPECT_COUNT && mAspectOrbs[(int)asp] != orb)
+        { mAspectOrbs[(int)asp] = orb; mSettingsVersion = Chart::nextVersion(); }
+    }
     double getAspectOrb(astro::AspectType asp)
     { if(asp > ASPECT_INVALID && asp < ASPECT_COUNT) { return mAspectOrbs[(int)asp]; } }
     void setAspectFocus(astro::AspectType asp, bool focus)
-    { if(asp > ASPECT_INVALID && asp < ASPECT_COUNT) { mAspectFocus[(int)asp] = focus; } }
+    {
+      if(asp > ASPECT_INVALID && asp < ASPECT_COUNT && mAspectFocus[(int)asp] != focus)
+        { mAspectFocus[(int)asp] = focus; mSettingsVersion = Chart::nextVersion(); }
+    }
     void setAspectVisible(astro::AspectType asp, bool visible)
-    { if(asp > ASPECT_INVALID && asp < ASPECT_COUNT) { mAspectVisible[(int)asp] = visible; } }
+    {
+      if(asp > ASPECT_INVALID && asp < ASPECT_COUNT && mAspectVisible[(int)asp] != visible)
+        { mAspectVisible[(int)asp] = visible; mSettingsVersion = Chart::nextVersion(); }
+    }
     bool getAspectFocus(astro::AspectType asp)   { return (asp > ASPECT_INVALID && asp < ASPECT_COUNT) ? mAspectFocus[(int)asp]   : false; }
     bool getAspectVisible(astro::AspectType asp) { return (asp > ASPECT_INVALID && asp < ASPECT_COUNT) ? mAspectVisible[(int)asp] : false; }
 
-    std::vector<ChartAspect>& getAspects()             { return mAspects; }
-    const std::vector<ChartAspect>& getAspects() const { return mAspects; }
+    const std::vector<ChartAspect>& getAspects() const { return mAspectCache.last(); } // (last requested set)
 
     int aspectCount(AspectType a)
     {
       int count = 0;
-      for(auto asp : mAspects)
+      for(const auto &asp : getAspects())
         { count += (asp.type == a ? 1 : 0); }
       return count;
     }
     
+    // updates version from chart versions (cheap -- call every frame)
     void update();
-    std::vector<ChartAspect> calcAspects(const ChartParams &params);
+    unsigned long version() const         { return mVersion; }
+    unsigned long settingsVersion() const { return mSettingsVersion; }
+    // aspects between every outer x inner object pair (obj1 --> outer chart, obj2 --> inner chart)
+    //  - cached -- recalculated when either chart's positions or params change
+    const std::vector<ChartAspect>& getAspects(const ChartParams &params);
+    // sets cached aspects for current charts/params (e.g. from a SynastryMatrix cell) -- skips recalculation
+    void setAspects(const ChartParams &params, const std::vector<ChartAspect> &aspects);
+
+    // aspects between every outer x inner pair of chart points, including same-object contacts (Sun-Sun, ...)
+    //  (sorted like getAspects -- same semantics for getAspects and SynastryMatrix cells)
+    static void findAspects(const std::vector<AspectPoint> &outer, const std::vector<AspectPoint> &inner,
+                            const ChartParams &params, AspectSweep &sweep, std::vector<ChartAspect> &out);
+    // same aspects seen from the other chart (obj1/obj2 swapped, sorted like findAspects)
+    static void mirrorAspects(const std::vector<ChartAspect> &aspects, std::vector<ChartAspect> &out);
+    // visible objects of chart as aspect points
+    static void getPoints(const Chart *chart, const ChartParams &params, std::vector<AspectPoint> &out);
 
     Chart* getOuterChart() { return mChartOuter; }
     Chart* getInnerChart() { return mChartInner; }
 
-    void setOuterChart(Chart *chart) { mChartOuter = chart; }
-    void setInnerChart(Chart *chart) { mChartInner = chart; }
+    void setOuterChart(Chart *chart) { if(chart != mChartOuter) { mAspectCache.clear(); mChartsChanged = true; } mChartOuter = chart; }
+    void setInnerChart(Chart *chart) { if(chart != mChartInner) { mAspectCache.clear(); mChartsChanged = true; } mChartInner = chart; }
     
-    std::vector<ChartAspect>& aspects() { return mAspects; }
+    const std::vector<ChartAspect>& aspects() const { return getAspects(); }
   };
   
 }
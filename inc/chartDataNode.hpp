@@ -52,7 +52,7 @@ namespace astro
               if(iter->second.size() < o) { break; }
               else
                 {
-                  mShowObjects[o] = (iter->second[o] == '0');
+                  mShowObjects[o] = (iter->second[o] != '0');
                   if(chart) { chart->getObject((ObjType)o)->visible = mShowObjects[o]; }
                 }
             }
@@ -61,7 +61,7 @@ namespace astro
               if(iter->second.size() < a) { break; }
               else
                 {
-                  mShowObjects[a] = (iter->second[a] == '0');
+                  mShowObjects[a] = (iter->second[a] != '0');
                   if(chart) { chart->getObject((ObjType)a)->visible = mShowObjects[a]; }
                 }
             }
@@ -45,6 +45,8 @@ namespace astro
   
 #define OUTLINE_W                 3.0f    // zodiac chart line width
 #define OBJRING_OUTLINE_W         1.0f    // object ring line width
+#define EXTRA_OBJ_SIZE            2.0f    // size of registry object markers (asteroids/fixed stars)
+#define EXTRA_OBJ_HOVER_DIST      6.0f    // max distance from mouse to registry object marker for tooltip
 
   struct ViewParams
   {
@@ -115,6 +117,7 @@ namespace astro
     void renderAspects(Chart *chart, const ViewParams &params, ImDrawList *draw_list, const ChartParams &chartParams);
     void renderCompareAspects(ChartCompare *compare, const ViewParams &params, ImDrawList *draw_list, const ChartParams &chartParams);
     void renderObjects(Chart *chart, int level, const ViewParams &params, ImDrawList *draw_list, const ChartParams &chartParams);
+    void renderExtraObjects(Chart *chart, int level, const ViewParams &params, ImDrawList *draw_list);
     void renderChart(Chart *chart, const Vec2f &chartSize, bool blocked, const ChartParams &chartParams);
     void renderChartCompare(ChartCompare *compare, const Vec2f &chartSize, bool blocked, const ChartParams &chartParams);
     
@@ -5,6 +5,7 @@
 #include "chartView.hpp"
 #include "node.hpp"
 #include "chartCompare.hpp"
+#include "synastryMatrix.hpp"
 
 namespace astro
 {
@@ -14,6 +15,8 @@ namespace astro
 #define COMPARENODE_INPUT_CHART_OUTER 1
   // outputs
   ////////////////////////////////
+
+#define COMPARENODE_SCORE_COLUMNS 16 // inner charts per page of score matrix (ImGui tables allow at most 64 columns)
   
   class CompareNode : public Node
   {
@@ -24,14 +27,21 @@ namespace astro
     ChartView mView;
     ChartCompare *mCompare = nullptr;
 
-    DateTime mDateOuter;
-    DateTime mDateInner;
-    Location mLocOuter;
-    Location mLocInner;
-    
     ChartParams mParams;
     float mChartWidth = CHART_SIZE_DEFAULT;
 
+    // group mode -- compares every chart in the graph (any pair selected from matrix)
+    bool mGroupMode  = false;
+    int  mGroupOuter = 0;
+    int  mGroupInner = 1;
+    SynastryMatrix mMatrix;
+    std::vector<std::string> mGroupNames; // (node name per matrix chart)
+    int mScorePage = 0; // (page of inner chart columns in score matrix -- not saved)
+
+    void updateGroup();
+    void clampGroupPair(); // (keeps selected pair in range -- outer != inner)
+    void drawGroup();
+
     // date modify flags (not saved)
     bool mEditYear   = false; // toggled with 1 key
     bool mEditMonth  = false; // toggled with 2 key
@@ -52,12 +62,20 @@ namespace astro
     virtual std::map<std::string, std::string>& getSaveParams(std::map<std::string, std::string> &params) const override
     {
       params.emplace("width", std::to_string(mChartWidth));
+      params.emplace("group", std::to_string(mGroupMode));
+      params.emplace("groupOuter", std::to_string(mGroupOuter));
+      params.emplace("groupInner", std::to_string(mGroupInner));
       return params;
     };
     virtual std::map<std::string, std::string>& setSaveParams(std::map<std::string, std::string> &params) override
     {
       std::stringstream ss(params["width"]);
       ss >> mChartWidth;
+      if(params.find("group") != params.end())
+        {
+          std::stringstream ss2(params["group"] + " " + params["groupOuter"] + " " + params["groupInner"]);
+          ss2 >> mGroupMode >> mGroupOuter >> mGroupInner;
+        }
       return params;
     };
     
@@ -70,6 +88,9 @@ namespace astro
       if(Node::copyTo(other))
         {
           ((CompareNode*)other)->mChartWidth = mChartWidth;
+          ((CompareNode*)other)->mGroupMode  = mGroupMode;
+          ((CompareNode*)other)->mGroupOuter = mGroupOuter;
+          ((CompareNode*)other)->mGroupInner = mGroupInner;
           // (everything else set by connections)
           return true;
         }
@@ -0,0 +1,76 @@
+#ifndef CONNECTION_ROUTER_HPP
+#define CONNECTION_ROUTER_HPP
+
+#include "vector.hpp"
+#include "rect.hpp"
+#include "spatialIndex.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+#define ORTHO_PADDING (CONNECTOR_SIZE/2.0f + CONNECTOR_PADDING + Vec2f(10.0f, 10.0f)) // connection stub length (from connector center)
+#define ORTHO_NODE_PADDING    8.0f  // clearance kept between routed connections and node rects (less than stubs reach past node edge)
+#define ORTHO_BEND_COST       40.0f // cost of each corner (graph units of path length)
+#define ORTHO_MAX_OBSTACLES   64    // more nodes around a connection --> falls back to simple path
+
+namespace astro
+{
+  // forward declarations
+  class ConnectorBase;
+
+  // Orthogonal connection routing around node rects (obstacles read from a SpatialIndex -- e.g. NodeGraph::getIndex())
+  //  - routes are cached per connection (output/input connector pair), and found again only if an endpoint moves
+  //    or an obstacle moves across a route (see obstacleMoved())
+  class ConnectionRouter
+  {
+  public:
+    typedef std::pair<const ConnectorBase*, const ConnectorBase*> Key; // (output, input)
+
+  private:
+    struct KeyHash
+    {
+      size_t operator()(const Key &k) const
+      { return std::hash<const void*>()(k.first) ^ (std::hash<const void*>()(k.second) * 31); }
+    };
+    struct Route
+    {
+      int   id;         // (id in mRouteIndex)
+      Vec2f start;      // endpoints route was found for
+      Vec2f end;
+      std::vector<Vec2f> path;
+    };
+    const SpatialIndex &mObstacles;
+    std::unordered_map<Key, Route, KeyHash> mRoutes;
+    std::unordered_map<int, Key> mRouteKeys;
+    SpatialIndex mRouteIndex;          // route bounds -- finds routes an obstacle moved across
+    int          mNextId     = 0;
+    int          mFoundCount = 0;      // number of routes found (cache misses)
+
+    void remove(const Key &key);
+    void gather(const Rect2f &area, const Vec2f &exitStart, const Vec2f &exitEnd, std::vector<Rect2f> &obstacles) const;
+    bool blocked(const std::vector<Vec2f> &path, const Vec2f &exitStart, const Vec2f &exitEnd, const std::vector<Rect2f> &obstacles) const;
+    bool searchGrid(const Vec2f &start, const Vec2f &end, const std::vector<Rect2f> &obstacles, std::vector<Vec2f> &path) const;
+
+  public:
+    ConnectionRouter(const SpatialIndex &obstacles) : mObstacles(obstacles) { }
+
+    // simple orthogonal path (ignores obstacles)
+    static std::vector<Vec2f> simplePath(const Vec2f &start, const Vec2f &end);
+    // path from output connector point to input connector point around obstacles (not cached)
+    std::vector<Vec2f> findPath(const Vec2f &start, const Vec2f &end) const;
+
+    // cached path of connection between out and in
+    const std::vector<Vec2f>& get(const ConnectorBase *out, const ConnectorBase *in, const Vec2f &start, const Vec2f &end);
+    // drops cached routes passing near either rect (obstacle moved/resized)
+    void obstacleMoved(const Rect2f &oldRect, const Rect2f &newRect);
+    // drops cached routes for which drop(out, in) returns true (e.g. removed connections)
+    void prune(const std::function<bool(const ConnectorBase *out, const ConnectorBase *in)> &drop);
+    void clear();
+
+    int size() const       { return mRoutes.size(); }
+    int foundCount() const { return mFoundCount; }
+  };
+}
+
+#endif // CONNECTION_ROUTER_HPP
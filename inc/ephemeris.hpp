@@ -3,6 +3,7 @@
 
 #include <array>
 #include <vector>
+#include <atomic>
 #include <algorithm>
 #include "swephexp.h"
 
@@ -11,17 +12,38 @@
 // path to ephemeris data
 #define EPHEM_PATH "./libs/swe/ephe"
 
+// number of memoized julian day conversions (per Ephemeris)
+#define JULDAY_MEMO_SIZE 4
+
 namespace astro
 {
+  // julian day in both time scales (from one swe_utc_to_jd call)
+  struct JulianDay
+  {
+    double ut = 0.0; // universal time (UT1)
+    double et = 0.0; // ephemeris time (TT)
+  };
+  
   class Ephemeris
   {
   private:
+    static std::atomic<bool> mMemoryMapped; // (see setMemoryMapped)
     DateTime mDateTime;
     Location mLocation;
     
     double mJulDay_ut = 2269000.0; // TODO: Proper defaults?
     double mJulDay_et = 2269000.0;
 
+    // recent date conversions (key includes utc/dst offsets)
+    struct JulianDayMemo
+    {
+      DateTime  dt;
+      JulianDay jd;
+      bool      valid = false;
+    };
+    mutable std::array<JulianDayMemo, JULDAY_MEMO_SIZE> mJulDayMemo;
+    mutable int mJulDayMemoNext = 0;
+
     // HouseSystem mHouseSystem = HOUSE_PLACIDUS;//HOUSE_WHOLESIGN;
     
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,7 +104,12 @@ namespace astro
   public:
     static const std::vector<int> SWE_IDS;
     
-    Ephemeris();
+    Ephemeris(); // (swe state is thread-local -- construct on the thread that uses it, see EphemerisPool)
+
+    // read ephemeris files through memory mappings instead of stdio (process-wide, see EphemerisFiles)
+    //  - files already open on other threads switch over when swe reopens them
+    static void setMemoryMapped(bool state);
+    static bool getMemoryMapped();
     
     static int getSweIndex(ObjType obj)
     {
@@ -111,16 +138,24 @@ namespace astro
     }
     bool getTruePos() const { return (mSweFlags & SEFLG_TRUEPOS); }
 
+    long getSweFlags() const    { return mSweFlags; }
     double getJulianDay() const { return mJulDay_ut; }
-    double getJulianDayUT(const DateTime &dt, const Location &loc);
-    double getJulianDayET(const DateTime &dt, const Location &loc);
+    double getJulianDayET() const { return mJulDay_et; }
+    JulianDay getJulianDays(const DateTime &dt) const; // converts date to UT and ET (memoized)
+    double getJulianDayUT(const DateTime &dt, const Location &loc) const { return getJulianDays(dt).ut; }
+    double getJulianDayET(const DateTime &dt, const Location &loc) const { return getJulianDays(dt).et; }
+    DateTime getDateET(double jdEt) const; // converts julian day (ET) to date (UTC)
     // treat each year as a day
-    DateTime getProgressed(const DateTime &ndt, const Location &nloc, const DateTime &tdt, const Location &tloc);
-    DateTime getUnprogressed(const DateTime &ndt, const Location &nloc, const DateTime &pdt, const Location &ploc);
+    DateTime getProgressed(const DateTime &ndt, const Location &nloc, const DateTime &tdt, const Location &tloc) const;
+    DateTime getUnprogressed(const DateTime &ndt, const Location &nloc, const DateTime &pdt, const Location &ploc) const;
     
     void setLocation(const Location &loc);
     void setDate(const DateTime &dt);
     ObjData getObjData(ObjType obj) const;
+    // calculates every object in mask with a single observer setup (returns number of valid objects)
+    int calcObjects(double jdEt, const ObjMask &mask, long flags, ObjDataArray &out) const;
+    int calcObjects(const ObjMask &mask, ObjDataArray &out) const
+    { return calcObjects(mJulDay_et, mask, mSweFlags, out); }
     double getAngle(ObjType angle) const;
 
     void calcHouses(HouseSystem hsys);
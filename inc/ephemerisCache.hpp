@@ -0,0 +1,75 @@
+#ifndef EPHEMERIS_CACHE_HPP
+#define EPHEMERIS_CACHE_HPP
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+#include "astro.hpp"
+#include "ephemeris.hpp"
+#include "ephemerisPool.hpp"
+
+// cache params
+#define CHEBY_NODES        8                  // sample nodes per segment (positions + speeds --> 2*CHEBY_NODES coefficients)
+#define CHEBY_COEFFS       (2*CHEBY_NODES)    // polynomial degree + 1
+#define CHEBY_CELL_DAYS    4.0                // span of a cache cell (julian days)
+#define CHEBY_MAX_SPLIT    6                  // maximum cell subdivision depth (2^6 segments --> ~1.5 hours)
+#define CHEBY_MAX_ERROR    (1.0/3600.0)       // default error bound (1 arcsecond)
+#define CHEBY_CHECK_MARGIN 0.5                // fraction of error bound allowed at verification points
+#define CHEBY_MAX_CELLS    8192               // cache is cleared when this many cells are stored
+#define CHEBY_SWEEP_STEP   (CHEBY_CELL_DAYS/64.0) // max step between consecutive lookups for a fit to pay off (~50 swe_calc samples per cell)
+
+namespace astro
+{
+  // Caches object positions as piecewise Chebyshev polynomials over julian day (ET).
+  //  - each segment is a Hermite fit to swe_calc positions and speeds at Chebyshev-Lobatto nodes
+  //  - segments are verified against swe_calc between nodes, and split until within the error bound
+  //  - longitudes are unwrapped across 0/360 before fitting (using speeds to pick the branch)
+  class EphemerisCache
+  {
+  private:
+    struct Segment
+    {
+      double jdStart = 0.0;
+      double jdEnd   = 0.0;
+      std::array<double, CHEBY_COEFFS> lon;
+      std::array<double, CHEBY_COEFFS> lat;
+      std::array<double, CHEBY_COEFFS> dist;
+    };
+    struct Cell
+    {
+      std::vector<Segment> segments; // uniform subdivision of cell (empty --> calculate directly)
+    };
+
+    Ephemeris mSwe;
+    Location  mLocation;
+    long      mSweFlags = 0;
+    double    mMaxError = CHEBY_MAX_ERROR;
+    double    mFitError = 0.0; // largest error measured while fitting (degrees)
+
+    std::array<std::unordered_map<long, Cell>, OBJ_COUNT> mCells;
+    size_t mCellCount = 0;
+
+    bool fitSegment(Ephemeris &swe, ObjType o, double jd0, double jd1, Segment &seg, double &error) const;
+    Cell fitCell(Ephemeris &swe, ObjType o, long index, double &error) const;
+    const Cell& getCell(ObjType o, long index);
+
+  public:
+    EphemerisCache(double maxError=CHEBY_MAX_ERROR);
+
+    // clears cache if location or flags change
+    void setParams(const Location &loc, long sweFlags);
+    void clear();
+
+    // fits all objects in mask over the given window (in parallel if a pool is given)
+    void setWindow(double jdStart, double jdEnd, const ObjMask &mask, EphemerisPool *pool=nullptr);
+    // same as Ephemeris::calcObjects (fits new segments as needed)
+    int calcObjects(double jdEt, const ObjMask &mask, ObjDataArray &out);
+
+    double maxError() const { return mMaxError; } // declared error bound (degrees)
+    double fitError() const { return mFitError; } // largest verified error (degrees)
+    size_t cellCount() const { return mCellCount; }
+  };
+}
+
+#endif // EPHEMERIS_CACHE_HPP
@@ -0,0 +1,43 @@
+#ifndef EPHEMERIS_FILES_HPP
+#define EPHEMERIS_FILES_HPP
+
+#include <cstdio>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+
+namespace astro
+{
+  // Keeps Swiss Ephemeris data files memory-mapped (read-only, shared by every thread).
+  //  - each file is mapped on first open, and stays mapped until exit
+  //  - swe reads segment coefficients straight from the mapping (memcpy -- no stdio), and file headers
+  //    through fmemopen() streams over it (cheap reopens at file boundaries)
+  //  - installed with Ephemeris::setMemoryMapped()
+  class EphemerisFiles
+  {
+  private:
+    struct Mapping
+    {
+      void  *data = nullptr;
+      size_t size = 0;
+    };
+    std::mutex mMutex;
+    std::unordered_map<std::string, Mapping> mFiles;
+
+    EphemerisFiles() { }
+    bool map(const std::string &path, Mapping &mapping);
+
+  public:
+    static EphemerisFiles& instance();
+    // replacement for fopen() (see swe_set_fopen_func) -- falls back to fopen() if the file can't be mapped
+    static FILE* open(const char *path, const char *mode);
+    // mapped contents of file (see swe_set_fmap_func) -- nullptr if the file can't be mapped
+    static const unsigned char* data(const char *path, size_t *size);
+
+    static bool supported();
+    int    fileCount();
+    size_t mappedBytes();
+  };
+}
+
+#endif // EPHEMERIS_FILES_HPP
@@ -0,0 +1,57 @@
+#ifndef EPHEMERIS_POOL_HPP
+#define EPHEMERIS_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "ephemeris.hpp"
+
+#define EPHEMERIS_POOL_CHUNKS 8 // work chunks per thread (load balancing)
+
+namespace astro
+{
+  // Owns a set of worker threads, each with its own Ephemeris.
+  //  - swe state is thread-local (TLS in sweodef.h), so each worker initializes its own context (ephemeris path, topo)
+  //  - parallel_for blocks until all work is done (calls are serialized -- not reentrant from inside a work function)
+  class EphemerisPool
+  {
+  public:
+    typedef std::function<void(Ephemeris &swe, int index)>             IndexFunc;
+    typedef std::function<void(Ephemeris &swe, int index, double jd)> JulianDayFunc;
+
+  private:
+    std::vector<std::thread> mThreads;
+    std::mutex               mMutex;     // guards job state
+    std::mutex               mCallMutex; // serializes parallel_for calls
+    std::condition_variable  mWorkCv;    // wakes workers for a new job
+    std::condition_variable  mDoneCv;    // wakes caller when job is finished
+
+    const IndexFunc *mFunc  = nullptr;
+    int              mCount = 0;
+    int              mChunk = 1;
+    std::atomic<int> mNext{0};  // next index to claim
+    int              mActive = 0; // workers still running current job
+    unsigned long    mJob    = 0; // job generation
+    bool             mQuit   = false;
+
+    void workerLoop();
+
+  public:
+    EphemerisPool(int numThreads=0); // (0 --> hardware concurrency)
+    ~EphemerisPool();
+    static EphemerisPool& global();
+
+    int size() const { return mThreads.size(); }
+
+    // calls func for every index in [0, count), distributed over worker threads
+    void parallel_for(int count, const IndexFunc &func);
+    // calls func for count julian days (jdStart + i*jdStep)
+    void parallel_for(double jdStart, double jdStep, int count, const JulianDayFunc &func);
+  };
+}
+
+#endif // EPHEMERIS_POOL_HPP
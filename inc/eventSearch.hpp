@@ -0,0 +1,125 @@
+#ifndef EVENT_SEARCH_HPP
+#define EVENT_SEARCH_HPP
+
+#include <array>
+#include <vector>
+#include <functional>
+
+#include "astro.hpp"
+#include "ephemeris.hpp"
+#include "ephemerisPool.hpp"
+
+#define EVENT_TOLERANCE  1.0e-6 // root tolerance (julian days -- ~0.1 seconds)
+#define EVENT_MAX_NEWTON 8      // newton iterations before falling back to brent's method
+#define EVENT_MAX_BRENT  64     // brent iterations
+
+namespace astro
+{
+  enum EventType
+    {
+      EVENT_INVALID = -1,
+      EVENT_INGRESS = 0, // object enters a sign
+      EVENT_CUSP,        // object crosses a (fixed) house cusp
+      EVENT_STATION,     // object turns retrograde/direct
+      EVENT_ASPECT,      // two moving objects form an exact aspect
+      EVENT_CROSSING,    // object crosses a fixed longitude
+      EVENT_COUNT
+    };
+
+  inline std::string getEventName(EventType type)
+  {
+    switch(type)
+      {
+      case EVENT_INGRESS:  return "ingress";
+      case EVENT_CUSP:     return "cusp";
+      case EVENT_STATION:  return "station";
+      case EVENT_ASPECT:   return "aspect";
+      case EVENT_CROSSING: return "crossing";
+      default:             return "<UNKNOWN_EVENT>";
+      }
+  }
+
+  // an exact event found by EventSearch
+  struct AstroEvent
+  {
+    EventType type  = EVENT_INVALID;
+    int       query = -1;          // index of query that found this event
+    double    jd    = 0.0;         // julian day of exact event (ET)
+    ObjType   obj1  = OBJ_INVALID;
+    ObjType   obj2  = OBJ_INVALID; // (aspects)
+    int       index = -1;          // sign entered (ingress) | house number (cusp) | AspectType (aspect) | 1 if turning retrograde (station) | longitude index (crossing)
+    int       dir   = 0;           // direction of obj1 motion (+1 direct, -1 retrograde)
+    double    angle = 0.0;         // longitude of obj1 at event
+  };
+
+  // Finds exact event times over a julian day range.
+  //  - each object is sampled once (step based on its motion), and shared by all queries
+  //  - events are bracketed on a cubic Hermite model of the samples (positions + speeds)
+  //  - brackets are refined with Newton iteration on swe_calc positions/speeds, falling back to brent's method
+  class EventSearch
+  {
+  private:
+    struct Query
+    {
+      EventType  type   = EVENT_INVALID;
+      ObjType    obj1   = OBJ_INVALID;
+      ObjType    obj2   = OBJ_INVALID;
+      AspectType aspect = ASPECT_INVALID;
+      std::vector<double> targets; // fixed longitudes (cusp crossings/crossings)
+    };
+    // sampled longitudes (unwrapped) and speeds
+    struct Track
+    {
+      double step = 0.0;
+      std::vector<double> lon;
+      std::vector<double> spd;
+    };
+    // candidate event to refine
+    struct Candidate
+    {
+      int    query  = -1;
+      double target = 0.0; // (wrapped) target longitude/difference
+      int    index  = -1;
+      double t0 = 0.0, t1 = 0.0; // bracket (model)
+      double guess  = 0.0;
+      double accel  = 0.0; // (model acceleration -- estimates newton error)
+    };
+
+    Ephemeris mSwe;
+    Location  mLocation;
+    long      mSweFlags = SEFLG_SWIEPH | SEFLG_SPEED;
+    double    mJdStart  = 0.0;
+    double    mJdEnd    = 0.0;
+    std::vector<Query> mQueries;
+    std::array<Track, OBJ_COUNT> mTracks;
+
+    void forEach(int count, EphemerisPool *pool, const EphemerisPool::IndexFunc &func);
+    void sampleTracks(const ObjMask &objects, EphemerisPool *pool);
+    void trackValue(ObjType o, double jd, double &lon, double &spd) const;
+    void findCrossings(int qi, ObjType o1, ObjType o2, const std::vector<double> &targets, std::vector<Candidate> &out) const;
+    void findStations(int qi, ObjType o, std::vector<Candidate> &out) const;
+    bool refine(const Candidate &c, Ephemeris &swe, AstroEvent &event) const;
+
+  public:
+    EventSearch(long sweFlags=(SEFLG_SWIEPH | SEFLG_SPEED)); // (geocentric by default)
+
+    void setLocation(const Location &loc) { mLocation = loc; mSwe.setLocation(loc); } // (for SEFLG_TOPOCTR)
+    void setFlags(long sweFlags)          { mSweFlags = (sweFlags | SEFLG_SPEED); }
+    void setRange(double jdStart, double jdEnd);
+    double rangeStart() const { return mJdStart; }
+    double rangeEnd() const   { return mJdEnd; }
+
+    void clearQueries() { mQueries.clear(); }
+    void addIngresses(ObjType o);
+    void addCuspCrossings(ObjType o, const std::array<double, 12> &cusps);
+    void addCrossings(ObjType o, const std::vector<double> &longitudes);
+    void addStations(ObjType o);
+    void addAspect(ObjType o1, ObjType o2, AspectType asp);
+    int queryCount() const { return mQueries.size(); } // (query index is returned with each event)
+
+    // finds all events for current queries (sorted by time)
+    std::vector<AstroEvent> search(EphemerisPool *pool=nullptr);
+  };
+}
+
+#endif // EVENT_SEARCH_HPP
@@ -0,0 +1,67 @@
+#ifndef HEADLESS_GRAPH_HPP
+#define HEADLESS_GRAPH_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "astro.hpp"
+#include "chart.hpp"
+#include "projectFile.hpp"
+
+namespace astro
+{
+  // evaluated node of a headless graph (mirrors the calculation done by the matching GUI node)
+  struct HeadlessNode
+  {
+    int         id = -1;
+    std::string type;
+    std::string name;
+    const ProjectNode *saved = nullptr;
+    std::map<int, int> inputs;      // input index --> connected node id
+
+    DateTime date;                  // TimeNode output
+    Location location;              // LocationNode output
+    Chart   *chart = nullptr;       // ChartNode/ProgressNode output
+  };
+
+  // Evaluates the calculation nodes of a project file without a GUI.
+  //  - data nodes (TimeNode/LocationNode/ChartNode/ProgressNode) are evaluated once, in dependency order
+  //  - other node types (views) have no outputs used by these -- skipped
+  //  (project file must stay alive while the graph is used)
+  class HeadlessGraph
+  {
+  private:
+    std::map<int, HeadlessNode> mNodes;
+    std::vector<int>            mOrder;   // evaluation order (inputs first)
+    std::vector<int>            mSkipped; // unsupported node ids
+
+    HeadlessNode* input(const HeadlessNode &node, int index);
+    void updateOrder();
+    void evaluate(HeadlessNode &node);
+
+  public:
+    // node types evaluated by the headless graph
+    static bool supported(const std::string &type);
+
+    HeadlessGraph() = default;
+    HeadlessGraph(const HeadlessGraph &other) = delete;
+    HeadlessGraph& operator=(const HeadlessGraph &other) = delete;
+    ~HeadlessGraph();
+
+    bool load(const ProjectFile &project);
+    void update();   // evaluates all nodes
+    void clear();
+
+    // charts in evaluation order
+    std::vector<const HeadlessNode*> charts() const;
+    const std::vector<int>& skipped() const { return mSkipped; }
+
+    // output of every chart (objects/house cusps, plus aspects for JSON)
+    void writeJson(std::ostream &os) const;
+    void writeCsv(std::ostream &os) const;
+  };
+}
+
+#endif // HEADLESS_GRAPH_HPP
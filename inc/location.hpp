@@ -49,6 +49,7 @@ namespace astro
     Location(const Location &other);
     Location& operator=(const Location &other);
 
+    // geonames queries (defined in locationQuery.cpp -- GUI library only, astro_core has no curl dependency)
     static std::size_t curlCallback(const char* in, std::size_t size, std::size_t num, std::string *out);
     static std::string getTimezoneCurl(const astro::Location &loc);
 
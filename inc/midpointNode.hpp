@@ -0,0 +1,111 @@
+#ifndef MIDPOINT_NODE_HPP
+#define MIDPOINT_NODE_HPP
+
+#include "astro.hpp"
+#include "chart.hpp"
+#include "midpoints.hpp"
+#include "node.hpp"
+
+namespace astro
+{
+  //// node connector indices ////
+  // inputs
+#define MIDPOINTNODE_INPUT_CHART  0
+#define MIDPOINTNODE_INPUT_CHART2 1
+  // outputs
+  ////////////////////////////////
+
+  enum MidpointMode
+    {
+     MIDPOINT_MODE_NATAL = 0, // midpoints of chart, hit by its own objects
+     MIDPOINT_MODE_TRANSIT,   // midpoints of chart, hit by second chart's objects
+     MIDPOINT_MODE_COMPOSITE, // composite points of both charts (and their midpoints)
+     MIDPOINT_MODE_COUNT
+    };
+  static const std::array<std::string, MIDPOINT_MODE_COUNT> MIDPOINT_MODE_NAMES = { "Natal", "Transit", "Composite" };
+
+  class MidpointNode : public Node
+  {
+  private:
+    static std::vector<ConnectorBase*> CONNECTOR_INPUTS()
+    { return {new Connector<Chart>("Chart"), new Connector<Chart>("Second Chart (transit/composite)")}; }
+    static std::vector<ConnectorBase*> CONNECTOR_OUTPUTS()
+    { return {}; }
+
+    MidpointMode mMode   = MIDPOINT_MODE_NATAL;
+    double       mOrb    = MIDPOINT_ORB_DEFAULT;
+    bool         mExtras = false; // include visible registry objects (asteroids/fixed stars)
+    bool mTreeOpen      = true;
+    bool mCompositeOpen = false;
+
+    MidpointTree mTree;
+    std::vector<AspectPoint> mPoints;    // (midpoint objects)
+    std::vector<AspectPoint> mHitPoints; // (objects tested against midpoint axes)
+    std::vector<AspectPoint> mPoints2;
+    // formatted hit table names (rebuilt in onDraw after tree changes)
+    std::vector<std::string> mHitNames; // (point name, or empty if same point as previous hit)
+    std::vector<std::string> mMidNames; // (midpoint name -- "point1/point2")
+    bool mNamesDirty = true;
+
+    // inputs of last update (tree recalculated if changed)
+    const Chart  *mLastChart     = nullptr;
+    const Chart  *mLastChart2    = nullptr;
+    unsigned long mLastVersion   = 0;
+    unsigned long mLastVersion2  = 0;
+    unsigned long mLastSettings  = 0;
+    unsigned long mLastSettings2 = 0;
+    MidpointMode  mLastMode      = MIDPOINT_MODE_COUNT;
+    double        mLastOrb       = -1.0;
+    bool          mLastExtras    = false;
+
+    void getPoints(const Chart *chart, std::vector<AspectPoint> &out) const;
+    std::string pointName(const AspectPoint &p) const;
+
+    virtual void onUpdate() override;
+    virtual void onDraw() override;
+
+    virtual std::map<std::string, std::string>& getSaveParams(std::map<std::string, std::string> &params) const override
+    {
+      params.emplace("mode",     std::to_string((int)mMode));
+      params.emplace("orb",      std::to_string(mOrb));
+      params.emplace("extras",   (mExtras ? "1" : "0"));
+      params.emplace("treeOpen", (mTreeOpen ? "1" : "0"));
+      return params;
+    };
+
+    virtual std::map<std::string, std::string>& setSaveParams(std::map<std::string, std::string> &params) override
+    {
+      auto iter = params.find("mode");
+      if(iter != params.end())
+        {
+          int mode = 0;
+          std::stringstream ss(iter->second); ss >> mode;
+          mMode = (MidpointMode)std::max(0, std::min(mode, (int)MIDPOINT_MODE_COUNT-1));
+        }
+      iter = params.find("orb");      if(iter != params.end()) { std::stringstream ss(iter->second); ss >> mOrb; }
+      iter = params.find("extras");   if(iter != params.end()) { mExtras   = (iter->second != "0"); }
+      iter = params.find("treeOpen"); if(iter != params.end()) { mTreeOpen = (iter->second != "0"); }
+      return params;
+    };
+
+  public:
+    MidpointNode();
+    virtual std::string type() const { return "MidpointNode"; }
+    virtual bool copyTo(Node *other) override
+    { // copy settings
+      if(Node::copyTo(other))
+        {
+          ((MidpointNode*)other)->mMode     = mMode;
+          ((MidpointNode*)other)->mOrb      = mOrb;
+          ((MidpointNode*)other)->mExtras   = mExtras;
+          ((MidpointNode*)other)->mTreeOpen = mTreeOpen;
+          return true;
+        }
+      else { return false; }
+    }
+
+    const MidpointTree& tree() const { return mTree; }
+  };
+}
+
+#endif // MIDPOINT_NODE_HPP
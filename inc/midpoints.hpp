@@ -0,0 +1,71 @@
+#ifndef MIDPOINTS_HPP
+#define MIDPOINTS_HPP
+
+#include <vector>
+
+#include "astro.hpp"
+#include "aspectSweep.hpp"
+
+#define MIDPOINT_ORB_DEFAULT 1.5 // (degrees)
+#define MIDPOINT_ORB_MAX     5.0
+#define MIDPOINT_SORT_SHIFTS 8   // insertion sort gives up after (shifts per midpoint) -- falls back to full sort
+
+namespace astro
+{
+  // midpoint of two points (indices into point list)
+  struct Midpoint
+  {
+    int    point1 = -1;
+    int    point2 = -1;
+    double lon    = 0.0; // nearer midpoint [0, 360) (far midpoint is opposite)
+    double axis   = 0.0; // midpoint axis (lon mod 180) -- points on either end of the axis hit it
+  };
+
+  // point on a midpoint axis
+  struct MidpointHit
+  {
+    int    point    = -1;  // (index into hit point list)
+    int    midpoint = -1;  // (index into midpoints())
+    double orb      = 0.0; // distance from axis (degrees)
+  };
+
+  // nearer midpoint of two longitudes [0, 360)
+  double midpointDegrees(double lon1, double lon2);
+  // composite points -- midpoints of matching points in two lists (same object indices)
+  void compositePoints(const std::vector<AspectPoint> &points1, const std::vector<AspectPoint> &points2,
+                       std::vector<AspectPoint> &out);
+
+  // Midpoint tree of a set of points (every pair), with the points that hit each midpoint axis.
+  //  - midpoints are kept in an array sorted by axis -- each hit point binary searches its window (axis +/- orb),
+  //    so the cost is O(P log M + hits) instead of O(P*M)
+  //  - only midpoints of moved points are recalculated, and the order is repaired with an insertion sort
+  //    (nearly sorted while time is scrubbed) -- unchanged points skip the midpoint step entirely
+  class MidpointTree
+  {
+  private:
+    std::vector<AspectPoint> mPoints;    // (last update)
+    std::vector<Midpoint>    mMidpoints;
+    std::vector<int>         mOrder;     // midpoint indices sorted by axis
+    std::vector<double>      mAxes;      // axis of mOrder[i] (contiguous for binary search)
+    std::vector<MidpointHit> mHits;
+    std::vector<bool>        mMoved;
+
+    void rebuild(const std::vector<AspectPoint> &points);
+    bool updateMoved(const std::vector<AspectPoint> &points);
+    void findHits(const std::vector<AspectPoint> &hitPoints, double orb, bool excludeSelf);
+
+  public:
+    // recalculates midpoints of points, then hits from hitPoints within orb
+    //  - excludeSelf --> skip hits on a midpoint by one of its own points (same AspectPoint::index)
+    //  returns true if midpoints changed
+    bool update(const std::vector<AspectPoint> &points, const std::vector<AspectPoint> &hitPoints, double orb, bool excludeSelf);
+
+    const std::vector<AspectPoint>& points() const    { return mPoints; }
+    const std::vector<Midpoint>&    midpoints() const { return mMidpoints; }
+    // hits ordered by hit point, then orb
+    const std::vector<MidpointHit>& hits() const      { return mHits; }
+    void clear() { mPoints.clear(); mMidpoints.clear(); mOrder.clear(); mAxes.clear(); mHits.clear(); }
+  };
+}
+
+#endif // MIDPOINTS_HPP
@@ -44,6 +44,9 @@ namespace astro
     ObjData mMoonData;
     ObjData mSunData;
     Location mLocation;
+    const Chart  *mLastChart   = nullptr;
+    unsigned long mLastVersion = 0;     // chart positions version of current data
+    bool          mTexDirty    = true;  // texture needs to be rendered again
 
     void renderTexture();
     
@@ -5,12 +5,14 @@
 #include "rect.hpp"
 
 #include "viewSettings.hpp"
+#include "snapshot.hpp"
 
 #include <vector>
 #include <iomanip>
 #include <sstream>
 #include <unordered_set>
 #include <map>
+#include <string_view>
 
 // forward declarations
 struct ImDrawList;
@@ -59,6 +61,43 @@ namespace astro
   template<typename T> class Connector;
   class NodeGraph;
   class ViewSettings;
+  class Chart;
+  struct ChartSnapshot;
+
+  // change detection for connector data (polled by output connectors after their node updates)
+  //  - changed data is published as an immutable snapshot (readable from other threads -- see Connector::snapshot)
+  template<typename T>
+  struct ConnectorState
+  {
+    typedef T SnapshotType;
+    const T *data = nullptr;
+    T        last;
+    Snapshot<T>   snapshot;
+    unsigned long published = 0;
+    bool poll(const T *d)
+    {
+      bool changed = (d != data || (d && *d != last));
+      data = d;
+      if(d) { last = *d; }
+      if(changed)
+        {
+          if(d) { snapshot.publish(*d, ++published); }
+          else  { snapshot.reset(); }
+        }
+      return changed;
+    }
+  };
+  template<>
+  struct ConnectorState<Chart>
+  { // (compared by version -- edits pending an update count as changed)
+    typedef ChartSnapshot SnapshotType;
+    const Chart  *data     = nullptr;
+    unsigned long version  = 0;
+    unsigned long settings = 0;
+    bool          stale    = false; // (snapshot out of date)
+    Snapshot<ChartSnapshot> snapshot;
+    bool poll(const Chart *d);
+  };
   
   // CONNECTOR BASE //
   class ConnectorBase
@@ -83,6 +122,8 @@ namespace astro
     virtual ~ConnectorBase() { disconnectAll(); }
     virtual std::string type() const = 0;
 
+    static unsigned long CONNECTION_VERSION; // incremented whenever any connection is added/removed
+
     void setParent(Node *n, int cId) { mParent = n; mConId = cId; }
     Node* parent()    { return mParent; } // returns parent node
     int conId() const { return mConId; }  // returns connector index in parent node
@@ -92,6 +133,10 @@ namespace astro
     T* get() { return ((Connector<T>*)this)->get(); }
     template<typename T>
     void set(T *data) { ((Connector<T>*)this)->set(data); }
+    template<typename T>
+    std::shared_ptr<const typename ConnectorState<T>::SnapshotType> snapshot() { return ((Connector<T>*)this)->snapshot(); }
+    template<typename T>
+    unsigned long snapshotVersion() { return ((Connector<T>*)this)->snapshotVersion(); }
     
     void setDirection(Direction dir) { mDirection = dir; }    
     bool connect(ConnectorBase *other, bool force=false);
@@ -100,11 +145,17 @@ namespace astro
     
     std::vector<ConnectorBase*> getConnected() { return mConnected; }
     bool isConnected() const { return (mConnected.size() > 0); }
+    bool isConnectedTo(const ConnectorBase *other) const { return (std::find(mConnected.begin(), mConnected.end(), other) != mConnected.end()); }
     bool isConnecting()      { return mConnecting; }
     void beginConnecting()   { mConnecting = true; }
     void endConnecting()     { mConnecting = false; }
 
+    // sets signal on this connector (outputs --> passed to connected inputs)
     void sendSignal(NodeSignal signal);
+    // returns and clears received signals
+    NodeSignal takeSignals() { NodeSignal s = mSignals; mSignals = NODE_SIGNAL_NONE; return s; }
+    // true if connector data changed since last poll
+    virtual bool pollChanged() { return false; }
 
     void draw(bool blocked);
     void drawConnections(ImDrawList *nodeDrawList, ImDrawList *graphDrawList, bool ghost=false);
@@ -119,10 +170,12 @@ namespace astro
     friend class ConnectorBase;
   protected:
     T *mData = nullptr;
+    ConnectorState<T> mState;
   public:
     Connector(std::string name="", T *data=nullptr) : ConnectorBase(name), mData(data) { }
     virtual ~Connector() { }
     virtual std::string type() const override { return std::string(typeid(T).name()); }
+    virtual bool pollChanged() override { return mState.poll(get()); }
     
     T* get()
     {
@@ -135,6 +188,19 @@ namespace astro
       if(mDirection == CONNECTOR_INPUT && mConnected.size() > 0)
         { ((Connector<T>*)mConnected[0])->mData = data; }
     }
+    // last published snapshot of output data (published when the producing node updates -- nullptr if none)
+    //  (hold the returned pointer to keep reading it on another thread while newer snapshots are published)
+    std::shared_ptr<const typename ConnectorState<T>::SnapshotType> snapshot()
+    {
+      if(mDirection == CONNECTOR_INPUT) { return (mConnected.size() > 0 ? ((Connector<T>*)mConnected[0])->mState.snapshot.get() : nullptr); }
+      else                              { return mState.snapshot.get(); }
+    }
+    // version of last published snapshot (changes whenever output data changes -- 0 if none)
+    unsigned long snapshotVersion()
+    {
+      if(mDirection == CONNECTOR_INPUT) { return (mConnected.size() > 0 ? ((Connector<T>*)mConnected[0])->mState.snapshot.version() : 0); }
+      else                              { return mState.snapshot.version(); }
+    }
   };
   ///////////////////
   
@@ -169,6 +235,13 @@ namespace astro
     bool mDragging     = false;   // whether mouse is dragging window
 
     bool mBlocked      = false;   // whether mouse is blocked by other nodes
+    bool mDirty        = true;    // node needs update (settings edited, connected, etc.)
+
+    // settings edits (undo history) -- params compared when interaction with node ui ends
+    bool mEditing      = false;
+    bool mEditLive     = false;   // (live nodes change on their own -- edits not recorded)
+    std::map<std::string, std::string> mEditParams; // params when interaction started
+    void trackEdit(bool editing);
     
     // Vec2f mNextPos = Vec2f(0,0);  // node window pos
     Vec2f mMinSize = Vec2f(1,1);     // min size (to be set by child class)
@@ -180,7 +253,13 @@ namespace astro
 
     // override in child classes to draw node
     virtual void onDraw()   { }
+    // override in child classes to update node data
+    //  - may run on a graph worker thread (independent branches are updated in parallel -- see NodeGraph::update)
+    //  - only touch this node's own data and the data of its connected inputs/outputs (same branch)
+    //  - no ImGui/GL calls or shared (non-const) globals -- keep those in onDraw (UI thread)
     virtual void onUpdate() { }
+    // override to return true while node changes on its own (e.g. live clock) -- updated every frame
+    virtual bool isLive() const { return false; }
 
     virtual std::map<std::string, std::string>& getSaveParams(std::map<std::string, std::string> &params) const { return params; }
     virtual std::map<std::string, std::string>& setSaveParams(std::map<std::string, std::string> &params)       { return params; }
@@ -205,6 +284,7 @@ namespace astro
 
     void DrawOutputs(bool blocked);
     void DrawInputs(bool blocked);
+    void updateRect(); // updates connector positions and graph index after node moved/resized
     bool BeginDraw();
     void EndDraw();
     
@@ -258,6 +338,15 @@ namespace astro
     std::string toSaveString() const;
     // returns remaining string after base class parameters
     std::string fromSaveString(const std::string &saveStr);
+    // all saved params (base class + getSaveParams) -- same data as the save string (see ProjectFile)
+    std::map<std::string, std::string>& getParams(std::map<std::string, std::string> &params) const;
+    void setParams(std::map<std::string, std::string> &params);
+    // (base class params read in place -- only node-specific params copied for setSaveParams)
+    void setParams(const std::vector<std::pair<std::string_view, std::string_view>> &params);
+    // sets changed settings params (undo/redo -- see NodeGraph::recordParams)
+    void applyParams(const std::map<std::string, std::string> &changed);
+    // records settings edited since interaction started (called when it ends, or before undo)
+    void commitEdit();
     
     int id() const     { return mParams->id; }
     void setid(int id) { mParams->id = id; }
@@ -265,6 +354,7 @@ namespace astro
     void setName(const std::string &name) { mParams->name = name; }
     
     void setFirstFrame(bool firstFrame) { mFirstFrame = firstFrame; }
+    bool isFirstFrame() const           { return mFirstFrame; }
     void bringToFront();
     
     std::vector<ConnectorBase*>& outputs()             { return mOutputs; }
@@ -287,12 +377,14 @@ namespace astro
     void setDragging(bool drag)     { mDragging = drag; }
     
     bool isBlocked() const          { return mBlocked; }
+    bool isDirty() const            { return mDirty; }
+    void setDirty()                 { mDirty = true; }
     
     void setMinSize(const Vec2f &s) { mMinSize = s; }
     Vec2f getMinSize() const        { return mMinSize; }
-    void setRect(const Rect2f &r)   { mParams->rect = r; }
+    void setRect(const Rect2f &r);
     void setPos(const Vec2f &p);
-    void setSize(const Vec2f &s)    { mParams->rect.setSize(s); }
+    void setSize(const Vec2f &s);
     
     const Rect2f& rect() const      { return mParams->rect; }
     const Vec2f& pos() const        { return mParams->rect.p1; }
@@ -302,6 +394,10 @@ namespace astro
 
     void drawConnections(ImDrawList *graphDrawList, bool ghost=false);
     bool draw(ImDrawList *graphDrawList, bool blocked, bool ghost=false);
+    // called instead of draw() while node is off-screen (resets mouse/ui state)
+    void cull();
+    // updates node if dirty, live, or an input was signaled -- then signals outputs whose data changed
+    //  (call in topological order so changes reach every downstream node in one pass)
     void update();
   };
 }
@@ -4,11 +4,16 @@
 #include "astro.hpp"
 #include "node.hpp"
 #include "vector.hpp"
+#include "projectFile.hpp" // (SAVE_FILE_VERSION)
+#include "spatialIndex.hpp"
+#include "connectionRouter.hpp"
 
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <functional>
+#include <deque>
+#include <map>
 
 
 // forward declarations
@@ -16,13 +21,16 @@ namespace imgui_addons { class ImGuiFileBrowser; }
 struct ImDrawList;
 
 #define DEFAULT_PROJECT_DIR "./projects"
-#define SAVE_FILE_VERSION   "0.1"
 
 #define FILE_DIALOG_SIZE Vec2f(960, 690)
 
+#define GRAPH_THREADS_MAX 64 // graph evaluation workers (see ViewSettings::graphThreads)
+#define GRAPH_CULL_PADDING 32.0f // screen-space margin around view -- nodes outside aren't drawn
+
 namespace astro
 {
   class ViewSettings;
+  class EphemerisPool;
   
   struct NodeType
   {
@@ -37,34 +45,66 @@ namespace astro
   };
 
 
-  // TODO: Action stack for undoing with Ctrl-Z
-  // enum ActionType
-  //   {
-  //     ACTION_INVALID = -1,
-  //     ACTION_ADD_NODE,
-  //     ACTION_REMOVE_NODE,
-  //     ACTION_MOVE_NODE,   // (set after full node move -- mouse press, drag, release)
-  //     ACTION_DELETE_NODE,
-  //     ACTION_CUT,
-  //     ACTION_COPY,
-  //     ACTION_PASTE,
-  //     ACTION_CHANGE_VALUE,
-  //   };
-  // struct GraphAction
-  // {
-  //   ActionType type = ACTION_INVALID;
-  // };
+  // undo/redo history -- each action stores only what changed (no graph snapshots)
+  enum ActionType
+    {
+      ACTION_INVALID = -1,
+      ACTION_ADD_NODES,     // nodes placed/pasted/copied
+      ACTION_REMOVE_NODES,  // nodes deleted/cut
+      ACTION_MOVE_NODES,    // (one per drag -- mouse press, drag, release)
+      ACTION_CONNECT,       // connections added/removed through connector ui
+      ACTION_CHANGE_PARAMS, // node settings edited (see Node::draw)
+    };
+  struct GraphAction
+  {
+    ActionType type = ACTION_INVALID;
+    // ADD/REMOVE --> detached nodes are owned by the action (deleted with it)
+    std::vector<Node*> nodes;
+    bool ownsNodes = false;
+    // MOVE/CHANGE_PARAMS --> node ids
+    std::vector<int> ids;
+    Vec2f move;
+    bool  moving = false; // (drag still in progress -- further moves coalesced)
+    // CONNECT (and connections of detached ADD/REMOVE nodes)
+    std::vector<Node::Connection> added;
+    std::vector<Node::Connection> removed;
+    // CHANGE_PARAMS --> changed params only
+    std::map<std::string, std::string> oldParams;
+    std::map<std::string, std::string> newParams;
+
+    GraphAction(ActionType t) : type(t) { }
+    ~GraphAction() { if(ownsNodes) { for(auto n : nodes) { delete n; } } }
+  };
 
   
   class NodeGraph
   {
   private:
-    // TODO: Action stack for undoing with Ctrl-Z
-    // std::deque<GraphAction*> mActionStack;  // for undoing
+    std::deque<GraphAction*> mUndoStack; // (oldest first -- size limited by ViewSettings::graphHistory)
+    std::deque<GraphAction*> mRedoStack;
 
     ViewSettings *mViewSettings = nullptr;
     std::unordered_map<int, Node*> mNodes; // maps ID to pointer
+    std::vector<Node*> mOrder;             // nodes in topological order (producers before consumers)
+    bool          mOrderDirty       = true; // (nodes added/removed)
+    unsigned long mOrderConnections = 0;    // ConnectorBase::CONNECTION_VERSION of mOrder
+    std::vector<std::vector<Node*>> mBranches; // independent branches (no connections between them) -- each in topological order
+    EphemerisPool *mBranchPool = nullptr;       // workers for parallel branch updates (nullptr --> serial)
+    double         mUpdateTime = 0.0;           // duration of last update (ms)
     std::vector<Node*> mSelectedNodes; // set of nodes that are selected
+    SpatialIndex       mNodeIndex;         // node rects (graph space) -- culling and mouse hit-tests
+    bool               mIndexDirty = true; // (nodes added/removed -- rebuilt before next use)
+    std::vector<Node*> mDrawNodes;         // nodes drawn this frame (on-screen/active), back to front
+    std::vector<Node*> mLastDrawn;         // (mDrawNodes of previous frame, by pointer -- culled when no longer drawn)
+    float              mTopZ   = -1.0f;    // z of front-most node (raised nodes take the next value -- see raiseNode)
+    bool               mZDirty = true;     // (nodes added/removed -- z re-ranked before next draw)
+    SpatialIndex       mConnectionIndex;   // connection bounds (graph space) -- connections crossing the view between culled nodes
+    std::vector<std::pair<ConnectorBase*, ConnectorBase*>> mConnectionList; // (output, input) -- indexed by id in mConnectionIndex
+    bool               mConnectionsDirty   = true; // (nodes moved/added/removed)
+    unsigned long      mConnectionsVersion = 0;    // ConnectorBase::CONNECTION_VERSION of mConnectionIndex
+    ConnectionRouter   mRouter{mNodeIndex};     // cached connection paths (around node rects)
+    unsigned long      mRouteConnections = 0;   // ConnectorBase::CONNECTION_VERSION when routes were last pruned
+    std::vector<Vec2f> mRouteScratch;           // (path of uncached connection)
     Vec2f  mGraphCenter = Vec2f(0,0); // graph-space point to be centered in view
     float  mGraphScale  = 1.0f;       // graph view scaling
     Vec2f  mViewPos;                  // screen-space position of nodeGraph view
@@ -98,12 +138,30 @@ namespace astro
     std::string mSaveFile = ""; // last saved/loaded file name
     imgui_addons::ImGuiFileBrowser *mFileDialog;
     
-    bool saveToFile(const std::string &path);
-    bool loadFromFile(const std::string &path);
+    bool saveToFile(const std::string &path);   // (binary if path has PROJECT_BINARY_EXT)
+    bool loadFromFile(const std::string &path); // (text or binary -- detected from file header)
+    bool loadText(const std::string &path, std::string &version);
+    bool loadBinary(const std::string &path, std::string &version);
 
     void BeginDraw();
     void EndDraw();
     void drawLines(ImDrawList *drawList);
+    void updateOrder(); // rebuilds mOrder/mBranches if nodes/connections changed
+    void updateIndex(); // rebuilds mNodeIndex if nodes added/removed
+    void updateZ();     // re-ranks node z values (0 to N-1) if nodes added/removed or raised past NODE_TOP_Z
+    void updateConnectionIndex(); // rebuilds mConnectionIndex if nodes moved or connections changed
+    void nodesChanged() { mOrderDirty = true; mIndexDirty = true; mZDirty = true; mConnectionsDirty = true; mRouter.clear(); }
+    int  updatePool();  // (re)creates mBranchPool to match view settings -- returns number of workers
+
+    // undo history
+    void pushAction(GraphAction *action); // clears redo stack and drops oldest actions past history size
+    void clearHistory();
+    void removeNodes(const std::vector<Node*> &nodes); // (recorded)
+    void attachNodes(GraphAction *action); // adds action nodes to graph and restores their connections
+    void detachNodes(GraphAction *action); // removes action nodes from graph (connections saved in action)
+    bool connect(const Node::Connection &con);
+    void disconnect(const Node::Connection &con);
+    void applyAction(GraphAction *action, bool undo);
     
   public:
     static const std::unordered_map<std::string, NodeType> NODE_TYPES;
@@ -116,6 +174,17 @@ namespace astro
     ViewSettings* getViewSettings() { return mViewSettings; }
     const std::unordered_map<int, Node*>& getNodes() const { return mNodes; }
     std::unordered_map<int, Node*>& getNodes() { return mNodes; }
+    // nodes in evaluation order (producers before consumers -- nodes in cycles last, by id)
+    const std::vector<Node*>& getOrder() { updateOrder(); return mOrder; }
+    // independent branches of graph (weakly connected components, largest first)
+    const std::vector<std::vector<Node*>>& getBranches() { updateOrder(); return mBranches; }
+    double getUpdateTime() const { return mUpdateTime; }
+    // node rects in graph space (kept current as nodes move)
+    const SpatialIndex& getIndex() { updateIndex(); return mNodeIndex; }
+    void nodeMoved(Node *n); // (called by Node when its rect changes)
+    void raiseNode(Node *n); // moves node above all others (called by Node::bringToFront)
+    // top node under graph-space point (nullptr if none)
+    Node* nodeAt(const Vec2f &p);
 
     void addNode(Node *n, bool select=true);  // adds node to mNodes
     Node* addNode(const std::string &type, bool select=true); // if select is true, deselect other nodes)
@@ -126,7 +195,15 @@ namespace astro
     void cut();
     void copy();
     void paste();
-    bool undo();
+    bool undo(); // returns false if nothing to undo
+    bool redo();
+    bool canUndo() const { return !mUndoStack.empty(); }
+    bool canRedo() const { return !mRedoStack.empty(); }
+    // records node additions/moves/connection changes/param edits made through the graph ui
+    void recordAdd(const std::vector<Node*> &nodes);
+    void recordMove(const std::vector<Node*> &nodes, const Vec2f &dpos); // (coalesced until mouse released)
+    void recordConnect(const std::vector<Node::Connection> &before, const std::vector<Node::Connection> &after);
+    void recordParams(Node *n, const std::map<std::string, std::string> &oldParams, const std::map<std::string, std::string> &newParams);
     
     // selection
     void selectNode(Node *n);
@@ -176,10 +253,14 @@ namespace astro
     Rect2f screenToGraph(const Rect2f &r) const  { return Rect2f(screenToGraph(r.p1), screenToGraph(r.p2)); }
     Rect2f graphToScreen(const Rect2f &r) const  { return Rect2f(graphToScreen(r.p1), graphToScreen(r.p2)); }
     
-    // finds a path from start to end point that doesn't intersect any node rects.
-    std::vector<Vec2f> findOrthogonalPath(const Vec2f &start, const Vec2f &end);
+    // simple orthogonal path from start to end point (ignores node rects -- e.g. for a connection being made)
+    std::vector<Vec2f> findOrthogonalPath(const Vec2f &start, const Vec2f &end) { return ConnectionRouter::simplePath(start, end); }
+    // path of connection between output and input connectors around node rects (cached until an endpoint/obstacle moves)
+    const std::vector<Vec2f>& getRoute(ConnectorBase *out, ConnectorBase *in);
     
     void draw();
+    // updates nodes in topological order -- independent branches run in parallel on graph workers
+    //  (blocks until every branch is done; see Node::onUpdate for what nodes may touch)
     void update();
 
     void showIds(bool show) { mShowIds = show; }
@@ -0,0 +1,144 @@
+#ifndef OBJECT_REGISTRY_HPP
+#define OBJECT_REGISTRY_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "ephemeris.hpp"
+
+#define OBJ_REGISTRY_CHUNK   256            // objects per evaluation chunk (one observer setup per chunk -- multiple of 64, so
+                                            //  chunks evaluated on separate threads never share a bitset word)
+#define OBJ_REGISTRY_STARS   "sefstars.txt" // fixed star catalog (in ephemeris path)
+#define OBJ_REGISTRY_MAG_MAX 3.0            // default magnitude limit when loading stars
+
+namespace astro
+{
+  class EphemerisPool;
+
+  // dynamically sized bitset (visibility/validity masks for registry objects)
+  class DynamicBitset
+  {
+  private:
+    std::vector<uint64_t> mWords;
+    int mSize = 0;
+
+  public:
+    DynamicBitset(int size=0, bool value=false) { resize(size, value); }
+
+    int size() const { return mSize; }
+    void resize(int size, bool value=false);
+    void fill(bool value);
+
+    bool test(int i) const          { return (mWords[i >> 6] >> (i & 63)) & 1; }
+    void set(int i, bool value=true)
+    {
+      if(value) { mWords[i >> 6] |=  (uint64_t(1) << (i & 63)); }
+      else      { mWords[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    }
+    bool operator[](int i) const { return test(i); }
+
+    int  count() const;
+    bool any() const;
+    // calls func(i) for each set bit (skips empty words)
+    template<typename F>
+    void forEach(F func) const
+    {
+      for(int w = 0; w < (int)mWords.size(); w++)
+        {
+          for(uint64_t bits = mWords[w]; bits; bits &= bits-1)
+            { func((w << 6) + __builtin_ctzll(bits)); }
+        }
+    }
+    // bitwise and (sizes must match)
+    DynamicBitset& operator&=(const DynamicBitset &other);
+  };
+
+  enum ExtraObjKind
+    {
+     EXTRA_ASTEROID = 0, // numbered asteroid (ephemeris file in ast* directories)
+     EXTRA_STAR,         // fixed star (from star catalog)
+    };
+
+  // object added at runtime (beyond built-in ObjType objects)
+  struct ExtraObject
+  {
+    ExtraObjKind kind;
+    std::string  name;
+    int          sweId     = -1;    // swe_calc index (asteroids -- SE_AST_OFFSET + number)
+    std::string  starKey;           // swe_fixstar2 search key (stars -- ",<nomenclature>")
+    double       magnitude = 0.0;   // (stars)
+    bool         visible   = true;  // default visibility for new charts
+  };
+
+  // per-chart positions of registry objects (one array per field)
+  struct ExtraObjectArrays
+  {
+    unsigned long registryVersion = 0; // registry version these arrays were sized/calculated for
+    std::vector<double> longitude;
+    std::vector<double> latitude;
+    std::vector<double> distance;
+    std::vector<double> lonSpeed;
+    std::vector<double> angle;     // (zodiac transform applied)
+    DynamicBitset       valid;
+    DynamicBitset       visible;
+
+    int size() const { return longitude.size(); }
+    void resize(int n);
+  };
+
+  // immutable copy of the registry's object list (see ObjectRegistry::snapshot)
+  //  - charts updated on other threads calculate from one of these (never from the registry itself)
+  struct ObjectList
+  {
+    unsigned long            version = 0; // (ObjectRegistry::version when taken)
+    std::vector<ExtraObject> objects;
+
+    int size() const                    { return objects.size(); }
+    const ExtraObject& get(int i) const { return objects[i]; }
+
+    // calculates objects [begin, end) on the calling thread (one observer setup)
+    void calcObjects(double jdEt, long flags, const Location &loc, int begin, int end, ExtraObjectArrays &out) const;
+    // calculates all objects in chunks of OBJ_REGISTRY_CHUNK (distributed over pool threads if given)
+    void calcObjects(double jdEt, long flags, const Location &loc, ExtraObjectArrays &out, EphemerisPool *pool=nullptr) const;
+  };
+
+  // Runtime list of extra objects (asteroids/fixed stars)
+  //  - modified and read from the main thread only -- other threads get a snapshot() from it
+  //  - version() changes whenever the list changes -- charts resize/recalculate their arrays when it does
+  class ObjectRegistry
+  {
+  private:
+    std::vector<ExtraObject> mObjects;
+    unsigned long mVersion = 1;
+    mutable std::shared_ptr<const ObjectList> mSnapshot; // (rebuilt by snapshot() after changes -- std::atomic_load/atomic_store only)
+
+    ObjectRegistry() { }
+
+  public:
+    static ObjectRegistry& instance();
+
+    int size() const                     { return mObjects.size(); }
+    unsigned long version() const        { return mVersion; }
+    const ExtraObject& get(int i) const  { return mObjects[i]; }
+    const std::vector<ExtraObject>& objects() const { return mObjects; }
+    int find(const std::string &name) const; // returns index, or -1
+
+    // immutable copy of current object list (shared until the registry changes)
+    //  - safe to call from graph worker threads (NodeGraph::update takes it on the main thread first, so workers only load it)
+    std::shared_ptr<const ObjectList> snapshot() const;
+
+    int addAsteroid(int number, const std::string &name="");  // returns index
+    int addStar(const std::string &name, const std::string &nomenclature, double magnitude);
+    void clear();
+    void clear(ExtraObjKind kind);
+
+    // loads stars from catalog with magnitude <= maxMagnitude (returns number added)
+    int loadStars(double maxMagnitude=OBJ_REGISTRY_MAG_MAX, const std::string &path=std::string(EPHEM_PATH)+"/"+OBJ_REGISTRY_STARS);
+    // adds every numbered asteroid with an ephemeris file in path/ast*/ (returns number added)
+    int loadAsteroids(const std::string &path=EPHEM_PATH);
+  };
+}
+
+#endif // OBJECT_REGISTRY_HPP
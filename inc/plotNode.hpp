@@ -3,6 +3,7 @@
 
 #include "astro.hpp"
 #include "chart.hpp"
+#include "backgroundJob.hpp"
 #include "node.hpp"
 
 namespace astro
@@ -24,13 +25,41 @@ namespace astro
     static std::vector<ConnectorBase*> CONNECTOR_OUTPUTS()
     { return {}; }
 
+    // plot inputs (chart snapshot -- plotted on a background thread)
+    struct PlotRequest
+    {
+      ChartSnapshot chart;
+      ObjType       objType   = OBJ_SUN;
+      int           dayRadius = 0;
+    };
+    // complete plot (drawn while the next one is calculated)
+    struct PlotData
+    {
+      std::vector<float> data;
+      DateTime startDate;
+      DateTime endDate;
+      ObjType  objType = OBJ_SUN;
+    };
+    
+    int      mDayRadius  = 30;
+    ObjType  mObjType    = OBJ_SUN;
+    // inputs of last request (skip requests while chart is unchanged)
+    unsigned long mLastVersion   = 0;
+    unsigned long mLastSettings  = 0;
+    ObjType       mLastObjType   = OBJ_SUN;
+    int           mLastDayRadius = 0;
+
+    // plot job state (job thread only)
     std::vector<float> mData;
     DateTime mOldStartDate;
     DateTime mOldEndDate;
-    int      mDayRadius  = 30;
     Chart    mOldChart;
-    ObjType  mOldObjType = OBJ_SUN;
-    ObjType  mObjType    = OBJ_SUN;
+    ObjType  mOldObjType   = OBJ_SUN;
+    int      mOldDayRadius = 0;
+    unsigned long mOldSettings = 0;
+    BackgroundJob<PlotRequest, PlotData> mJob; // (declared last -- joined before the members it uses are destroyed)
+
+    void calcPlot(const PlotRequest &request, PlotData &out);
     
     virtual void onUpdate() override;
     virtual void onDraw() override;
@@ -0,0 +1,125 @@
+#ifndef PROJECT_BINARY_HPP
+#define PROJECT_BINARY_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vector.hpp"
+
+#define PROJECT_BINARY_EXT     ".agb"
+#define PROJECT_BINARY_MAGIC   "AGPB"
+#define PROJECT_BINARY_VERSION 1
+#define PROJECT_BINARY_ALIGN   8  // table alignment (bytes)
+
+namespace astro
+{
+  class ProjectFile;
+
+  //// BINARY PROJECT FORMAT ////
+  //  [header] [node table] [param table] [connection table] [string blob]
+  //  - tables are fixed-size entries (8-byte aligned) -- read in place from the mapped file
+  //  - strings are (offset, size) ranges of the blob (not null-terminated)
+  //  - each node owns a contiguous range of the param table (same key/value strings as the text format)
+  //  (native byte order -- little-endian on all supported platforms)
+  struct ProjectBinaryString
+  {
+    uint32_t offset = 0; // (bytes from start of string blob)
+    uint32_t size   = 0;
+  };
+  struct ProjectBinaryHeader
+  {
+    char     magic[4];          // PROJECT_BINARY_MAGIC
+    uint32_t formatVersion;     // PROJECT_BINARY_VERSION
+    uint32_t headerSize;        // sizeof(ProjectBinaryHeader)
+    uint32_t nodeCount;
+    uint32_t paramCount;
+    uint32_t connectionCount;
+    uint64_t nodeOffset;        // (bytes from start of file)
+    uint64_t paramOffset;
+    uint64_t connectionOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+    float    centerX;           // graph view
+    float    centerY;
+    float    scale;
+    ProjectBinaryString saveVersion; // text format version (SAVE_FILE_VERSION)
+    uint32_t reserved;
+  };
+  struct ProjectBinaryNode
+  {
+    int32_t  id;
+    ProjectBinaryString type;
+    ProjectBinaryString name;
+    uint32_t firstParam;        // (index into param table)
+    uint32_t paramCount;
+  };
+  struct ProjectBinaryParam
+  {
+    ProjectBinaryString key;
+    ProjectBinaryString value;
+  };
+  struct ProjectBinaryConnection
+  {
+    int32_t outNode;
+    int32_t outIndex;
+    int32_t inNode;
+    int32_t inIndex;
+  };
+
+  // Read-only view of a binary project file (memory-mapped -- falls back to reading the file if mapping isn't supported).
+  //  - open() validates the header and table bounds, then every accessor reads the mapping in place (no allocations)
+  //  - string views stay valid until close()
+  class ProjectBinary
+  {
+  private:
+    const char *mData   = nullptr;
+    size_t      mSize   = 0;
+    bool        mMapped = false;
+    std::vector<char> mBuffer; // (fallback if not mapped)
+
+    const ProjectBinaryHeader     *mHeader      = nullptr;
+    const ProjectBinaryNode       *mNodes       = nullptr;
+    const ProjectBinaryParam      *mParams      = nullptr;
+    const ProjectBinaryConnection *mConnections = nullptr;
+    const char                    *mStrings     = nullptr;
+
+    bool validate();
+
+  public:
+    ProjectBinary() = default;
+    ProjectBinary(const ProjectBinary &other) = delete;
+    ProjectBinary& operator=(const ProjectBinary &other) = delete;
+    ~ProjectBinary() { close(); }
+
+    // true if file starts with PROJECT_BINARY_MAGIC
+    static bool isBinary(const std::string &path);
+    // writes project in binary format
+    static bool write(const ProjectFile &project, const std::string &path);
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return (mHeader != nullptr); }
+    bool isMapped() const { return mMapped; }
+
+    std::string_view str(const ProjectBinaryString &s) const { return std::string_view(mStrings + s.offset, s.size); }
+    std::string_view version() const { return str(mHeader->saveVersion); }
+    Vec2f center() const             { return Vec2f(mHeader->centerX, mHeader->centerY); }
+    float scale() const              { return mHeader->scale; }
+
+    int nodeCount() const                                   { return mHeader->nodeCount; }
+    const ProjectBinaryNode& node(int i) const              { return mNodes[i]; }
+    const ProjectBinaryParam* params(int nodeIndex) const   { return mParams + mNodes[nodeIndex].firstParam; } // (node(i).paramCount entries)
+    // value of node param (empty view if missing -- linear search of the node's params)
+    std::string_view param(int nodeIndex, std::string_view key) const;
+
+    int connectionCount() const                             { return mHeader->connectionCount; }
+    const ProjectBinaryConnection& connection(int i) const  { return mConnections[i]; }
+
+    // copies contents into project (text format data)
+    void toProject(ProjectFile &project) const;
+  };
+}
+
+#endif // PROJECT_BINARY_HPP
@@ -0,0 +1,78 @@
+#ifndef PROJECT_FILE_HPP
+#define PROJECT_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+#include <ostream>
+
+#include "vector.hpp"
+
+#define SAVE_FILE_VERSION   "0.1"
+
+namespace astro
+{
+  // node entry of a project file (NODE line -- params as saved by Node::toSaveString)
+  struct ProjectNode
+  {
+    int         id = -1;
+    std::string type;
+    std::string name;
+    std::map<std::string, std::string> params; // (all saved params, including nodeType/nodeName/nodeId)
+
+    // returns saved param, or defaultVal if missing
+    std::string param(const std::string &key, const std::string &defaultVal="") const
+    {
+      auto iter = params.find(key);
+      return (iter != params.end() ? iter->second : defaultVal);
+    }
+  };
+
+  // connection from a node output to a node input (CON line -- one entry per connected input)
+  struct ProjectConnection
+  {
+    int outNode  = -1;
+    int outIndex = -1;
+    int inNode   = -1;
+    int inIndex  = -1;
+  };
+
+  // Node graph project file -- parsed into plain data, without creating any nodes
+  //  - text (.ags) or binary (.agb -- see ProjectBinary) format, detected on load -- converts losslessly between them
+  //  (no GUI dependency -- see NodeGraph::loadFromFile for the interactive graph)
+  class ProjectFile
+  {
+  private:
+    std::string mVersion = SAVE_FILE_VERSION;
+    Vec2f       mCenter;
+    float       mScale   = 1.0f;
+    std::vector<ProjectNode>       mNodes;       // (file order)
+    std::vector<ProjectConnection> mConnections;
+
+  public:
+    // parses NODE line params (NODE { key : "value", ... })
+    static std::map<std::string, std::string> parseNodeParams(const std::string &line);
+
+    bool load(const std::string &path); // (text or binary)
+    bool load(std::istream &is);        // (text)
+    bool save(const std::string &path) const; // (binary if path has PROJECT_BINARY_EXT)
+    void save(std::ostream &os) const;        // (text)
+    void clear();
+
+    void setVersion(const std::string &version)       { mVersion = version; }
+    void setCenter(const Vec2f &center)               { mCenter = center; }
+    void setScale(float scale)                        { mScale = scale; }
+    void addNode(const ProjectNode &node)             { mNodes.push_back(node); }
+    void addConnection(const ProjectConnection &con)  { mConnections.push_back(con); }
+
+    const std::string& version() const                         { return mVersion; }
+    Vec2f center() const                                       { return mCenter; }
+    float scale() const                                        { return mScale; }
+    const std::vector<ProjectNode>& nodes() const              { return mNodes; }
+    const std::vector<ProjectConnection>& connections() const  { return mConnections; }
+    const ProjectNode* getNode(int id) const; // (nullptr if missing)
+  };
+}
+
+#endif // PROJECT_FILE_HPP
@@ -23,6 +23,7 @@ namespace astro
     SettingsForm *mParent = nullptr;
     std::string mName;
     std::string mId;
+    bool mEditing = false; // (input active when last drawn)
     virtual bool onDraw(float scale, bool busy=false) { return busy; }
     
   public:
@@ -34,6 +35,7 @@ namespace astro
     virtual void setParent(SettingsForm *parent) { mParent = parent; }
     
     virtual bool hasChanged() const { return false; }
+    bool editing() const { return mEditing; } // true while input is being edited (e.g. slider dragged/text typed)
     
     bool draw(float scale, bool busy=false);
     
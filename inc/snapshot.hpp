@@ -0,0 +1,60 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <memory>
+#include <atomic>
+
+namespace astro
+{
+  // Double-buffered, versioned snapshot of data shared between threads (RCU-style).
+  //  - the writer fills back(), then publish() swaps it to the front
+  //  - readers get() the front -- immutable, and stays valid while held (even after newer snapshots are published)
+  //  - the old front is reused as the next back buffer once no reader holds it (no allocation in steady state)
+  //  (single writer -- any number of readers)
+  template<typename T>
+  class Snapshot
+  {
+  private:
+    std::shared_ptr<const T>   mFront;      // (atomic load/store)
+    std::shared_ptr<T>         mFrontWrite; // writer's handle to front (recycled after next publish)
+    std::shared_ptr<T>         mBack;
+    std::atomic<unsigned long> mVersion{0};
+
+  public:
+    Snapshot() = default;
+    Snapshot(const Snapshot &other) = delete;
+    Snapshot& operator=(const Snapshot &other) = delete;
+
+    // writable buffer for next snapshot (writer only -- contents are stale)
+    T& back()
+    {
+      if(!mBack || mBack.use_count() > 1) { mBack = std::make_shared<T>(); } // (still held by a reader)
+      else // (use_count() is a relaxed load -- synchronize with the last reader's release before overwriting)
+        { std::atomic_thread_fence(std::memory_order_acquire); }
+      return *mBack;
+    }
+    // makes back buffer the new front
+    void publish(unsigned long version)
+    {
+      back(); // (make sure back buffer exists)
+      std::atomic_store(&mFront, std::shared_ptr<const T>(mBack));
+      mVersion = version;
+      std::swap(mFrontWrite, mBack);
+    }
+    // copies data into back buffer and publishes it
+    void publish(const T &data, unsigned long version) { back() = data; publish(version); }
+    // clears front (readers still holding the old snapshot keep it)
+    void reset()
+    {
+      std::atomic_store(&mFront, std::shared_ptr<const T>());
+      mFrontWrite.reset();
+      mVersion = 0;
+    }
+
+    // latest published snapshot (nullptr if none)
+    std::shared_ptr<const T> get() const { return std::atomic_load(&mFront); }
+    unsigned long version() const        { return mVersion; }
+  };
+}
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,56 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include "vector.hpp"
+#include "rect.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#define SPATIAL_CELL_SIZE 512.0f // default grid cell size (graph units -- about one node)
+
+namespace astro
+{
+  // Uniform grid over rects (e.g. node rects in graph space) -- maps integer ids to the cells their rect overlaps
+  //  - update() only touches the grid when a rect moves into different cells
+  //  - queries visit the cells under the query rect/point (cost depends on local density, not total count)
+  class SpatialIndex
+  {
+  private:
+    struct Entry
+    {
+      Rect2f rect;
+      Vec2i  cell1;  // first cell overlapped
+      Vec2i  cell2;  // last cell overlapped (inclusive)
+      unsigned long stamp = 0; // (last query that returned this entry -- no duplicates)
+    };
+    float mCellSize = SPATIAL_CELL_SIZE;
+    mutable std::unordered_map<int, Entry> mEntries;
+    std::unordered_map<uint64_t, std::vector<int>> mCells;
+    mutable unsigned long mStamp = 0;
+
+    Vec2i cellOf(const Vec2f &p) const;
+    static uint64_t cellKey(int x, int y) { return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y; }
+    void addCells(int id, const Entry &e);
+    void removeCells(int id, const Entry &e);
+
+  public:
+    SpatialIndex(float cellSize=SPATIAL_CELL_SIZE) : mCellSize(cellSize) { }
+
+    void clear();
+    void insert(int id, const Rect2f &rect); // (replaces existing rect)
+    void remove(int id);
+    bool update(int id, const Rect2f &rect); // returns false if id not indexed
+    bool contains(int id) const { return (mEntries.count(id) > 0); }
+    int  size() const           { return mEntries.size(); }
+    const Rect2f* getRect(int id) const;
+
+    // appends ids of rects intersecting rect (each id once)
+    void query(const Rect2f &rect, std::vector<int> &ids) const;
+    // appends ids of rects containing point
+    void queryPoint(const Vec2f &p, std::vector<int> &ids) const;
+  };
+}
+
+#endif // SPATIAL_INDEX_HPP
@@ -0,0 +1,87 @@
+#ifndef SYNASTRY_MATRIX_HPP
+#define SYNASTRY_MATRIX_HPP
+
+#include <array>
+#include <vector>
+
+#include "astro.hpp"
+#include "chart.hpp"
+#include "aspectSweep.hpp"
+
+namespace astro
+{
+  class EphemerisPool;
+
+  // summary of aspects between two charts
+  struct SynastryScore
+  {
+    int    count    = 0;   // number of aspects
+    double strength = 0.0; // sum of aspect strengths
+    std::array<int,    ASPECT_COUNT> aspCount;
+    std::array<double, ASPECT_COUNT> aspStrength;
+
+    SynastryScore() { aspCount.fill(0); aspStrength.fill(0.0); }
+    void add(const ChartAspect &asp);
+
+    // strength of flowing aspects (trine, sextile, semisextile, novile)
+    double harmony() const;
+    // strength of challenging aspects (opposition, square, quincunx, sesquiquadrate, octile)
+    double tension() const;
+    // harmony - tension, normalized to [-1, 1] (0 --> balanced/none)
+    double balance() const
+    {
+      double h = harmony(), t = tension();
+      return ((h + t) > 0.0 ? (h - t)/(h + t) : 0.0);
+    }
+  };
+
+  // Aspects between every ordered pair of K charts (K x K matrix).
+  //  - cell (outer, inner) has aspects between every outer x inner object pair, including same-object contacts (Sun-Sun, ...)
+  //    (so (inner, outer) mirrors it -- diagonal left empty)
+  //  - cells are stored in one preallocated array -- aspect vectors keep their capacity between updates
+  //  - update only recalculates cells where either chart's version (or the params) changed
+  //  - rows are distributed over pool threads (each row has its own sweep/scratch -- no shared writes)
+  class SynastryMatrix
+  {
+  private:
+    struct Cell
+    {
+      bool          valid    = false;
+      unsigned long version1 = 0; // (outer/inner chart versions this cell was calculated for)
+      unsigned long version2 = 0;
+      std::vector<ChartAspect> aspects;
+      SynastryScore score;
+    };
+    std::vector<Chart*>      mCharts;
+    std::vector<Cell>        mCells;   // (row-major -- outer*K + inner)
+    std::vector<AspectSweep> mSweeps;  // (one per row)
+    std::vector<std::vector<AspectPoint>> mPoints; // visible object points per chart (built once per update)
+    ChartParams mParams;
+    bool        mParamsValid = false;
+    unsigned long mVersion   = 0; // changes when any cell changes
+
+    Cell&       cell(int outer, int inner)       { return mCells[outer*mCharts.size() + inner]; }
+    const Cell& cell(int outer, int inner) const { return mCells[outer*mCharts.size() + inner]; }
+    void calcRow(int outer);
+
+  public:
+    SynastryMatrix() = default;
+
+    // sets chart list (cells of charts that kept their index are kept if the pointer is the same)
+    void setCharts(const std::vector<Chart*> &charts);
+    const std::vector<Chart*>& charts() const { return mCharts; }
+    int size() const           { return mCharts.size(); }
+    Chart* chart(int i) const  { return mCharts[i]; }
+    int indexOf(const Chart *chart) const; // (-1 if not in matrix)
+
+    // recalculates changed cells (returns number of cells recalculated)
+    int update(const ChartParams &params, EphemerisPool *pool=nullptr);
+    unsigned long version() const { return mVersion; }
+
+    // aspects between outer/inner chart objects (obj1 --> outer chart, obj2 --> inner chart)
+    const std::vector<ChartAspect>& aspects(int outer, int inner) const { return cell(outer, inner).aspects; }
+    const SynastryScore&            score(int outer, int inner) const   { return cell(outer, inner).score; }
+  };
+}
+
+#endif // SYNASTRY_MATRIX_HPP
@@ -61,6 +61,7 @@ namespace astro
     TimeNode();
     TimeNode(const DateTime &dt);
     virtual std::string type() const { return "TimeNode"; }
+    virtual bool isLive() const override { return mLiveMode; }
     virtual bool copyTo(Node *other) override
     { // copy settings
       if(Node::copyTo(other))
@@ -159,6 +160,7 @@ namespace astro
     TimeSpanNode();
     TimeSpanNode(const DateTime &dtStart, const DateTime &dtEnd);
     virtual std::string type() const { return "TimeSpanNode"; }
+    virtual bool isLive() const override { return mPlay; }
     virtual bool copyTo(Node *other) override
     { // copy settings
       if(Node::copyTo(other))
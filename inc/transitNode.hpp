@@ -0,0 +1,131 @@
+#ifndef TRANSIT_NODE_HPP
+#define TRANSIT_NODE_HPP
+
+#include <chrono>
+
+#include "astro.hpp"
+#include "chart.hpp"
+#include "transitSearch.hpp"
+#include "backgroundJob.hpp"
+#include "node.hpp"
+
+namespace astro
+{
+  //// node connector indices ////
+  // inputs
+#define TRANSITNODE_INPUT_CHART     0
+#define TRANSITNODE_INPUT_STARTDATE 1
+#define TRANSITNODE_INPUT_ENDDATE   2
+  // outputs
+  ////////////////////////////////
+
+#define TRANSITNODE_PATH_BUFLEN 512
+#define TRANSITNODE_NOW_REFRESH 60.0 // seconds between re-resolving start date when not connected (now)
+#define TRANSITNODE_DEFAULT_PATH "./transits.csv"
+
+  class TransitNode : public Node
+  {
+  private:
+    static std::vector<ConnectorBase*> CONNECTOR_INPUTS()
+    { return {new Connector<Chart>("Natal Chart"), new Connector<DateTime>("Start Date (default: now)"), new Connector<DateTime>("End Date")}; }
+    static std::vector<ConnectorBase*> CONNECTOR_OUTPUTS()
+    { return {}; }
+
+    // search inputs (natal chart snapshot -- searched on a background thread)
+    struct SearchRequest
+    {
+      ChartSnapshot natal;
+      ChartParams   params;
+      double        jdStart = 0.0;
+      double        jdEnd   = 0.0;
+    };
+    // search results, with inputs of the search (list marked outdated if changed)
+    struct SearchResult
+    {
+      std::vector<TransitHit> hits;
+      DateTime    natalDate;
+      Location    natalLocation;
+      double      jdStart = 0.0;
+      double      jdEnd   = 0.0;
+      std::string status;
+    };
+    
+    // resolved search range (keyed on date inputs -- see getRange)
+    struct RangeCache
+    {
+      bool          valid        = false;
+      DateTime     *startIn      = nullptr;
+      DateTime     *endIn        = nullptr;
+      unsigned long startVersion = 0;
+      unsigned long endVersion   = 0;
+      int           days         = 0;
+      std::chrono::steady_clock::time_point resolved;
+      double        jdStart = 0.0;
+      double        jdEnd   = 0.0;
+    };
+    
+    ChartParams   mParams;
+    RangeCache    mRange;
+    int  mDays     = 365;  // search span if end date not connected
+    bool mListOpen = true;
+    bool mAspOpen  = false;
+    char mExportPath[TRANSITNODE_PATH_BUFLEN] = TRANSITNODE_DEFAULT_PATH;
+    std::string mStatus; // (overrides result status -- cleared by new search)
+
+    // search job state (job thread only)
+    Chart         mNatal;
+    TransitSearch mSearch;
+    BackgroundJob<SearchRequest, SearchResult> mJob; // (declared last -- joined before the members it uses are destroyed)
+
+    bool getRange(Chart *natal, double &jdStart, double &jdEnd);
+    void search(Chart *natal);
+    void runSearch(const SearchRequest &request, SearchResult &result);
+    bool exportCsv(Chart *natal, const std::vector<TransitHit> &hits, const std::string &path);
+
+    virtual void onUpdate() override;
+    virtual void onDraw() override;
+
+    virtual std::map<std::string, std::string>& getSaveParams(std::map<std::string, std::string> &params) const override
+    {
+      std::string visStr;
+      for(int a = 0; a < ASPECT_COUNT; a++) { visStr.append(mParams.aspVisible[a] ? "1" : "0"); }
+      params.emplace("aspVisible", visStr);
+      params.emplace("days",       std::to_string(mDays));
+      params.emplace("exportPath", mExportPath);
+      params.emplace("listOpen",   (mListOpen ? "1" : "0"));
+      return params;
+    };
+
+    virtual std::map<std::string, std::string>& setSaveParams(std::map<std::string, std::string> &params) override
+    {
+      auto iter = params.find("aspVisible");
+      if(iter != params.end())
+        {
+          for(int a = 0; a < ASPECT_COUNT && a < iter->second.size(); a++)
+            { mParams.aspVisible[a] = (iter->second[a] != '0'); }
+        }
+      iter = params.find("days");       if(iter != params.end()) { std::stringstream ss(iter->second); ss >> mDays; }
+      iter = params.find("exportPath"); if(iter != params.end()) { snprintf(mExportPath, TRANSITNODE_PATH_BUFLEN, "%s", iter->second.c_str()); }
+      iter = params.find("listOpen");   if(iter != params.end()) { mListOpen = (iter->second != "0"); }
+      return params;
+    };
+
+  public:
+    TransitNode();
+    virtual std::string type() const { return "TransitNode"; }
+    virtual bool copyTo(Node *other) override
+    { // copy settings
+      if(Node::copyTo(other))
+        {
+          ((TransitNode*)other)->mParams   = mParams;
+          ((TransitNode*)other)->mDays     = mDays;
+          ((TransitNode*)other)->mListOpen = mListOpen;
+          snprintf(((TransitNode*)other)->mExportPath, TRANSITNODE_PATH_BUFLEN, "%s", mExportPath);
+          return true;
+        }
+      else { return false; }
+    }
+  };
+}
+
+#endif // TRANSIT_NODE_HPP
@@ -0,0 +1,56 @@
+#ifndef TRANSIT_SEARCH_HPP
+#define TRANSIT_SEARCH_HPP
+
+#include <array>
+#include <vector>
+
+#include "astro.hpp"
+#include "chart.hpp"
+#include "eventSearch.hpp"
+
+#define TRANSIT_MAX_PASSES 5 // exact passes stored per hit (direct pass + retrograde re-passes)
+
+namespace astro
+{
+  // a transiting object within orb of an aspect to a natal point
+  struct TransitHit
+  {
+    ObjType    transit = OBJ_INVALID; // transiting object
+    ObjType    natal   = OBJ_INVALID; // natal object/angle
+    AspectType aspect  = ASPECT_INVALID;
+    double     jdEntry = 0.0;         // enters orb    (julian day ET -- range start if openStart)
+    double     jdExit  = 0.0;         // leaves orb    (julian day ET -- range end if openEnd)
+    std::array<double, TRANSIT_MAX_PASSES> jdExact; // exact passes (julian day ET)
+    int        exactCount = 0;
+    bool       openStart  = false;    // already within orb at start of range
+    bool       openEnd    = false;    // still within orb at end of range
+  };
+
+  // Finds transit aspects to natal points over a date range (with entry, exact, and exit times).
+  //  - each (natal point, aspect) is a set of fixed longitudes for each transiting object (exact, and +/- orb)
+  //  - crossings are found with EventSearch (only targets within reach of each sampled interval are tested)
+  //  - retrograde re-passes within one orb window are stored as additional exact times
+  class TransitSearch
+  {
+  private:
+    struct Target
+    {
+      ObjType    natal;
+      AspectType aspect;
+      int        key;      // (natal point, aspect, side) --> open hit index
+      int        boundary; // -1/+1 --> orb edge, 0 --> exact
+      double     exact;    // exact aspect longitude
+      double     orb;
+    };
+    Ephemeris   mSwe;
+    EventSearch mSearch;
+    std::vector<TransitHit> mHits;
+
+  public:
+    // natal chart should be up to date (transits are geocentric, with the natal chart's zodiac)
+    const std::vector<TransitHit>& search(Chart *natal, const ChartParams &params, double jdStart, double jdEnd, EphemerisPool *pool=nullptr);
+    const std::vector<TransitHit>& hits() const { return mHits; }
+  };
+}
+
+#endif // TRANSIT_SEARCH_HPP
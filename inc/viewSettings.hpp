@@ -8,6 +8,8 @@
 #define MAIN_FONT_HEIGHT 16.0f
 #define TITLE_FONT_HEIGHT 20.0f
 
+#define GRAPH_HISTORY_DEFAULT 256 // undo steps kept by the node graph
+
 struct ImFont;
 
 namespace astro
@@ -23,6 +25,14 @@ namespace astro
 
     // returns whether setting is busy being modified
     bool colorSetting(const std::string &name, const std::string &id, Vec4f *color, bool busy);
+
+    // last applied object settings
+    Setting<float> *mStarMagSetting = nullptr; // (magnitude applied once edit ends)
+    bool  mStarsLoaded     = false;
+    float mStarsMagnitude  = 0.0f;
+    bool  mAsteroidsLoaded = false;
+    void updateObjects(); // loads/clears registry objects when chart settings change
+    void updateEphemeris(); // applies ephemeris settings
     
   public:
     // Global
@@ -41,14 +51,21 @@ namespace astro
     bool  glSpacingEqual   = true;
     Vec2f graphLineSpacing = Vec2f(64.0f, 64.0f);
     float graphLineWidth   = 1.0f;
+    int   graphThreads     = 0;     // workers for updating independent branches (0 --> auto, 1 --> serial)
+    int   graphHistory     = GRAPH_HISTORY_DEFAULT; // max undo steps (0 --> no undo)
     
     // Nodes
     Vec4f nodeBgColor      = Vec4f(0.20f, 0.20f, 0.20f,  1.0f);
     bool  mState           = false; // whether window is open
 
+    // Charts (extended object list -- see ObjectRegistry)
+    bool  showStars        = false;
+    float starMagnitude    = 2.0f;  // brightest stars only (lower magnitude --> brighter)
+    bool  showAsteroids    = false;
+    // Ephemeris
+    bool  mmapEphemeris    = false; // read ephemeris files through memory mappings (see EphemerisFiles)
     // TODO: Charts
     // --> aspect colors
-    // --> extended object list
     
     ViewSettings();
     ~ViewSettings();
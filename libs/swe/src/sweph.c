@@ -190,7 +190,13 @@ static int32 swecalc(double tjd, int ipl, int32 iflag, double *x, char *serr);
 static int do_fread(void *targ, int size, int count, int corrsize, 
 		    FILE *fp, int32 fpos, int freord, int fendian, int ifno, 
 		    char *serr);
+static int do_mread(void *targ, int size, int count, int corrsize, 
+		    struct file_data *fdp, int32 *mpos, int32 fpos, int freord, int fendian, int ifno, 
+		    char *serr);
 static int get_new_segment(double tjd, int ipli, int ifno, char *serr);
+
+typedef const unsigned char *(*swi_fmap_func_t)(const char *fname, size_t *size);
+static swi_fmap_func_t swi_get_fmap_func(void);
 static int main_planet(double tjd, int ipli, int32 epheflag, int32 iflag,
 		       char *serr);
 static int main_planet_bary(double tjd, int ipli, int32 epheflag, int32 iflag, 
@@ -2231,6 +2237,11 @@ again:
     }
     /* during the search error messages may have been built, delete them */
     if (serr != NULL) *serr = '\0';	
+    {
+      swi_fmap_func_t fmap_func = swi_get_fmap_func();
+      fdp->msize = 0;
+      fdp->mdata = (fmap_func != NULL ? fmap_func(fdp->fnam, &fdp->msize) : NULL);
+    }
     retc = read_const(ifno, serr);
     if (retc != OK)
       return(retc);
@@ -2339,6 +2350,52 @@ again:
   return(OK);
 }
 
+/* optional replacement for fopen() (e.g. memory-mapped files)
+ * process-wide (not thread-local) -- may be changed while other threads calculate
+ * (atomic pointer; files already open keep their stream until swe reopens them) */
+typedef FILE *(*swi_fopen_func_t)(const char *fname, const char *mode);
+static swi_fopen_func_t swi_fopen_func = NULL;
+
+void CALL_CONV swe_set_fopen_func(FILE *(*func)(const char *fname, const char *mode))
+{
+#if defined(__GNUC__)
+  __atomic_store_n(&swi_fopen_func, func, __ATOMIC_RELEASE);
+#else
+  swi_fopen_func = func; /* (set before starting other threads) */
+#endif
+}
+
+static swi_fopen_func_t swi_get_fopen_func(void)
+{
+#if defined(__GNUC__)
+  return __atomic_load_n(&swi_fopen_func, __ATOMIC_ACQUIRE);
+#else
+  return swi_fopen_func;
+#endif
+}
+
+/* optional mapping of ephemeris files (segment coefficients read from memory instead of fseek/fread)
+ * (same threading rules as swe_set_fopen_func) */
+static swi_fmap_func_t swi_fmap_func = NULL;
+
+void CALL_CONV swe_set_fmap_func(const unsigned char *(*func)(const char *fname, size_t *size))
+{
+#if defined(__GNUC__)
+  __atomic_store_n(&swi_fmap_func, func, __ATOMIC_RELEASE);
+#else
+  swi_fmap_func = func;
+#endif
+}
+
+static swi_fmap_func_t swi_get_fmap_func(void)
+{
+#if defined(__GNUC__)
+  return __atomic_load_n(&swi_fmap_func, __ATOMIC_ACQUIRE);
+#else
+  return swi_fmap_func;
+#endif
+}
+
 /*
  * Alois 2.12.98: inserted error message generation for file not found 
  */
@@ -2346,6 +2403,7 @@ FILE *swi_fopen(int ifno, char *fname, char *ephepath, char *serr)
 {
   int np, i, j;
   FILE *fp = NULL;
+  swi_fopen_func_t fopen_func = swi_get_fopen_func();
   char *fnamp, fn[AS_MAXCH];
   char *cpos[20];
   char s[2 * AS_MAXCH];
@@ -2375,7 +2433,10 @@ FILE *swi_fopen(int ifno, char *fname, char *ephepath, char *serr)
       return NULL;
     }
     strcpy(fnamp, s);
-    fp = fopen(fnamp, BFILE_R_ACCESS);
+    if (fopen_func != NULL)
+      fp = fopen_func(fnamp, BFILE_R_ACCESS);
+    else
+      fp = fopen(fnamp, BFILE_R_ACCESS);
     if (fp != NULL) 
       return fp;
   }
@@ -4343,6 +4404,7 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
   int i, j, k, m, n, o, icoord, retc;
   int32 iseg;
   int32 fpos;
+  int32 mpos = 0;	/* read position in mapped file (see do_mread) */
   int nsizes, nsize[6];
   int nco;
   int idbl;
@@ -4361,10 +4423,13 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
   pdp->tseg1 = pdp->tseg0 + pdp->dseg;
   /* get file position of coefficients from file */
   fpos = pdp->lndx0 + iseg * 3;
-  retc = do_fread((void *) &fpos, 3, 1, 4, fp, fpos, freord, fendian, ifno, serr);
+  retc = do_mread((void *) &fpos, 3, 1, 4, fdp, &mpos, fpos, freord, fendian, ifno, serr);
   if (retc != OK)
     goto return_error_gns;
-  fseek(fp, fpos, SEEK_SET);
+  if (fdp->mdata == NULL)
+    fseek(fp, fpos, SEEK_SET);
+  else
+    mpos = fpos;
   /* clear space of chebyshew coefficients */
   if (pdp->segp == NULL)
     pdp->segp = (double *) malloc((size_t) pdp->ncoe * 3 * 8);
@@ -4374,12 +4439,12 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
     idbl = icoord * pdp->ncoe;
     /* first read header */
     /* first bit indicates number of sizes of packed coefficients */
-    retc = do_fread((void *) &c[0], 1, 2, 1, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+    retc = do_mread((void *) &c[0], 1, 2, 1, fdp, &mpos, SEI_CURR_FPOS, freord, fendian, ifno, serr);
     if (retc != OK)
       goto return_error_gns;
     if (c[0] & 128) {
       nsizes = 6;
-      retc = do_fread((void *) (c+2), 1, 2, 1, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+      retc = do_mread((void *) (c+2), 1, 2, 1, fdp, &mpos, SEI_CURR_FPOS, freord, fendian, ifno, serr);
       if (retc != OK)
 	goto return_error_gns;
       nsize[0] = (int) c[1] / 16;
@@ -4417,7 +4482,7 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       if (i < 4) {
 	j = (4 - i);
 	k = nsize[i];
-	retc = do_fread((void *) &longs[0], j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_mread((void *) &longs[0], j, k, 4, fdp, &mpos, SEI_CURR_FPOS, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
 	for (m = 0; m < k; m++, idbl++) {
@@ -4429,7 +4494,7 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       } else if (i == 4) {		/* half byte packing */
 	j = 1;
 	k = (nsize[i] + 1) / 2;
-	retc = do_fread((void *) longs, j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_mread((void *) longs, j, k, 4, fdp, &mpos, SEI_CURR_FPOS, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
 	for (m = 0, j = 0; 
@@ -4448,7 +4513,7 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       } else if (i == 5) {		/* quarter byte packing */
 	j = 1;
 	k = (nsize[i] + 3) / 4;
-	retc = do_fread((void *) longs, j, k, 4, fp, SEI_CURR_FPOS, freord, fendian, ifno, serr);
+	retc = do_mread((void *) longs, j, k, 4, fdp, &mpos, SEI_CURR_FPOS, freord, fendian, ifno, serr);
 	if (retc != OK)
 	  goto return_error_gns;
 	for (m = 0, j = 0; 
@@ -4885,9 +4950,29 @@ return_error:
  * ifno		file number
  * serr		error string
  */
+static void do_reorder(unsigned char *targ, const unsigned char *space, int size, int count, int corrsize, int freord, int fendian)
+{
+  int i, j, k;
+  if (size != corrsize) {
+    memset((void *) targ, 0, (size_t) count * corrsize);
+  }
+  for(i = 0; i < count; i++) {
+    for (j = size-1; j >= 0; j--) {
+      if (freord) 
+	k = size-j-1;
+      else 
+	k = j;
+      if (size != corrsize) 
+	if ((fendian == SEI_FILE_BIGENDIAN && !freord) ||
+	    (fendian == SEI_FILE_LITENDIAN &&  freord))
+	  k += corrsize - size;
+      targ[i*corrsize+k] = space[i*size+j];
+    }
+  }
+}
+
 static int do_fread(void *trg, int size, int count, int corrsize, FILE *fp, int32 fpos, int freord, int fendian, int ifno, char *serr)
 {
-  int i, j, k; 
   int totsize;
   unsigned char space[1000];
   unsigned char *targ = (unsigned char *) trg;
@@ -4916,23 +5001,38 @@ static int do_fread(void *trg, int size, int count, int corrsize, FILE *fp, int3
       }
       return(ERR);
     }
-    if (size != corrsize) {
-      memset((void *) targ, 0, (size_t) count * corrsize);
-    }
-    for(i = 0; i < count; i++) {
-      for (j = size-1; j >= 0; j--) {
-	if (freord) 
-	  k = size-j-1;
-        else 
-	  k = j;
-        if (size != corrsize) 
-          if ((fendian == SEI_FILE_BIGENDIAN && !freord) ||
-              (fendian == SEI_FILE_LITENDIAN &&  freord))
-	    k += corrsize - size;
-        targ[i*corrsize+k] = space[i*size+j];
+    do_reorder(targ, space, size, count, corrsize, freord, fendian);
+  }
+  return(OK);
+}
+
+/* like do_fread(), but reads from the file's mapped contents if it has any
+ * (fdp->mdata -- no stdio; *mpos is the read position, set to fpos if fpos >= 0) */
+static int do_mread(void *trg, int size, int count, int corrsize, struct file_data *fdp, int32 *mpos, int32 fpos, int freord, int fendian, int ifno, char *serr)
+{
+  int totsize;
+  const unsigned char *src;
+  unsigned char *targ = (unsigned char *) trg;
+  if (fdp->mdata == NULL)
+    return do_fread(trg, size, count, corrsize, fdp->fptr, fpos, freord, fendian, ifno, serr);
+  totsize = size * count;
+  if (fpos >= 0)
+    *mpos = fpos;
+  if (*mpos < 0 || (size_t) *mpos + (size_t) totsize > fdp->msize) {
+    if (serr != NULL) {
+      strcpy(serr, "Ephemeris file is damaged (5). ");
+      if (strlen(serr) + strlen(fdp->fnam) < AS_MAXCH - 1) {
+	sprintf(serr, "Ephemeris file %s is damaged (6).", fdp->fnam);
       }
     }
+    return(ERR);
   }
+  src = fdp->mdata + *mpos;
+  *mpos += totsize;
+  if (!freord && size == corrsize)
+    memcpy((void *) targ, (const void *) src, (size_t) totsize);
+  else
+    do_reorder(targ, src, size, count, corrsize, freord, fendian);
   return(OK);
 }
 
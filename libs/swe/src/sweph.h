@@ -715,6 +715,8 @@ struct file_data {
   int32 sweph_denum;     /* DE number of JPL ephemeris, which this file
 			 * is derived from. */
   FILE *fptr;		/* ephemeris file pointer */
+  const unsigned char *mdata; /* mapped file contents, if any (segments read from here -- see swe_set_fmap_func) */
+  size_t msize;		/* size of mapped contents */
   double tfstart;       /* file may be used from this date */
   double tfend;         /*      through this date          */
   int32 iflg; 		/* byte reorder flag and little/bigendian flag */
@@ -729,6 +729,12 @@ ext_def( void ) swe_close(void);
 /* set directory path of ephemeris files */
 ext_def( void ) swe_set_ephe_path(char *path);
 
+/* replaces fopen() for ephemeris files (NULL --> fopen) */
+ext_def( void ) swe_set_fopen_func(FILE *(*func)(const char *fname, const char *mode));
+
+/* returns mapped contents of ephemeris files (NULL --> coefficients read through file pointer) */
+ext_def( void ) swe_set_fmap_func(const unsigned char *(*func)(const char *fname, size_t *size));
+
 /* set file name of JPL file */
 ext_def( void ) swe_set_jpl_file(char *fname);
 
@@ -204,6 +204,9 @@ int main(int argc, char* argv[])
       { GLFW_MOD_CONTROL, GLFW_KEY_C, [](){ graph->copy(); } },                         // CTRL+C       --> copy
       { GLFW_MOD_CONTROL, GLFW_KEY_V, [](){ graph->paste(); } },                        // CTRL+V       --> paste
       { GLFW_MOD_CONTROL, GLFW_KEY_A, [](){ graph->selectAll(); } },                    // CTRL+A       --> select all
+      { GLFW_MOD_CONTROL, GLFW_KEY_Z, [](){ if(!ImGui::GetIO().WantTextInput) { graph->undo(); } } },                // CTRL+Z       --> undo
+      { GLFW_MOD_CONTROL, GLFW_KEY_Y, [](){ if(!ImGui::GetIO().WantTextInput) { graph->redo(); } } },                // CTRL+Y       --> redo
+      { GLFW_MOD_CONTROL|GLFW_MOD_SHIFT, GLFW_KEY_Z, [](){ if(!ImGui::GetIO().WantTextInput) { graph->redo(); } } }, // CTRL+SHIFT+Z --> redo
       // //// Node Creation
       // { 0, GLFW_KEY_T, [](){ graph->addNode("TimeNode",         true); } }, // T --> new Time Node
       // { 0, GLFW_KEY_S, [](){ graph->addNode("TimeSpanNode",     true); } }, // S --> new Time Span Node
@@ -272,6 +275,9 @@ int main(int argc, char* argv[])
             }
           if(ImGui::BeginMenu("Edit"))
             {
+              if(ImGui::MenuItem("Undo", "Ctrl+Z", false, graph->canUndo())) { graph->undo(); }
+              if(ImGui::MenuItem("Redo", "Ctrl+Y", false, graph->canRedo())) { graph->redo(); }
+              ImGui::Separator();
               if(ImGui::MenuItem("Cut"))   { graph->cut(); }
               if(ImGui::MenuItem("Copy"))  { graph->copy(); }
               if(ImGui::MenuItem("Paste")) { graph->paste(); }
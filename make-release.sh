@@ -2,4 +2,4 @@
 mkdir -p build && cd build &&
     cmake -DCMAKE_BUILD_TYPE=Release .. &&
     make -j12 &&
-    cp astrolograph ..
+    cp astrolograph astrolograph-headless ..
@@ -0,0 +1,229 @@
+#include "angleBatch.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ANGLE_BATCH_X86 1
+#include <immintrin.h>
+#define ANGLE_TARGET_SSE2 __attribute__((target("sse2")))
+#define ANGLE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+//// ISA SELECTION ////
+static AngleIsa detectAngleIsa()
+{
+#ifdef ANGLE_BATCH_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) { return ANGLE_ISA_AVX2; }
+  if(__builtin_cpu_supports("sse2")) { return ANGLE_ISA_SSE2; }
+#endif
+  return ANGLE_ISA_SCALAR;
+}
+static AngleIsa bestAngleIsa()
+{
+  static AngleIsa isa = detectAngleIsa();
+  return isa;
+}
+static AngleIsa& currentAngleIsa()
+{
+  static AngleIsa isa = bestAngleIsa();
+  return isa;
+}
+
+AngleIsa astro::getAngleIsa()         { return currentAngleIsa(); }
+void astro::setAngleIsa(AngleIsa isa) { currentAngleIsa() = std::min(isa, bestAngleIsa()); }
+
+
+//// SCALAR ////
+static inline int signScalar(double longitude)
+{ return (int)std::floor(fmod(longitude, 360.0)/30.0); } // (same as Chart::getSign)
+
+static void angleDiffScalar(const double *a1, const double *a2, double *out, int n)
+{ for(int i = 0; i < n; i++) { out[i] = angleDiffDegrees(a1[i], a2[i]); } }
+static void angleDiffScalar(const double *a1, double a2, double *out, int n)
+{ for(int i = 0; i < n; i++) { out[i] = angleDiffDegrees(a1[i], a2); } }
+static void signsScalar(const double *lon, int *out, int n)
+{ for(int i = 0; i < n; i++) { out[i] = signScalar(lon[i]); } }
+
+
+#ifdef ANGLE_BATCH_X86
+//// SSE2 ////
+// 180 - |(|a2 - a1|) - 180|  (same operation order as angleDiffDegrees)
+ANGLE_TARGET_SSE2 static inline __m128d angleDiffSse2(__m128d a1, __m128d a2)
+{
+  const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m128d c180    = _mm_set1_pd(180.0);
+  __m128d d = _mm_and_pd(_mm_sub_pd(a2, a1), absMask);
+  d = _mm_and_pd(_mm_sub_pd(d, c180), absMask);
+  return _mm_sub_pd(c180, d);
+}
+ANGLE_TARGET_SSE2 static void angleDiffSse2(const double *a1, const double *a2, double *out, int n)
+{
+  int i = 0;
+  for(; i+2 <= n; i += 2) { _mm_storeu_pd(out+i, angleDiffSse2(_mm_loadu_pd(a1+i), _mm_loadu_pd(a2+i))); }
+  angleDiffScalar(a1+i, a2+i, out+i, n-i);
+}
+ANGLE_TARGET_SSE2 static void angleDiffSse2(const double *a1, double a2, double *out, int n)
+{
+  int i = 0;
+  __m128d v2 = _mm_set1_pd(a2);
+  for(; i+2 <= n; i += 2) { _mm_storeu_pd(out+i, angleDiffSse2(_mm_loadu_pd(a1+i), v2)); }
+  angleDiffScalar(a1+i, a2, out+i, n-i);
+}
+// fmod(x, 360) is exact for |x| < 720 (x, or x -/+ 360) -- other lanes (and NaN) use scalar path
+ANGLE_TARGET_SSE2 static void signsSse2(const double *lon, int *out, int n)
+{
+  const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m128d c360 = _mm_set1_pd(360.0);
+  const __m128d c720 = _mm_set1_pd(720.0);
+  const __m128d c30  = _mm_set1_pd(30.0);
+  const __m128d one  = _mm_set1_pd(1.0);
+  int i = 0;
+  for(; i+2 <= n; i += 2)
+    {
+      __m128d x  = _mm_loadu_pd(lon+i);
+      __m128d ax = _mm_and_pd(x, absMask);
+      if(_mm_movemask_pd(_mm_cmplt_pd(ax, c720)) != 0x3) { signsScalar(lon+i, out+i, 2); continue; }
+      __m128d wrap = _mm_or_pd(c360, _mm_andnot_pd(absMask, x)); // (copysign(360, x))
+      __m128d r  = _mm_sub_pd(x, _mm_and_pd(_mm_cmpge_pd(ax, c360), wrap));
+      __m128d q  = _mm_div_pd(r, c30);
+      __m128d t  = _mm_cvtepi32_pd(_mm_cvttpd_epi32(q));
+      __m128d f  = _mm_sub_pd(t, _mm_and_pd(_mm_cmplt_pd(q, t), one)); // floor
+      __m128i fi = _mm_cvttpd_epi32(f);
+      _mm_storel_epi64((__m128i*)(out+i), fi);
+    }
+  signsScalar(lon+i, out+i, n-i);
+}
+
+//// AVX2 ////
+ANGLE_TARGET_AVX2 static inline __m256d angleDiffAvx2(__m256d a1, __m256d a2)
+{
+  const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m256d c180    = _mm256_set1_pd(180.0);
+  __m256d d = _mm256_and_pd(_mm256_sub_pd(a2, a1), absMask);
+  d = _mm256_and_pd(_mm256_sub_pd(d, c180), absMask);
+  return _mm256_sub_pd(c180, d);
+}
+ANGLE_TARGET_AVX2 static void angleDiffAvx2(const double *a1, const double *a2, double *out, int n)
+{
+  int i = 0;
+  for(; i+4 <= n; i += 4) { _mm256_storeu_pd(out+i, angleDiffAvx2(_mm256_loadu_pd(a1+i), _mm256_loadu_pd(a2+i))); }
+  angleDiffScalar(a1+i, a2+i, out+i, n-i);
+}
+ANGLE_TARGET_AVX2 static void angleDiffAvx2(const double *a1, double a2, double *out, int n)
+{
+  int i = 0;
+  __m256d v2 = _mm256_set1_pd(a2);
+  for(; i+4 <= n; i += 4) { _mm256_storeu_pd(out+i, angleDiffAvx2(_mm256_loadu_pd(a1+i), v2)); }
+  angleDiffScalar(a1+i, a2, out+i, n-i);
+}
+ANGLE_TARGET_AVX2 static void signsAvx2(const double *lon, int *out, int n)
+{
+  const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m256d c360 = _mm256_set1_pd(360.0);
+  const __m256d c720 = _mm256_set1_pd(720.0);
+  const __m256d c30  = _mm256_set1_pd(30.0);
+  int i = 0;
+  for(; i+4 <= n; i += 4)
+    {
+      __m256d x  = _mm256_loadu_pd(lon+i);
+      __m256d ax = _mm256_and_pd(x, absMask);
+      if(_mm256_movemask_pd(_mm256_cmp_pd(ax, c720, _CMP_LT_OQ)) != 0xF) { signsScalar(lon+i, out+i, 4); continue; }
+      __m256d wrap = _mm256_or_pd(c360, _mm256_andnot_pd(absMask, x)); // (copysign(360, x))
+      __m256d r = _mm256_sub_pd(x, _mm256_and_pd(_mm256_cmp_pd(ax, c360, _CMP_GE_OQ), wrap));
+      __m256d f = _mm256_floor_pd(_mm256_div_pd(r, c30));
+      _mm_storeu_si128((__m128i*)(out+i), _mm256_cvttpd_epi32(f));
+    }
+  signsScalar(lon+i, out+i, n-i);
+}
+#endif // ANGLE_BATCH_X86
+
+
+//// DISPATCH ////
+void astro::angleDiffDegrees(const double *angles1, const double *angles2, double *out, int n)
+{
+  switch(currentAngleIsa())
+    {
+#ifdef ANGLE_BATCH_X86
+    case ANGLE_ISA_AVX2: angleDiffAvx2(angles1, angles2, out, n); break;
+    case ANGLE_ISA_SSE2: angleDiffSse2(angles1, angles2, out, n); break;
+#endif
+    default:             angleDiffScalar(angles1, angles2, out, n); break;
+    }
+}
+
+void astro::angleDiffDegrees(const double *angles, double angle, double *out, int n)
+{
+  switch(currentAngleIsa())
+    {
+#ifdef ANGLE_BATCH_X86
+    case ANGLE_ISA_AVX2: angleDiffAvx2(angles, angle, out, n); break;
+    case ANGLE_ISA_SSE2: angleDiffSse2(angles, angle, out, n); break;
+#endif
+    default:             angleDiffScalar(angles, angle, out, n); break;
+    }
+}
+
+void astro::getSigns(const double *longitudes, int *out, int n)
+{
+  switch(currentAngleIsa())
+    {
+#ifdef ANGLE_BATCH_X86
+    case ANGLE_ISA_AVX2: signsAvx2(longitudes, out, n); break;
+    case ANGLE_ISA_SSE2: signsSse2(longitudes, out, n); break;
+#endif
+    default:             signsScalar(longitudes, out, n); break;
+    }
+}
+
+
+//// HOUSE SEARCH ////
+void HouseSearch::setCusps(const std::array<double, 12> &cusps)
+{
+  mCusps = cusps;
+  // cusps should increase around the circle (only one descent, where they wrap past 360)
+  int descents = 0;
+  int start    = 0;
+  bool inRange = true;
+  for(int i = 0; i < 12; i++)
+    {
+      inRange &= (cusps[i] >= 0.0 && cusps[i] < 360.0); // (false for NaN)
+      if(cusps[i] < cusps[(i+11) % 12]) { descents++; start = i; }
+    }
+  mOrdered = (inRange && descents <= 1);
+  for(int i = 0; i < 12; i++)
+    {
+      int h = (start + i) % 12;
+      mSorted[i] = cusps[h];
+      mHouses[i] = h + 1;
+    }
+}
+
+int HouseSearch::scan(double longitude) const
+{
+  for(int i = 1; i <= 12; i++)
+    {
+      if(anglesContainDegrees(mCusps[i-1], mCusps[i % 12], longitude)) { return i; }
+    }
+  return -1;
+}
+
+int HouseSearch::getHouse(double longitude) const
+{
+  if(!mOrdered || !(longitude >= 0.0 && longitude < 360.0)) { return scan(longitude); }
+  // branchless binary search --> number of sorted cusps <= longitude
+  int count = 0;
+  for(int step = 8; step > 0; step /= 2)
+    { count += ((count + step <= 12 && mSorted[std::min(count + step, 12) - 1] <= longitude) ? step : 0); }
+  int h = mHouses[count == 0 ? 11 : count-1]; // (before first sorted cusp --> inside wrapping house)
+  // confirm with scalar test (rounding near 0/360 can leave a longitude outside every house)
+  return (anglesContainDegrees(mCusps[h-1], mCusps[h % 12], longitude) ? h : scan(longitude));
+}
+
+void HouseSearch::getHouses(const double *longitudes, int *out, int n) const
+{
+  for(int i = 0; i < n; i++) { out[i] = getHouse(longitudes[i]); }
+}
@@ -16,6 +16,17 @@ AspectNode::AspectNode()
     }
 }
 
+ChartParams AspectNode::listParams(Chart *chart) const
+{
+  const ChartParams *last = chart->aspectParams();
+  ChartParams params = (last ? *last : ChartParams());
+  for(int o = 0; o < OBJ_END; o++)
+    { params.objVisible[o] = params.objVisible[o] && chart->getObject((ObjType)o)->visible; }
+  for(int a = 0; a < ASPECT_COUNT; a++)
+    { params.aspVisible[a] = params.aspVisible[a] && mAspVisible[a] && chart->getAspectVisible((AspectType)a); }
+  return params;
+}
+
 void AspectNode::onUpdate()
 { }
 
@@ -34,16 +45,13 @@ void AspectNode::onDraw()
   if(ImGui::CollapsingHeader("aspectList", nullptr, flags) && chart)
     {
       mListOpen = true;
-      // update aspect visiblity and count visible aspects
+      ChartParams params = listParams(chart);
+      auto listed = [&params](const ChartAspect &asp)
+                    { return (params.aspVisible[asp.type] && asp.visible && params.objVisible[asp.obj1] && params.objVisible[asp.obj2]); };
+      // count visible aspects
       int visibleCount = 0;
       for(int i = 0; i < chart->aspects().size(); i++)
-        {
-          const ChartAspect &asp = chart->aspects()[i];
-          // mAspVisible[asp.type] = chart->getAspectVisible(asp.type);
-          if(mAspVisible[asp.type] && chart->getAspectVisible(asp.type) && asp.visible &&
-             asp.obj1->visible && asp.obj2->visible)
-            { visibleCount++; }
-        }
+        { visibleCount += (listed(chart->aspects()[i]) ? 1 : 0); }
         
       ImGui::Text("Total count: %d (visible: %d)", (int)chart->aspects().size(), visibleCount);
       ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
@@ -57,14 +65,12 @@ void AspectNode::onDraw()
           {
             const ChartAspect &asp = chart->aspects()[i];
             // skip north/south node opposition, and non-visible aspects
-            if((asp.obj1->type == OBJ_NORTHNODE && asp.obj2->type == OBJ_SOUTHNODE) ||
-               (asp.obj2->type == OBJ_NORTHNODE && asp.obj1->type == OBJ_SOUTHNODE) ||
-               !mAspVisible[asp.type] || !chart->getAspectVisible(asp.type) || !asp.visible ||
-               !asp.obj1->visible || !asp.obj2->visible) { continue; }
+            if((asp.obj1 == OBJ_NORTHNODE && asp.obj2 == OBJ_SOUTHNODE) ||
+               (asp.obj2 == OBJ_NORTHNODE && asp.obj1 == OBJ_SOUTHNODE) || !listed(asp)) { continue; }
               
             std::string aName = getAspectName(asp.type);
-            std::string o1Name = getObjName(asp.obj1->type);
-            std::string o2Name = getObjName(asp.obj2->type);
+            std::string o1Name = getObjName(asp.obj1);
+            std::string o2Name = getObjName(asp.obj2);
             Vec4f aColor = getAspectInfo(asp.type)->color;
             Vec4f scaledColor = aColor;
             scaledColor.w *= asp.strength;//*asp.strength; // weight surrounding hexagon color by aspect strength
@@ -89,6 +95,31 @@ void AspectNode::onDraw()
     }
   else if(chart && isBodyVisible())
     { mListOpen = false; }
+
+  // aspect patterns (T-square, grand trine, ...)
+  ImGui::SetNextTreeNodeOpen(mPatternsOpen);
+  if(ImGui::CollapsingHeader("patterns", nullptr, flags) && chart)
+    {
+      mPatternsOpen = true;
+      const std::vector<AspectPattern> &patterns = chart->getPatterns(listParams(chart)); // (same objects/aspects/orbs as aspect list)
+      ImGui::Text("Total count: %d", (int)patterns.size());
+      ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
+      for(const auto &p : patterns)
+        {
+          ImGui::TextUnformatted(getPatternName(p.type).c_str());
+          ImGui::SameLine(128*scale);
+          for(int i = 0; i < p.count; i++)
+            {
+              std::string oName = getObjName(p.objects[i]);
+              ChartImage *img = getWhiteImage(oName);
+              ImGui::SameLine();
+              if(img) { ImGui::Image(img->id(), symSize, Vec2f(0,0), Vec2f(1,1), getObjColor(oName), Vec4f(0,0,0,0)); }
+              else    { ImGui::TextUnformatted(oName.c_str()); }
+            }
+        }
+    }
+  else if(chart && isBodyVisible())
+    { mPatternsOpen = false; }
     
   // aspect settings/orbs
   ImGui::SetNextTreeNodeOpen(mOrbsOpen);
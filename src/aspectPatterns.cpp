@@ -0,0 +1,216 @@
+#include "aspectPatterns.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+#include "angleBatch.hpp"
+
+// mask helpers
+static inline PatternMask bit(int obj)   { return PatternMask(1) << obj; }
+static inline PatternMask above(int obj) { return ~((PatternMask(2) << obj) - 1); } // (objects with index > obj)
+// north/south node are always opposite -- never an edge (skipped by the aspect list too)
+static inline PatternMask nodalPartner(int obj)
+{ return (obj == OBJ_NORTHNODE ? bit(OBJ_SOUTHNODE) : (obj == OBJ_SOUTHNODE ? bit(OBJ_NORTHNODE) : 0)); }
+#define FOR_BITS(var, mask) for(PatternMask _m = (mask); _m; _m &= _m-1) if(int var = __builtin_ctz(_m); true)
+
+
+PatternFinder::PatternFinder()
+{
+  for(auto &iter : ASPECTS)
+    { mAngles[iter.second.type] = iter.second.angle; }
+  for(auto &adj : mAdjacency) { adj.fill(0); }
+}
+
+void PatternFinder::updateEdges(int obj, PatternMask &touched)
+{
+  // retest obj against every other active object
+  std::array<PatternMask, ASPECT_COUNT> rows;
+  rows.fill(0);
+  if(mActive & bit(obj))
+    {
+      std::array<int,    OBJ_END> others;
+      std::array<double, OBJ_END> lons;
+      std::array<double, OBJ_END> diffs;
+      std::array<double, OBJ_END> aDiffs;
+      int n = 0;
+      FOR_BITS(j, mActive & ~bit(obj) & ~nodalPartner(obj)) { others[n] = j; lons[n] = mLon[j]; n++; }
+      angleDiffDegrees(lons.data(), mLon[obj], diffs.data(), n);
+      for(int a = 0; a < ASPECT_COUNT; a++)
+        { // (same test as Chart::calcAspects -- batch helpers are bit-identical)
+          if(!mAspVisible[a]) { continue; }
+          angleDiffDegrees(diffs.data(), mAngles[a], aDiffs.data(), n);
+          for(int i = 0; i < n; i++)
+            {
+              int j = others[i];
+              if(std::abs(aDiffs[i]) <= std::min(mAspOrbs[a], std::min(mObjOrbs[obj], mObjOrbs[j])))
+                { rows[a] |= bit(j); }
+            }
+        }
+    }
+
+  for(int a = 0; a < ASPECT_COUNT; a++)
+    {
+      PatternMask changed = mAdjacency[a][obj] ^ rows[a];
+      if(!changed) { continue; }
+      mAdjacency[a][obj] = rows[a];
+      FOR_BITS(j, changed) { mAdjacency[a][j] ^= bit(obj); } // (symmetric)
+      touched |= changed | bit(obj);
+    }
+}
+
+void PatternFinder::addPattern(PatternType type, PatternMask required, std::initializer_list<int> objects)
+{
+  AspectPattern p;
+  p.type = type;
+  for(int o : objects)
+    {
+      p.objects[p.count++] = (ObjType)o;
+      p.mask |= bit(o);
+    }
+  if(p.mask & required) { mPatterns.push_back(p); }
+}
+
+void PatternFinder::findPatterns(PatternMask required)
+{
+  // replace patterns that include a touched object
+  mPatterns.erase(std::remove_if(mPatterns.begin(), mPatterns.end(),
+                                 [required](const AspectPattern &p) { return (p.mask & required); }), mPatterns.end());
+
+  const Adjacency &OPP = mAdjacency[ASPECT_OPPOSITION];
+  const Adjacency &SQR = mAdjacency[ASPECT_SQUARE];
+  const Adjacency &TRI = mAdjacency[ASPECT_TRINE];
+  const Adjacency &SXT = mAdjacency[ASPECT_SEXTILE];
+  const Adjacency &QNX = mAdjacency[ASPECT_QUINCUNX];
+
+  // apex search over edges -- if neither edge object is required, apex must be
+  auto apexes = [required](PatternMask apex, int a, int b)
+                { return ((required & (bit(a) | bit(b))) ? apex : (apex & required)); };
+
+  std::vector<std::array<int, 3>> trines; // (all grand trines -- used by kite/grand sextile)
+  FOR_BITS(a, mActive)
+    {
+      FOR_BITS(b, OPP[a] & above(a))
+        { // T-square
+          FOR_BITS(c, apexes(SQR[a] & SQR[b], a, b)) { addPattern(PATTERN_TSQUARE, required, {a, b, c}); }
+        }
+      FOR_BITS(b, TRI[a] & above(a))
+        { // grand trine
+          FOR_BITS(c, TRI[a] & TRI[b] & above(b))
+            {
+              trines.push_back({a, b, c});
+              addPattern(PATTERN_GRAND_TRINE, required, {a, b, c});
+            }
+        }
+      FOR_BITS(b, SXT[a] & above(a))
+        { // yod
+          FOR_BITS(c, apexes(QNX[a] & QNX[b], a, b)) { addPattern(PATTERN_YOD, required, {a, b, c}); }
+        }
+      FOR_BITS(b, SQR[a] & above(a))
+        { // grand square/cross (4-cycle of squares, a lowest, b < d)
+          FOR_BITS(d, SQR[a] & above(b))
+            {
+              FOR_BITS(c, SQR[b] & SQR[d] & above(a))
+                {
+                  addPattern(PATTERN_GRAND_SQUARE, required, {a, b, c, d});
+                  if((OPP[a] & bit(c)) && (OPP[b] & bit(d)))
+                    { addPattern(PATTERN_GRAND_CROSS, required, {a, b, c, d}); }
+                }
+            }
+        }
+      FOR_BITS(d, OPP[a] & above(a))
+        { // cradle (0, 60, 120, 180)
+          FOR_BITS(b, SXT[a] & TRI[d])
+            {
+              FOR_BITS(c, SXT[b] & SXT[d] & TRI[a]) { addPattern(PATTERN_CRADLE, required, {a, b, c, d}); }
+            }
+        }
+      FOR_BITS(c, OPP[a])
+        { // mystic rectangle (0, 60, 180, 240) -- a lowest object
+          FOR_BITS(b, SXT[a] & TRI[c] & above(a))
+            {
+              FOR_BITS(d, OPP[b] & SXT[c] & TRI[a])
+                {
+                  if((bit(c) | bit(d)) & ~above(a)) { continue; }
+                  addPattern(PATTERN_MYSTIC_RECTANGLE, required, {a, b, c, d});
+                  // envelope (rectangle + point sextile to one side of it, trine to the other)
+                  FOR_BITS(e, SXT[b] & SXT[c] & TRI[a] & TRI[d]) { addPattern(PATTERN_ENVELOPE, required, {a, b, e, c, d}); }
+                  FOR_BITS(e, SXT[a] & SXT[d] & TRI[b] & TRI[c]) { addPattern(PATTERN_ENVELOPE, required, {c, d, e, a, b}); }
+                }
+            }
+        }
+    }
+
+  for(int t = 0; t < (int)trines.size(); t++)
+    {
+      const auto &t1 = trines[t];
+      PatternMask m1 = bit(t1[0]) | bit(t1[1]) | bit(t1[2]);
+      for(int i = 0; i < 3; i++)
+        { // kite (trine + point opposite one trine object, sextile to the others)
+          int x = t1[i], y = t1[(i+1)%3], z = t1[(i+2)%3];
+          FOR_BITS(d, OPP[x] & SXT[y] & SXT[z]) { addPattern(PATTERN_KITE, required, {x, y, z, d}); }
+        }
+      for(int u = t+1; u < (int)trines.size(); u++)
+        { // grand sextile (two disjoint grand trines, each object sextile to two of the other)
+          const auto &t2 = trines[u];
+          PatternMask m2 = bit(t2[0]) | bit(t2[1]) | bit(t2[2]);
+          if(m1 & m2) { continue; }
+          bool linked = true;
+          for(int i = 0; i < 3 && linked; i++)
+            { linked = (__builtin_popcount(SXT[t1[i]] & m2) == 2 && __builtin_popcount(SXT[t2[i]] & m1) == 2); }
+          if(!linked) { continue; }
+
+          std::array<int, 6> cycle;
+          PatternMask visited = bit(t1[0]);
+          cycle[0] = t1[0];
+          for(int i = 1; i < 6; i++)
+            {
+              cycle[i] = __builtin_ctz(SXT[cycle[i-1]] & (m1 | m2) & ~visited);
+              visited |= bit(cycle[i]);
+            }
+          addPattern(PATTERN_GRAND_SEXTILE, required, {cycle[0], cycle[1], cycle[2], cycle[3], cycle[4], cycle[5]});
+        }
+    }
+
+  std::sort(mPatterns.begin(), mPatterns.end(),
+            [](const AspectPattern &p1, const AspectPattern &p2)
+            {
+              if(p1.type != p2.type) { return (p1.type < p2.type); }
+              return std::lexicographical_compare(p1.objects.begin(), p1.objects.begin()+p1.count,
+                                                  p2.objects.begin(), p2.objects.begin()+p2.count);
+            });
+}
+
+bool PatternFinder::update(const double *longitudes, PatternMask active, const double *objOrbs,
+                           const std::array<bool, ASPECT_COUNT> &aspVisible, const std::array<double, ASPECT_COUNT> &aspOrbs)
+{
+  bool full = (!mValid || aspVisible != mAspVisible || aspOrbs != mAspOrbs ||
+               !std::equal(mObjOrbs.begin(), mObjOrbs.end(), objOrbs));
+
+  PatternMask moved = (full ? active : (active ^ mActive));
+  for(int o = 0; o < OBJ_END; o++)
+    {
+      if((active & bit(o)) && longitudes[o] != mLon[o]) { moved |= bit(o); }
+      mLon[o] = longitudes[o];
+    }
+  if(!moved && !full) { return false; }
+
+  if(full)
+    {
+      std::copy(objOrbs, objOrbs+OBJ_END, mObjOrbs.begin());
+      mAspVisible = aspVisible;
+      mAspOrbs    = aspOrbs;
+      for(auto &adj : mAdjacency) { adj.fill(0); }
+      mPatterns.clear();
+      mValid = true;
+    }
+  mActive = active;
+
+  // retest edges of moved objects
+  PatternMask touched = 0;
+  FOR_BITS(o, moved) { updateEdges(o, touched); }
+  if(!touched && !full) { return false; }
+
+  findPatterns(full ? ~PatternMask(0) : touched);
+  return true;
+}
@@ -0,0 +1,104 @@
+#include "aspectSweep.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+#include "angleBatch.hpp"
+
+
+AspectSweep::AspectSweep()
+{
+  int rank = 0;
+  for(auto &iter : ASPECTS)
+    {
+      mAngles[iter.second.type] = iter.second.angle;
+      mRanks[iter.second.type]  = rank++;
+    }
+}
+
+const std::vector<AspectSweep::Match>& AspectSweep::find(const std::vector<AspectPoint> &points1, const std::vector<AspectPoint> &points2,
+                                                         const std::array<bool, ASPECT_COUNT> &aspVisible,
+                                                         const std::array<double, ASPECT_COUNT> &aspOrbs, bool ordered)
+{
+  mMatches.clear();
+  int n2 = points2.size();
+  if(points1.empty() || n2 == 0) { return mMatches; }
+
+  // sort second set (doubled -- windows starting before 360 may end past it)
+  double maxOrb2 = points2[0].orb;
+  mSorted.resize(2*n2);
+  for(int k = 0; k < n2; k++)
+    {
+      double lon = std::fmod(points2[k].lon, 360.0);
+      mSorted[k] = Entry{(lon < 0.0 ? lon + 360.0 : lon), k};
+      maxOrb2 = std::max(maxOrb2, points2[k].orb);
+    }
+  std::sort(mSorted.begin(), mSorted.begin()+n2, [](const Entry &e1, const Entry &e2) { return e1.lon < e2.lon; });
+  for(int k = 0; k < n2; k++)
+    { mSorted[n2+k] = Entry{mSorted[k].lon + 360.0, mSorted[k].point}; }
+  
+  for(int a = 0; a < ASPECT_COUNT; a++)
+    {
+      if(!aspVisible[a]) { continue; }
+      double angle = mAngles[a];
+      for(const auto &p1 : points1)
+        {
+          // tests points in window [start, start+width] (degrees)
+          auto sweep = [&](double start, double width)
+                       {
+                         start = std::fmod(start, 360.0);
+                         if(start < 0.0) { start += 360.0; }
+                         int k0 = std::lower_bound(mSorted.begin(), mSorted.begin()+n2, start,
+                                                   [](const Entry &e, double lon) { return e.lon < lon; }) - mSorted.begin();
+                         // gather candidates in window
+                         mCandidates.clear();
+                         mDiffs.clear();
+                         for(int k = k0; k < k0+n2 && mSorted[k].lon <= start+width; k++)
+                           {
+                             const AspectPoint &p2 = points2[mSorted[k].point];
+                             if(ordered && p1.index >= p2.index) { continue; }
+                             mCandidates.push_back(mSorted[k].point);
+                             mDiffs.push_back(p2.lon);
+                           }
+                         // (same test as brute force -- batch helpers are bit-identical)
+                         int n = mCandidates.size();
+                         angleDiffDegrees(mDiffs.data(), p1.lon, mDiffs.data(), n); // difference between points
+                         angleDiffDegrees(mDiffs.data(), angle,  mDiffs.data(), n); // difference from exact aspect
+                         for(int c = 0; c < n; c++)
+                           {
+                             const AspectPoint &p2 = points2[mCandidates[c]];
+                             double aDiff = mDiffs[c];
+                             double orb   = std::min(aspOrbs[a], std::min(p1.orb, p2.orb));
+                             if(std::abs(aDiff) <= orb)
+                               { mMatches.push_back(Match{p1.index, p2.index, (AspectType)a, aDiff, 1.0 - (std::abs(aDiff) / orb)}); }
+                           }
+                       };
+          
+          // range of angle differences that can be in orb
+          double w = std::min(aspOrbs[a], std::min(p1.orb, maxOrb2));
+          if(w < 0.0) { continue; }
+          w += ASPECT_SWEEP_PAD;
+          double dMin = angle - w;
+          double dMax = angle + w;
+          if(dMin <= 0.0 && dMax >= 180.0) { sweep(p1.lon, 360.0); }                       // (every point)
+          else if(dMin <= 0.0)             { sweep(p1.lon - dMax, 2.0*dMax); }              // (one window around p1)
+          else if(dMax >= 180.0)           { sweep(p1.lon + dMin, 2.0*(180.0 - dMin)); }   // (one window around opposite of p1)
+          else
+            { // (one window on each side)
+              sweep(p1.lon + dMin, dMax - dMin);
+              sweep(p1.lon - dMax, dMax - dMin);
+            }
+        }
+    }
+
+  // order by pair, then aspect
+  std::sort(mMatches.begin(), mMatches.end(),
+            [this](const Match &m1, const Match &m2)
+            {
+              if(m1.index1 != m2.index1) { return (m1.index1 < m2.index1); }
+              if(m1.index2 != m2.index2) { return (m1.index2 < m2.index2); }
+              return (mRanks[m1.type] < mRanks[m2.type]);
+            });
+  return mMatches;
+}
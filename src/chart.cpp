@@ -1,10 +1,15 @@
 #include "chart.hpp"
 using namespace astro;
 
+#include "ephemerisPool.hpp"
+
 #include <fstream>
 #include <array>
 #include <string>
 #include <cctype>
+#include <functional>
+#include <tuple>
+#include <cmath>
 
 
 //// INSIDE DEGREE TEXT ////
@@ -56,13 +61,91 @@ std::string Chart::getInsideDegreeTextLong(int sign, int degree)
 
 
 
+//// ASPECT CACHE ////
+size_t AspectCache::hashParams(const ChartParams &params)
+{
+  size_t h = 14695981039346656037ULL; // (FNV-1a)
+  auto add = [&h](size_t v) { h = (h ^ v)*1099511628211ULL; };
+  for(int i = 0; i < params.objVisible.size(); i++) { add(params.objVisible[i]); add(std::hash<double>()(params.objOrbs[i])); }
+  for(int i = 0; i < ASPECT_COUNT; i++)             { add(params.aspVisible[i]); add(std::hash<double>()(params.aspOrbs[i])); }
+  return h;
+}
+
+bool AspectCache::sameParams(const ChartParams &p1, const ChartParams &p2)
+{
+  return (p1.objVisible == p2.objVisible && p1.objOrbs == p2.objOrbs &&
+          p1.aspVisible == p2.aspVisible && p1.aspOrbs == p2.aspOrbs);
+}
+
+std::vector<ChartAspect>& AspectCache::get(unsigned long version1, unsigned long version2, const ChartParams &params, bool &hit)
+{
+  size_t hash = hashParams(params);
+  int oldest = 0;
+  for(int i = 0; i < mEntries.size(); i++)
+    {
+      Entry &e = mEntries[i];
+      if(e.valid && e.version1 == version1 && e.version2 == version2 && e.hash == hash && sameParams(e.params, params))
+        {
+          e.lastUse = ++mUseCount;
+          mLast = i;
+          hit = true;
+          return e.aspects;
+        }
+      if(!e.valid || (mEntries[oldest].valid && e.lastUse < mEntries[oldest].lastUse)) { oldest = i; }
+    }
+  // replace least recently used entry
+  Entry &e = mEntries[oldest];
+  e.valid    = true;
+  e.version1 = version1;
+  e.version2 = version2;
+  e.hash     = hash;
+  e.params   = params;
+  e.lastUse  = ++mUseCount;
+  e.aspects.clear();
+  mLast = oldest;
+  hit = false;
+  return e.aspects;
+}
+
+const std::vector<ChartAspect>& AspectCache::last() const
+{
+  static const std::vector<ChartAspect> empty;
+  return (mLast >= 0 ? mEntries[mLast].aspects : empty);
+}
+
+const ChartParams* AspectCache::lastParams() const
+{ return (mLast >= 0 ? &mEntries[mLast].params : nullptr); }
+
+void AspectCache::clear()
+{
+  for(auto &e : mEntries) { e.valid = false; e.aspects.clear(); }
+  mLast = -1;
+}
+
+
+
+//// CHART OBJECTS ////
+void ChartObjects::bind()
+{
+  mViews.clear();
+  mViews.reserve(OBJ_END);
+  mPointers.clear();
+  for(int o = 0; o < OBJ_END; o++)
+    {
+      mViews.push_back(ChartObject{(ObjType)o, mArrays.angle[o], mArrays.visible[o], mArrays.focused[o], mArrays.valid[o], mArrays.retrograde[o]});
+      mPointers.push_back(&mViews.back());
+    }
+}
+
+
+
 //// CHART ////
+std::atomic<unsigned long> Chart::mNextVersion(0);
+
 Chart::Chart(const DateTime &dt, const Location &loc)
   : mDate(dt), mLocation(loc)
 {
-  for(int o = 0; o < OBJ_END; o++)
-    { mObjects.push_back(new ChartObject{(ObjType)o, 0.0, true, false, false, false}); }
-
+  mVersion = mPositionsVersion = mHousesVersion = mSettingsVersion = nextVersion();
   for(int asp = 0; asp < ASPECT_COUNT; asp++)
     {
       mAspectOrbs[asp]    = getAspectInfo((AspectType)asp)->orb;
@@ -75,12 +158,6 @@ Chart::Chart()
   : Chart(DateTime(), Location())
 { }
 
-Chart::~Chart()
-{
-  for(auto obj : mObjects) { delete obj; }
-  mObjects.clear();
-}
-
 void Chart::setDate(const DateTime &dt)
 {
   if(!dt.valid()) { std::cout << "WARNING: Chart::setDate --> Invalid date: " << dt << "\n"; }
@@ -88,7 +165,8 @@ void Chart::setDate(const DateTime &dt)
     {
       mDate = dt;
       mDate.fix();
-      mNeedUpdate = true;
+      mDirty      |= (CHART_STAGE_OBJECTS | CHART_STAGE_HOUSES);
+      mDateChanged = true;
     }
 }
 
@@ -99,115 +177,200 @@ void Chart::setLocation(const Location &loc)
     {
       mLocation = loc;
       mLocation.fix();
-      mNeedUpdate = true;
+      mDirty     |= CHART_STAGE_HOUSES | ((mSwe.getSweFlags() & SEFLG_TOPOCTR) ? CHART_STAGE_OBJECTS : 0);
+      mLocChanged = true;
+    }
+}
+
+void Chart::setZodiac(ZodiacType zodiac)
+{
+  if(zodiac != mZodiac)
+    { // sidereal positions recalculated by swe -- other zodiacs only transformed
+      bool sidereal = ((zodiac == ZODIAC_SIDEREAL) != (mZodiac == ZODIAC_SIDEREAL));
+      mDirty |= CHART_STAGE_ZODIAC | (sidereal ? (CHART_STAGE_OBJECTS | CHART_STAGE_HOUSES) : 0);
+      mZodiac = zodiac;
+      settingsChanged();
     }
 }
 
 int Chart::aspectCount(AspectType a)
 {
   int count = 0;
-  for(auto asp : mAspects)
+  for(const auto &asp : aspects())
     { count += (asp.type == a ? 1 : 0); }
   return count;
 }
 
-std::vector<ChartAspect> Chart::calcAspects(const ChartParams &params)
+void Chart::calcAspects(const ChartParams &params, std::vector<ChartAspect> &out)
 {
-  mAspects.clear();
-  for(int o1 = 0; o1 < OBJ_END; o1++)
+  out.clear();
+  mAspectPoints.clear();
+  for(int o = 0; o < OBJ_END; o++)
     {
-      if(!params.objVisible[o1]) { continue; } // skip if switched off
-      double angle1 = mObjects[o1]->angle;
-      std::string name1 = getObjName((ObjType)o1);
-
-      for(int o2 = o1+1; o2 < OBJ_END; o2++)
-        {
-          if(!params.objVisible[o2]) { continue; } // skip if switched off
-          double angle2 = mObjects[o2]->angle;
-          std::string name2 = getObjName((ObjType)o2);
-          double diff = angleDiffDegrees(angle1, angle2);
-          for(auto &iter : ASPECTS)
-            {
-              if(!params.aspVisible[iter.second.type]) { continue; } // skip if switched off
-              double aDiff = angleDiffDegrees(diff, iter.second.angle);
-              double orb = std::min(params.aspOrbs[(int)iter.second.type], std::min(params.objOrbs[o1], params.objOrbs[o2]));
-              if(std::abs(aDiff) <= orb)
-                {
-                  // sort aspects from strongest to weakest
-                  double strength = 1.0 - (std::abs(aDiff) / orb);
-                  mAspects.emplace_back(mObjects[o1], mObjects[o2], iter.second.type, aDiff, strength);
-                }
-            }
-        }
+      if(!params.objVisible[o]) { continue; } // skip if switched off
+      mAspectPoints.push_back(AspectPoint{o, mObjects.arrays().angle[o], params.objOrbs[o]});
     }
+  for(const auto &m : mAspectSweep.find(mAspectPoints, mAspectPoints, params.aspVisible, params.aspOrbs, true))
+    { out.emplace_back((ObjType)m.index1, (ObjType)m.index2, m.type, m.orb, m.strength); }
 
-  // sort aspects by orb (reverse?)
-  std::sort(mAspects.begin(), mAspects.end(),
+  // sort aspects by orb (ascending)
+  //  - orbs quantized to 0.001 degrees -- near-equal orbs differentiated by aspect type, then object types (deterministic order)
+  std::sort(out.begin(), out.end(),
             [](const ChartAspect &a, const ChartAspect &b) -> bool
             {
-              if(std::abs(a.orb - b.orb) < 0.001)
-                { // differentiate by aspect type, then object types
-                  if(a.type < b.type) { return true; }
-                  else if(a.obj1 < b.obj1) { return true; }
-                  else if(a.obj2 < b.obj2) { return true; }
-                  else { return false; }
-                }
-              else // return smaller orb
-                { return (a.orb < b.orb); }
-            } ); // sort by orb (ascending)
-  
-  return mAspects;
+              long long qa = std::llround(a.orb*1000.0);
+              long long qb = std::llround(b.orb*1000.0);
+              return (std::tie(qa, a.type, a.obj1, a.obj2) < std::tie(qb, b.type, b.obj1, b.obj2));
+            } );
+}
+
+const std::vector<ChartAspect>& Chart::getAspects(const ChartParams &params)
+{
+  bool hit = false;
+  std::vector<ChartAspect> &aspects = mAspectCache.get(mVersion, 0, params, hit);
+  if(!hit) { calcAspects(params, aspects); }
+  return aspects;
+}
+
+const std::vector<AspectPattern>& Chart::getPatterns(const ChartParams &params)
+{
+  const ChartObjectArrays &a = mObjects.arrays();
+  PatternMask active = 0;
+  for(int o = 0; o < OBJ_END; o++)
+    { active |= ((params.objVisible[o] && a.valid[o]) ? (PatternMask(1) << o) : 0); }
+  mPatternFinder.update(a.angle.data(), active, params.objOrbs.data(), params.aspVisible, params.aspOrbs);
+  return mPatternFinder.patterns();
 }
 
 void Chart::update()
 {
-  if(mNeedUpdate)
+  if(!(mDirty & CHART_STAGE_OBJECTS) && mInterpolated)
+    { mDirty |= CHART_STAGE_OBJECTS; } // date stopped changing -- restore exact positions
+  if((mDirty & CHART_STAGE_OBJECTS) || mExtras.registryVersion != registryVersion())
+    { mDirty |= CHART_STAGE_EXTRAS; }
+  
+  if(mDirty)
     {
       // update chart info (via Swiss Ephemeris wrapper)
       mLocation.fix();
       mDate.fix();
-      // DateTime minDate = mDate;
-      // minDate.setYear(-8000); minDate.setMonth(1); minDate.setDay(1); minDate.setHour(0); minDate.setMinute(0); minDate.setSecond(0.0); minDate.fix();
-      // if(mDate < DateTime()) { mDate = minDate; }
-      //std::cout << mDate.year() << "\n";
       mSwe.setLocation(mLocation);
       mSwe.setDate(mDate);
       mSwe.setSidereal(mZodiac == ZODIAC_SIDEREAL);
       mSwe.setTruePos(mTruePos);
-      mSwe.calcHouses(mHouseSystem);
 
-      for(int hi = 0; hi < 12; hi++) // get house cusps
-        { mHouseCusps[hi] = mSwe.getHouseCusp(hi+1); }
+      if(mDirty & CHART_STAGE_HOUSES)
+        { // calc houses and angles
+          mSwe.calcHouses(mHouseSystem);
+          for(int o = ANGLE_OFFSET; o < OBJ_END; o++)
+            { mObjects.setData((ObjType)o, mSwe.getObjData((ObjType)o)); }
+        }
+      
+      if(mDirty & CHART_STAGE_OBJECTS)
+        { // calc objects (batched -- interpolated if date is being swept in small steps)
+          double jd = mSwe.getJulianDayET();
+          bool smallStep = (mDateChanged && !mLocChanged && std::abs(jd - mLastJulDay) < CHEBY_SWEEP_STEP);
+          mSweepUpdates = (smallStep ? mSweepUpdates+1 : 0);
+          mInterpolated = (mInterpolate && mSweepUpdates >= CHART_SWEEP_UPDATES);
+          mLastJulDay   = jd;
+          mDateChanged  = false;
       
-      mObjectData.clear();
-      for(int i = 0; i < mObjects.size(); i++)
-        { // calc objects
-          ObjType o = (ObjType)i;//(ObjType)(OBJ_SUN + i);
-          //if(o >= OBJ_COUNT) { o = (ObjType)(o-OBJ_COUNT+ANGLE_OFFSET); } // correct for angles
-          ChartObject *obj = mObjects[i];
-          mObjectData.push_back(mSwe.getObjData((ObjType)o));
-          obj->valid = mObjectData.back().valid;
-          obj->angle = mObjectData.back().longitude;
-          obj->retrograde = (mObjectData.back().lonSpeed < 0.0);
+          ObjDataArray objData;
+          if(mInterpolated)
+            {
+              mCache.setParams(mLocation, mSwe.getSweFlags());
+              mCache.calcObjects(jd, ObjMask().set(), objData);
+            }
+          else
+            { mSwe.calcObjects(ObjMask().set(), objData); }
+          ChartObjectArrays &a = mObjects.arrays();
+          for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+            {
+              a.longitude[o] = objData.longitude[o]; a.latitude[o] = objData.latitude[o]; a.distance[o]  = objData.distance[o];
+              a.lonSpeed[o]  = objData.lonSpeed[o];  a.latSpeed[o] = objData.latSpeed[o]; a.distSpeed[o] = objData.distSpeed[o];
+              a.valid[o]     = objData.valid[o];
+            }
         }
+      if(mDirty & CHART_STAGE_EXTRAS)
+        { calcExtras(); }
+      mLocChanged = false;
 
+      // zodiac transform (reapplied whenever positions change)
+      ChartObjectArrays &a = mObjects.arrays();
+      for(int o = 0; o < OBJ_END; o++)
+        {
+          a.angle[o]      = a.longitude[o];
+          a.retrograde[o] = (a.lonSpeed[o] < 0.0);
+        }
+      for(int hi = 0; hi < 12; hi++) // get house cusps
+        { mHouseCusps[hi] = mSwe.getHouseCusp(hi+1); }
+      
       if(mZodiac == ZODIAC_DRACONIC)
         { // set aries 0-degrees to true node 
-          double nnAngle = mObjects[OBJ_NORTHNODE]->angle;
-          for(auto obj : mObjects)        // orient object positions
-            { obj->angle =  fmod(obj->angle - nnAngle + 360.0, 360.0); }
+          double nnAngle = a.angle[OBJ_NORTHNODE];
+          for(int o = 0; o < OBJ_END; o++) // orient object positions
+            { a.angle[o] = fmod(a.angle[o] - nnAngle + 360.0, 360.0); }
           for(int hi = 0; hi < 12; hi++) // orient houses
             { mHouseCusps[hi] = fmod(mHouseCusps[hi] - nnAngle + 360.0, 360.0); }
         }
+      if(mDirty & (CHART_STAGE_EXTRAS | CHART_STAGE_ZODIAC))
+        { // registry objects
+          double offset = (mZodiac == ZODIAC_DRACONIC ? 360.0 - a.longitude[OBJ_NORTHNODE] : 0.0);
+          for(int i = 0; i < mExtras.size(); i++)
+            { mExtras.angle[i] = fmod(mExtras.longitude[i] + offset, 360.0); }
+        }
+      mHouseSearch.setCusps(mHouseCusps);
       
       //calcAspects();
-      mNeedUpdate = false;
+      if(mDirty & ~CHART_STAGE_ASPECTS)
+        { // bump versions of changed outputs
+          mVersion = nextVersion();
+          if(mDirty & (CHART_STAGE_OBJECTS | CHART_STAGE_ZODIAC | CHART_STAGE_EXTRAS)) { mPositionsVersion = mVersion; }
+          if(mDirty & (CHART_STAGE_HOUSES  | CHART_STAGE_ZODIAC))                      { mHousesVersion    = mVersion; }
+        }
+      mDirty = 0;
+    }
+}
+
+std::shared_ptr<const ObjectList> Chart::registry() const
+{ return (mRegistry ? mRegistry : ObjectRegistry::instance().snapshot()); }
+unsigned long Chart::registryVersion() const
+{ return (mRegistry ? mRegistry->version : ObjectRegistry::instance().version()); }
+
+void Chart::calcExtras()
+{
+  std::shared_ptr<const ObjectList> list = registry();
+  const ObjectList &registry = *list;
+  int  n    = registry.size();
+  bool full = !mInterpolated;
+  if(mExtras.registryVersion != registry.version)
+    { // registry changed -- keep visibility of existing objects if only appended to
+      int keep = (n >= mExtras.size() ? mExtras.size() : 0);
+      mExtras.resize(n);
+      for(int i = keep; i < n; i++) { mExtras.visible.set(i, registry.get(i).visible); }
+      mExtras.registryVersion = registry.version;
+      full = true;
+    }
+  if(n == 0) { return; }
+  
+  double jd    = mSwe.getJulianDayET();
+  long   flags = mSwe.getSweFlags();
+  if(full)
+    { registry.calcObjects(jd, flags, mLocation, mExtras, &EphemerisPool::global()); }
+  else
+    { // sweeping -- refresh one chunk per update (exact positions restored with built-in objects when date stops changing)
+      int begin = mExtrasChunk*OBJ_REGISTRY_CHUNK;
+      if(begin >= n) { begin = 0; mExtrasChunk = 0; }
+      registry.calcObjects(jd, flags, mLocation, begin, std::min(begin+OBJ_REGISTRY_CHUNK, n), mExtras);
+      mExtrasChunk++;
     }
 }
 
 double Chart::getSingleAngle(ObjType obj)
 {
-  if(!mNeedUpdate)
+  int stages = (obj < OBJ_COUNT ? CHART_STAGE_OBJECTS : CHART_STAGE_HOUSES) | CHART_STAGE_ZODIAC |
+               (mZodiac == ZODIAC_DRACONIC ? CHART_STAGE_OBJECTS : 0); // (stages this angle depends on)
+  if(!(mDirty & stages))
     { return getObject(obj)->angle; }
   else
     {
@@ -221,9 +384,14 @@ double Chart::getSingleAngle(ObjType obj)
       
       if(obj >= ANGLE_OFFSET) { mSwe.calcHouses(mHouseSystem); }
       
-      double angle = mSwe.getObjData(obj).longitude;
+      ObjDataArray objData;
+      ObjMask mask; mask.set(OBJ_NORTHNODE, (mZodiac == ZODIAC_DRACONIC));
+      if(obj < OBJ_COUNT) { mask.set(obj); }
+      mSwe.calcObjects(mask, objData);
+      
+      double angle = (obj < OBJ_COUNT ? objData.longitude[obj] : mSwe.getAngle(obj));
       if(mZodiac == ZODIAC_DRACONIC) // set aries 0-degrees to true node
-        { angle = fmod(angle - mSwe.getObjData(OBJ_NORTHNODE).longitude + 360.0, 360.0); }
+        { angle = fmod(angle - objData.longitude[OBJ_NORTHNODE] + 360.0, 360.0); }
       
       return angle;
     }
@@ -232,11 +400,8 @@ double Chart::getSingleAngle(ObjType obj)
 ChartAspect Chart::getAspect(ObjType obj1, ObjType obj2)
 {
   // TODO: check if need update?
-  int i1 = obj1;//-OBJ_SUN;
-  int i2 = obj2;//-OBJ_SUN;
-  
-  double angle1 = mObjects[obj1]->angle;
-  double angle2 = mObjects[obj2]->angle;
+  double angle1 = mObjects.arrays().angle[obj1];
+  double angle2 = mObjects.arrays().angle[obj2];
   double diff = angleDiffDegrees(angle1, angle2);
   for(auto &iter : ASPECTS)
     {
@@ -246,7 +411,7 @@ ChartAspect Chart::getAspect(ObjType obj1, ObjType obj2)
         {
           // aspects sorted from strongest to weakest
           double strength = 1.0 - (std::abs(aDiff) / orb);
-          return ChartAspect(mObjects[i1], mObjects[i2], iter.second.type, aDiff, strength);
+          return ChartAspect(obj1, obj2, iter.second.type, aDiff, strength);
         }
     }
   return ChartAspect(); // (valid = false)
@@ -264,39 +429,36 @@ int Chart::getSign(double longitude) const
 { return (int)std::floor(fmod(longitude, 360.0)/30.0); }
 // return number of the house containing the given ecliptic angle
 int Chart::getHouse(double longitude) const
-{
-  for(int i = 1; i <= 12; i++)
-    {
-      int ni = (i == 12 ? 1 : i+1);
-      double h1 = getHouseCusp(i);
-      double h2 = getHouseCusp(ni);
-      if(anglesContainDegrees(h1, h2, longitude)) { return i; }
-    }
-  return -1;
-}
+{ return mHouseSearch.getHouse(longitude); }
 
 void Chart::setAspectOrb(AspectType asp, double orb)
 {
   if(asp > ASPECT_INVALID && asp < ASPECT_COUNT)
     {
-      mNeedUpdate |= (mAspectOrbs[(int)asp] != orb);
+      if(mAspectOrbs[(int)asp] == orb) { return; }
+      mDirty |= CHART_STAGE_ASPECTS;
       mAspectOrbs[(int)asp] = orb;
+      settingsChanged();
     }
 }
 void Chart::setAspectFocus(AspectType asp, bool focus)
 {
   if(asp > ASPECT_INVALID && asp < ASPECT_COUNT)
     {
-      mNeedUpdate = (mAspectFocus[(int)asp] != focus);
+      if(mAspectFocus[(int)asp] == focus) { return; }
+      mDirty |= CHART_STAGE_ASPECTS;
       mAspectFocus[(int)asp] = focus;
+      settingsChanged();
     }
 }
 void Chart::setAspectVisible(AspectType asp, bool visible)
 {
   if(asp > ASPECT_INVALID && asp < ASPECT_COUNT)
     {
-      mNeedUpdate = (mAspectVisible[(int)asp] != visible);
+      if(mAspectVisible[(int)asp] == visible) { return; }
+      mDirty |= CHART_STAGE_ASPECTS;
       mAspectVisible[(int)asp] = visible;
+      settingsChanged();
     }
 }
 double Chart::getAspectOrb(AspectType asp)
@@ -305,3 +467,41 @@ bool Chart::getAspectFocus(AspectType asp)
 { return (asp > ASPECT_INVALID && asp < ASPECT_COUNT) ? mAspectFocus[(int)asp]   : false; }
 bool Chart::getAspectVisible(AspectType asp)
 { return (asp > ASPECT_INVALID && asp < ASPECT_COUNT) ? mAspectVisible[(int)asp] : false; }
+
+void Chart::getSnapshot(ChartSnapshot &out) const
+{
+  out.version         = mVersion;
+  out.settingsVersion = mSettingsVersion;
+  out.date            = mDate;
+  out.location        = mLocation;
+  out.houseSystem     = mHouseSystem;
+  out.zodiac          = mZodiac;
+  out.truePos         = mTruePos;
+  out.objects         = mObjects.arrays();
+  out.houseCusps      = mHouseCusps;
+  out.aspectOrbs      = mAspectOrbs;
+  out.aspectFocus     = mAspectFocus;
+  out.aspectVisible   = mAspectVisible;
+  out.registry        = registry();
+}
+
+void Chart::setSnapshot(const ChartSnapshot &snapshot)
+{
+  mRegistry = snapshot.registry;
+  setDate(snapshot.date);
+  setLocation(snapshot.location);
+  setHouseSystem(snapshot.houseSystem);
+  setZodiac(snapshot.zodiac);
+  setTruePos(snapshot.truePos);
+  for(int o = 0; o < OBJ_END; o++)
+    {
+      showObject((ObjType)o, snapshot.objects.visible[o]);
+      setObjFocus((ObjType)o, snapshot.objects.focused[o]);
+    }
+  for(int a = 0; a < ASPECT_COUNT; a++)
+    {
+      setAspectOrb((AspectType)a, snapshot.aspectOrbs[a]);
+      setAspectFocus((AspectType)a, snapshot.aspectFocus[a]);
+      setAspectVisible((AspectType)a, snapshot.aspectVisible[a]);
+    }
+}
@@ -3,6 +3,7 @@ using namespace astro;
 
 
 ChartCompare::ChartCompare()
+  : mVersion(Chart::nextVersion()), mSettingsVersion(mVersion)
 {
   for(int asp = 0; asp < ASPECT_COUNT; asp++)
     {
@@ -17,67 +18,87 @@ ChartCompare::~ChartCompare()
   
 }
 
-std::vector<ChartAspect> ChartCompare::calcAspects(const ChartParams &params)
+void ChartCompare::getPoints(const Chart *chart, const ChartParams &params, std::vector<AspectPoint> &out)
 {
-  mAspects.clear();
-  if(!mChartOuter || !mChartInner) { return { }; }
-  
-  for(int o1 = 0; o1 < OBJ_END; o1++)
+  out.clear();
+  for(int o = 0; o < OBJ_END; o++)
     {
-      if(!params.objVisible[o1]) { continue; } // skip if switched off
-      int i1 = o1;
-      double angle1 = mChartOuter->objects()[o1]->angle;
-      std::string name1 = getObjName((ObjType)o1);
+      if(!params.objVisible[o]) { continue; } // skip if switched off
+      out.push_back(AspectPoint{o, chart->objectArrays().angle[o], params.objOrbs[o]});
+    }
+}
 
-      // object aspects
-      for(int o2 = o1+1; o2 < OBJ_END; o2++)
-        {
-          if(!params.objVisible[o2]) { continue; } // skip if switched off
-          int i2 = o2;
-          double angle2 = mChartInner->objects()[o2]->angle;
-          std::string name2 = getObjName((ObjType)o2);
-          double diff = astro::angleDiffDegrees(angle1, angle2);
-          
-          for(auto &iter : astro::ASPECTS)
+// sort aspects by orb (ascending), then strength
+//  (exact ties broken by objects/aspect -- total order, so mirrored sets sort the same as direct ones)
+static void sortAspects(std::vector<ChartAspect> &aspects)
+{
+  std::sort(aspects.begin(), aspects.end(),
+            [](const ChartAspect &a, const ChartAspect &b) -> bool
             {
-              if(!params.aspVisible[iter.second.type]) { continue; } // skip if switched off
-              double aDiff = astro::angleDiffDegrees(diff, iter.second.angle);
-              double orb = std::min(params.aspOrbs[(int)iter.second.type], std::min(params.objOrbs[o1], params.objOrbs[o2]));
-              if(std::abs(aDiff) <= orb)
-                {
-                  // sort aspects from strongest to weakest
-                  double strength = 1.0 - (std::abs(aDiff) / orb);
-                  bool added = false;
-                  for(int i = 0; i < mAspects.size(); i++)
-                    {
-                      if(strength < mAspects[i].strength)
-                        {
-                          mAspects.insert(mAspects.begin()+i, ChartAspect(mChartOuter->objects()[i1], mChartInner->objects()[i2], iter.second.type, aDiff, strength));
-                          added = true; break;
-                        }
-                    }
-                  if(!added)
-                    { mAspects.emplace_back(mChartOuter->objects()[i1], mChartInner->objects()[i2], iter.second.type, aDiff, strength); }
-                }
-            }
-        }
-    }
+              if(a.orb != b.orb)           { return a.orb < b.orb; }
+              if(a.strength != b.strength) { return a.strength < b.strength; }
+              if(a.obj1 != b.obj1)         { return a.obj1 < b.obj1; }
+              if(a.obj2 != b.obj2)         { return a.obj2 < b.obj2; }
+              return a.type < b.type;
+            });
+}
 
-      // sort aspects by orb (reverse?)
-      std::sort(mAspects.begin(), mAspects.end(),
-                [](const ChartAspect &a, const ChartAspect &b) -> bool
-                { return a.orb < b.orb; } ); // sort by orb (ascending)
-      return mAspects;
+void ChartCompare::findAspects(const std::vector<AspectPoint> &outer, const std::vector<AspectPoint> &inner,
+                               const ChartParams &params, AspectSweep &sweep, std::vector<ChartAspect> &out)
+{
+  out.clear();
+  for(const auto &m : sweep.find(outer, inner, params.aspVisible, params.aspOrbs, false)) // (all pairs)
+    { out.emplace_back((ObjType)m.index1, (ObjType)m.index2, m.type, m.orb, m.strength); }
+  sortAspects(out);
+}
+
+void ChartCompare::mirrorAspects(const std::vector<ChartAspect> &aspects, std::vector<ChartAspect> &out)
+{
+  out.clear();
+  for(const auto &asp : aspects)
+    {
+      out.push_back(asp);
+      std::swap(out.back().obj1, out.back().obj2);
     }
+  sortAspects(out); // (same order as calculating the mirrored pair directly)
+}
 
+void ChartCompare::calcAspects(const ChartParams &params, std::vector<ChartAspect> &out)
+{
+  out.clear();
+  if(!mChartOuter || !mChartInner) { return; }
+  
+  getPoints(mChartOuter, params, mPointsOuter);
+  getPoints(mChartInner, params, mPointsInner);
+  findAspects(mPointsOuter, mPointsInner, params, mAspectSweep, out);
+}
+
+const std::vector<ChartAspect>& ChartCompare::getAspects(const ChartParams &params)
+{
+  if(!mChartOuter || !mChartInner) { mAspectCache.clear(); return mAspectCache.last(); }
+  bool hit = false;
+  std::vector<ChartAspect> &aspects = mAspectCache.get(mChartOuter->version(), mChartInner->version(), params, hit);
+  if(!hit) { calcAspects(params, aspects); }
+  return aspects;
+}
 
-  void ChartCompare::update()
-  {
-    // if(mNeedUpdate)
+void ChartCompare::setAspects(const ChartParams &params, const std::vector<ChartAspect> &aspects)
+{
+  if(!mChartOuter || !mChartInner) { return; }
+  bool hit = false;
+  std::vector<ChartAspect> &cached = mAspectCache.get(mChartOuter->version(), mChartInner->version(), params, hit);
+  if(!hit) { cached = aspects; }
+}
+
+void ChartCompare::update()
+{
+  unsigned long outer = (mChartOuter ? mChartOuter->version() : 0);
+  unsigned long inner = (mChartInner ? mChartInner->version() : 0);
+  if(mChartsChanged || outer != mOuterVersion || inner != mInnerVersion)
     {
-      // if(mChartOuter && mChartInner)
-      //   { calcAspects(); }
-      mNeedUpdate = false;
+      mVersion       = Chart::nextVersion();
+      mOuterVersion  = outer;
+      mInnerVersion  = inner;
+      mChartsChanged = false;
     }
-  }
-
+}
@@ -111,11 +111,10 @@ void ChartDataNode::onDraw()
       ImGui::Separator();
       
       ImGuiIO& io = ImGui::GetIO();
-      astro::Ephemeris &swe = chart->swe();
             
       for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
         {
-          astro::ObjData obj = swe.getObjData((astro::ObjType)o);
+          astro::ObjData obj = chart->getObjectData((astro::ObjType)o); // (calculated in Chart::update)
           double angle = obj.longitude;//swe.getObjAngle((astro::ObjType)o);
           std::string name = getObjName((astro::ObjType)o);
           std::string nameLong = getObjNameLong((astro::ObjType)o);
@@ -112,7 +112,7 @@ void ChartNode::onDraw()
   
   DateTime dt   = mChart->date();
   Location loc  = mChart->location();
-  double julDay = mChart->swe().getJulianDayET(dt, loc);
+  double julDay = mChart->swe().getJulianDayET(); // (calculated in Chart::update)
 
   ImGui::TextUnformatted(dt.toString().c_str());
   ImGui::Text("(jd_ET = %.6f)", julDay);
@@ -97,9 +97,11 @@ void ChartView::renderZodiac(Chart *chart, const ViewParams &params, ImDrawList
                   ImGui::TableNextColumn();
                   ImGui::TableNextColumn();
                   // contained objects
+                  std::array<int, OBJ_END> signs;
+                  getSigns(chart->objectArrays().angle.data(), signs.data(), OBJ_END);
                   for(auto obj : chart->objects())
                     {
-                      int si = chart->getSign(obj->angle);
+                      int si = signs[obj->type];
                       if(si == i)
                         {
                           ImGui::TableNextRow();
@@ -158,6 +160,8 @@ void ChartView::renderHouses(Chart *chart, const ViewParams &params, ImDrawList
   // draw houses
   float numOffset = CHART_HOUSE_NUM_OFFSET*params.sizeRatio;
   float ocRadius =  CHART_HOUSE_CIRCLE_RADIUS*params.sizeRatio; // radius of circles around outer house numbers
+  std::array<int, OBJ_COUNT> houses; // house containing each object (tooltips)
+  chart->getHouses(chart->objectArrays().angle.data(), houses.data(), OBJ_COUNT);
   for(int i = 1; i <= 12; i++)
     {
       float angle1 = chart->getHouseCusp(i);                    // this house's cusp
@@ -220,9 +224,7 @@ void ChartView::renderHouses(Chart *chart, const ViewParams &params, ImDrawList
               std::vector<ChartObject*> inHouse;
               for(int i2 = OBJ_SUN; i2 < OBJ_COUNT; i2++) // (angles already at house cusps)
                 {
-                  ChartObject *obj = chart->getObject((ObjType)i2);
-                  int hi = chart->getHouse(obj->angle);
-                  if(hi == i) { inHouse.push_back(obj); }
+                  if(houses[i2] == i) { inHouse.push_back(chart->getObject((ObjType)i2)); }
                 }
 
               std::sort(inHouse.begin(), inHouse.end(),
@@ -336,7 +338,7 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
   Vec2f t0(0.0f, 0.0f);
   Vec2f t1(1.0f, 1.0f);
   
-  std::vector<ChartAspect> aspects = chart->calcAspects(chartParams);
+  const std::vector<ChartAspect> &aspects = chart->getAspects(chartParams);
   
   bool anyFocused = false;
   for(auto obj : chart->objects())      { anyFocused |= obj->focused; }              // object focus
@@ -348,12 +350,12 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
   for(int i = aspects.size()-1; i >= 0; i--)
     {
       const ChartAspect &asp = aspects[i];
-      if(asp.type == ASPECT_OPPOSITION && ((asp.obj1->type == OBJ_NORTHNODE && asp.obj2->type == OBJ_SOUTHNODE) ||
-                                           (asp.obj1->type == OBJ_SOUTHNODE && asp.obj2->type == OBJ_NORTHNODE)))
+      if(asp.type == ASPECT_OPPOSITION && ((asp.obj1 == OBJ_NORTHNODE && asp.obj2 == OBJ_SOUTHNODE) ||
+                                           (asp.obj1 == OBJ_SOUTHNODE && asp.obj2 == OBJ_NORTHNODE)))
         {
           lAsp = &asp;
-          float angle1 = screenAngle(chart, (lAsp->obj1->angle));
-          float angle2 = screenAngle(chart, (lAsp->obj2->angle));
+          float angle1 = screenAngle(chart, (chart->getObject(lAsp->obj1)->angle));
+          float angle2 = screenAngle(chart, (chart->getObject(lAsp->obj2)->angle));
       
           Vec2f v1(cos(angle1), -sin(angle1));
           Vec2f v2(cos(angle2), -sin(angle2));
@@ -375,17 +377,17 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
   for(int i = 0; i < aspects.size(); i++)
     {
       const ChartAspect &asp = aspects[i];
-      if(asp.type == ASPECT_OPPOSITION && ((asp.obj1->type == OBJ_NORTHNODE && asp.obj2->type == OBJ_SOUTHNODE) ||
-                                           (asp.obj1->type == OBJ_SOUTHNODE && asp.obj2->type == OBJ_NORTHNODE) ||
-                                           (asp.obj1->type == ANGLE_ASC     && asp.obj2->type == ANGLE_DSC)     ||
-                                           (asp.obj1->type == ANGLE_DSC     && asp.obj2->type == ANGLE_ASC)     ||
-                                           (asp.obj1->type == ANGLE_MC      && asp.obj2->type == ANGLE_IC)      ||
-                                           (asp.obj1->type == ANGLE_IC      && asp.obj2->type == ANGLE_MC)))
+      if(asp.type == ASPECT_OPPOSITION && ((asp.obj1 == OBJ_NORTHNODE && asp.obj2 == OBJ_SOUTHNODE) ||
+                                           (asp.obj1 == OBJ_SOUTHNODE && asp.obj2 == OBJ_NORTHNODE) ||
+                                           (asp.obj1 == ANGLE_ASC     && asp.obj2 == ANGLE_DSC)     ||
+                                           (asp.obj1 == ANGLE_DSC     && asp.obj2 == ANGLE_ASC)     ||
+                                           (asp.obj1 == ANGLE_MC      && asp.obj2 == ANGLE_IC)      ||
+                                           (asp.obj1 == ANGLE_IC      && asp.obj2 == ANGLE_MC)))
         { continue; } // skip lunar node opposition (drawn separately) -- also omit asc/dsc and mc/ic oppositions
 
       std::string aName = getAspectName(asp.type);
-      float angle1 = screenAngle(chart, (asp.obj1->angle));
-      float angle2 = screenAngle(chart, (asp.obj2->angle));
+      float angle1 = screenAngle(chart, (chart->getObject(asp.obj1)->angle));
+      float angle2 = screenAngle(chart, (chart->getObject(asp.obj2)->angle));
       
       Vec2f v1(cos(angle1), -sin(angle1));
       Vec2f v2(cos(angle2), -sin(angle2));
@@ -402,13 +404,13 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
       
       Vec4f color = getAspectInfo(asp.type)->color;
       color.w = ((anyFocused && !(asp.focused || chartParams.aspFocused[asp.type] ||
-                                  asp.obj1->focused || asp.obj2->focused)) ? 0.0 : 0.8)*stren;
+                                  chart->getObject(asp.obj1)->focused || chart->getObject(asp.obj2)->focused)) ? 0.0 : 0.8)*stren;
       
       float symSize = params.symbolSize*0.9f;
       float sqStrength = std::max(0.2f, stren); // clamp to threshold
 
       Vec4f bgColor = Vec4f(0.0f, 0.0f, 0.0f, color.w);
-      if(asp.focused || chartParams.aspFocused[asp.type] || asp.obj1->focused || asp.obj2->focused)
+      if(asp.focused || chartParams.aspFocused[asp.type] || chart->getObject(asp.obj1)->focused || chart->getObject(asp.obj2)->focused)
         { bgColor = Vec4f(1.0f, 1.0f, 1.0f, color.w); }
       if(bgColor.w < 0.01f) { continue; }
 
@@ -451,8 +453,8 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
           bool hover = ImGui::IsItemHovered();
           if(!params.blocked && hover)
             { // display tooltip with aspect info
-              Vec4f c1 = getObjColor(getObjName(asp.obj1->type));
-              Vec4f c2 = getObjColor(getObjName(asp.obj2->type));
+              Vec4f c1 = getObjColor(getObjName(asp.obj1));
+              Vec4f c2 = getObjColor(getObjName(asp.obj2));
               
               // set style spacing to default (same size at any scale)
               ImGui::PushStyleVar(ImGuiStyleVar_FramePadding,  Vec2f(ImGui::GetStyle().FramePadding)/params.sizeRatio);
@@ -472,7 +474,7 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
                 ImGui::TextUnformatted(aName.c_str());
                 ImGui::TableNextColumn();
                 // aspect object1 symbol
-                ImGui::Image(getWhiteImage(getObjName(asp.obj1->type))->id(), Vec2f(20.0f, 20.0f), t0, t1, c1, borderCol);
+                ImGui::Image(getWhiteImage(getObjName(asp.obj1))->id(), Vec2f(20.0f, 20.0f), t0, t1, c1, borderCol);
                 // aspect symbol
                 ImGui::SameLine();
                 Vec2f screenPos = Vec2f(ImGui::GetCursorScreenPos()) + Vec2f(10.0f, 10.0f);
@@ -482,7 +484,7 @@ void ChartView::renderAspects(Chart *chart, const ViewParams &params, ImDrawList
                 ImGui::GetWindowDrawList()->AddCircle(screenPos, lineDist*20.0f/params.symbolSize, ImColor(color), 6, 2.0);
                 // aspect object2 symbol
                 ImGui::SameLine();
-                ImGui::Image(getWhiteImage(getObjName(asp.obj2->type))->id(), Vec2f(20.0f, 20.0f), t0, t1, c2, borderCol);
+                ImGui::Image(getWhiteImage(getObjName(asp.obj2))->id(), Vec2f(20.0f, 20.0f), t0, t1, c2, borderCol);
                 ImGui::TableNextColumn();
                 ImGui::TextUnformatted(angle_string(asp.orb, true).c_str());
                   
@@ -506,7 +508,7 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
   Chart *iChart = compare->getInnerChart();
   if(!oChart || !iChart) { return; }
   
-  std::vector<ChartAspect> aspects = compare->calcAspects(chartParams);
+  const std::vector<ChartAspect> &aspects = compare->getAspects(chartParams);
   bool anyFocused = false;
   for(auto obj : oChart->objects())     { anyFocused |= obj->focused; }              // inner chart object focus
   for(auto obj : iChart->objects())     { anyFocused |= obj->focused; }              // outer chart object focus
@@ -519,8 +521,8 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
   for(int i = 0; i < aspects.size(); i++)
     {
       const ChartAspect &asp = aspects[i];
-      float angle1 = screenAngle(compare, (asp.obj1->angle));
-      float angle2 = screenAngle(compare, (asp.obj2->angle));
+      float angle1 = screenAngle(compare, (oChart->getObject(asp.obj1)->angle));
+      float angle2 = screenAngle(compare, (iChart->getObject(asp.obj2)->angle));
       
       Vec2f v1(cos(angle1), -sin(angle1));
       Vec2f v2(cos(angle2), -sin(angle2));
@@ -537,13 +539,13 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
       
       Vec4f color = getAspectInfo(asp.type)->color;
       color.w = ((anyFocused && !(asp.focused || compare->getAspectFocus(asp.type) ||
-                                  asp.obj1->focused || asp.obj2->focused)) ? 0.0 : 0.8)*stren;
+                                  oChart->getObject(asp.obj1)->focused || iChart->getObject(asp.obj2)->focused)) ? 0.0 : 0.8)*stren;
       
       float symSize = params.symbolSize*0.9f;
       float sqStrength = std::max(0.2f, stren); // clamp to threshold
 
       Vec4f bgColor = Vec4f(0.0f, 0.0f, 0.0f, color.w);
-      if(asp.focused || compare->getAspectFocus(asp.type) || asp.obj1->focused || asp.obj2->focused)
+      if(asp.focused || compare->getAspectFocus(asp.type) || oChart->getObject(asp.obj1)->focused || iChart->getObject(asp.obj2)->focused)
         { bgColor = Vec4f(1.0f, 1.0f, 1.0f, color.w); }
       if(bgColor.w < 0.01f)
         { continue; }
@@ -586,8 +588,8 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
           bool hover = ImGui::IsItemHovered();
           if(!params.blocked && hover)
             { // display tooltip with aspect info
-              Vec4f c1 = getObjColor(getObjName(asp.obj1->type));
-              Vec4f c2 = getObjColor(getObjName(asp.obj2->type));
+              Vec4f c1 = getObjColor(getObjName(asp.obj1));
+              Vec4f c2 = getObjColor(getObjName(asp.obj2));
               
               // set style spacing to default (same size at any scale)
               ImGui::PushStyleVar(ImGuiStyleVar_FramePadding,  Vec2f(ImGui::GetStyle().FramePadding)/params.sizeRatio);
@@ -609,7 +611,7 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
                   ImGui::TextUnformatted(aName.c_str());
                   ImGui::TableNextColumn();
                   // aspect object1 symbol
-                  ImGui::Image(getWhiteImage(getObjName(asp.obj1->type))->id(), Vec2f(20.0f, 20.0f), t0, t1, c1, borderCol);
+                  ImGui::Image(getWhiteImage(getObjName(asp.obj1))->id(), Vec2f(20.0f, 20.0f), t0, t1, c1, borderCol);
                   // aspect symbol
                   ImGui::SameLine();
                   Vec2f screenPos = Vec2f(ImGui::GetCursorScreenPos()) + Vec2f(10.0f, 10.0f);
@@ -619,7 +621,7 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
                   draw_list_tt->AddCircle(screenPos, lineDist*20.0f/params.symbolSize, ImColor(color), 6, 2.0);
                   // aspect object2 symbol
                   ImGui::SameLine();
-                  ImGui::Image(getWhiteImage(getObjName(asp.obj2->type))->id(), Vec2f(20.0f, 20.0f), t0, t1, c2, borderCol);
+                  ImGui::Image(getWhiteImage(getObjName(asp.obj2))->id(), Vec2f(20.0f, 20.0f), t0, t1, c2, borderCol);
                   ImGui::TableNextColumn();
                   ImGui::TextUnformatted(angle_string(asp.orb, true).c_str());
                 }
@@ -634,6 +636,51 @@ void ChartView::renderCompareAspects(ChartCompare *compare, const ViewParams &pa
 
 //// OBJECTS ////
 //    level --> which object ring to draw (outer ring is 0) 
+void ChartView::renderExtraObjects(Chart *chart, int level, const ViewParams &params, ImDrawList *draw_list)
+{
+  const ExtraObjectArrays &extras = chart->extraObjects();
+  if(extras.size() == 0 || !extras.visible.any()) { return; }
+  const ObjectRegistry &registry = ObjectRegistry::instance();
+  if(extras.registryVersion != registry.version()) { return; } // (not updated yet)
+
+  // markers inside object ring (only visible objects visited -- one quad each)
+  Vec2f cc      = params.center;
+  float radius  = params.objRadius - params.objRingW*level - params.objRingW*0.15f;
+  Vec2f size    = Vec2f(EXTRA_OBJ_SIZE, EXTRA_OBJ_SIZE)*params.sizeRatio;
+  Vec2f mp      = ImGui::GetMousePos();
+  float mr      = (mp - cc).length();
+  bool  mHover  = (!params.blocked && ImGui::IsWindowHovered() && std::abs(mr - radius) < EXTRA_OBJ_HOVER_DIST);
+  float hDist   = EXTRA_OBJ_HOVER_DIST*EXTRA_OBJ_HOVER_DIST;
+  int   hovered = -1;
+  ImColor starCol(Vec4f(1.0f, 1.0f, 0.8f, 0.9f));
+  ImColor astCol(Vec4f(0.6f, 0.6f, 0.6f, 0.9f));
+  
+  DynamicBitset shown = extras.visible;
+  shown &= extras.valid;
+  shown.forEach([&](int i)
+  {
+    float rAngle = screenAngle(chart, extras.angle[i]);
+    Vec2f p = cc + radius*Vec2f(cos(rAngle), -sin(rAngle));
+    draw_list->AddRectFilled(p - size, p + size, (registry.get(i).kind == EXTRA_STAR ? starCol : astCol));
+    if(mHover)
+      {
+        Vec2f d = p - mp;
+        float dist2 = d.x*d.x + d.y*d.y;
+        if(dist2 < hDist) { hDist = dist2; hovered = i; }
+      }
+  });
+
+  if(hovered >= 0)
+    {
+      double oAngle  = extras.angle[hovered];
+      int    oSign   = chart->getSign(oAngle);
+      double oDegree = oAngle - chart->getSignCusp(oSign);
+      ImGui::BeginTooltip();
+      ImGui::Text("%s  %s %s", registry.get(hovered).name.c_str(), getSignName(oSign).c_str(), angle_string(oDegree, true, false).c_str());
+      ImGui::EndTooltip();
+    }
+}
+
 void ChartView::renderObjects(Chart *chart, int level, const ViewParams &params, ImDrawList *draw_list, const ChartParams &chartParams)
 {
   Vec2f cc = params.center; // shorthand
@@ -712,6 +759,9 @@ void ChartView::renderObjects(Chart *chart, int level, const ViewParams &params,
         }
     }
   
+  // draw registry objects (asteroids/fixed stars)
+  renderExtraObjects(chart, level, params, draw_list);
+  
   // draw objects
   for(int i = 0; i < chart->objects().size(); i++)
     {
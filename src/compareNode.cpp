@@ -4,6 +4,10 @@ using namespace astro;
 #include "imgui.h"
 #include "glfwKeys.hpp"
 #include "tools.hpp"
+#include "nodeGraph.hpp"
+#include "ephemerisPool.hpp"
+
+#include <algorithm>
 
 CompareNode::CompareNode()
   : Node(CONNECTOR_INPUTS(), CONNECTOR_OUTPUTS(), "Compare Node"), mCompare(new ChartCompare())
@@ -88,29 +92,177 @@ void CompareNode::onUpdate()
 { }
 
 
+void CompareNode::updateGroup()
+{
+  // collect chart outputs of every node in graph (ordered by node id)
+  std::vector<Node*> nodes;
+  if(mGraph)
+    {
+      for(auto &iter : mGraph->getNodes()) { nodes.push_back(iter.second); }
+    }
+  std::sort(nodes.begin(), nodes.end(), [](Node *n1, Node *n2) { return n1->id() < n2->id(); });
+
+  static const std::string chartType = Connector<Chart>().type();
+  std::vector<Chart*> charts;
+  mGroupNames.clear();
+  for(auto n : nodes)
+    {
+      for(auto out : n->outputs())
+        {
+          Chart *chart = (out->type() == chartType ? out->get<Chart>() : nullptr);
+          if(chart && std::find(charts.begin(), charts.end(), chart) == charts.end())
+            {
+              charts.push_back(chart);
+              mGroupNames.push_back(n->name() + " (" + std::to_string(n->id()) + ")");
+            }
+        }
+    }
+  mMatrix.setCharts(charts);
+  mMatrix.update(mParams, &EphemerisPool::global()); // (only changed cells recalculated)
+}
+
+void CompareNode::clampGroupPair()
+{
+  int k = mMatrix.size();
+  mGroupOuter = std::max(0, std::min(mGroupOuter, k-1));
+  mGroupInner = std::max(0, std::min(mGroupInner, k-1));
+  if(mGroupOuter == mGroupInner && k > 1) { mGroupInner = (mGroupOuter + 1) % k; } // (diagonal is empty)
+}
+
+void CompareNode::drawGroup()
+{
+  float scale = getScale();
+  int k = mMatrix.size();
+  if(k < 2)
+    {
+      ImGui::TextUnformatted("(group mode needs at least 2 charts in graph)");
+      return;
+    }
+  clampGroupPair();
+
+  // pair selection (chart can't be compared with itself)
+  ImGui::SetNextItemWidth(240*scale);
+  if(ImGui::BeginCombo("Outer##groupOuter", mGroupNames[mGroupOuter].c_str()))
+    {
+      ImGui::SetWindowFontScale(scale);
+      for(int i = 0; i < k; i++)
+        {
+          if(i == mGroupInner) { continue; }
+          if(ImGui::Selectable(mGroupNames[i].c_str(), i == mGroupOuter)) { mGroupOuter = i; }
+        }
+      ImGui::EndCombo();
+    }
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(240*scale);
+  if(ImGui::BeginCombo("Inner##groupInner", mGroupNames[mGroupInner].c_str()))
+    {
+      ImGui::SetWindowFontScale(scale);
+      for(int i = 0; i < k; i++)
+        {
+          if(i == mGroupOuter) { continue; }
+          if(ImGui::Selectable(mGroupNames[i].c_str(), i == mGroupInner)) { mGroupInner = i; }
+        }
+      ImGui::EndCombo();
+    }
+
+  // score matrix (click a cell to select pair)
+  if(ImGui::CollapsingHeader("scores"))
+    {
+      // inner charts split into pages of columns
+      int pages = (k + COMPARENODE_SCORE_COLUMNS - 1) / COMPARENODE_SCORE_COLUMNS;
+      mScorePage = std::max(0, std::min(mScorePage, pages-1));
+      int j0 = mScorePage*COMPARENODE_SCORE_COLUMNS;
+      int j1 = std::min(k, j0 + COMPARENODE_SCORE_COLUMNS);
+      if(pages > 1)
+        {
+          if(ImGui::ArrowButton("##scorePrev", ImGuiDir_Left))  { mScorePage = std::max(0, mScorePage-1); }
+          ImGui::SameLine();
+          if(ImGui::ArrowButton("##scoreNext", ImGuiDir_Right)) { mScorePage = std::min(pages-1, mScorePage+1); }
+          ImGui::SameLine();
+          ImGui::Text("inner charts %d-%d of %d", j0+1, j1, k);
+        }
+      
+      if(ImGui::BeginTable("##groupScores", (j1-j0)+1, ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY,
+                           Vec2f(0.0f, std::min(k+1, 12)*ImGui::GetFrameHeightWithSpacing())))
+        {
+          ImGui::TableSetupScrollFreeze(1, 1);
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn(); ImGui::TextUnformatted("outer \\ inner");
+          for(int j = j0; j < j1; j++)
+            { ImGui::TableNextColumn(); ImGui::TextUnformatted(mGroupNames[j].c_str()); }
+          ImGuiListClipper clipper; // (only visible rows drawn)
+          clipper.Begin(k);
+          while(clipper.Step())
+            {
+              for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                {
+                  ImGui::TableNextRow();
+                  ImGui::TableNextColumn(); ImGui::TextUnformatted(mGroupNames[i].c_str());
+                  for(int j = j0; j < j1; j++)
+                    {
+                      ImGui::TableNextColumn();
+                      if(i == j) { ImGui::TextUnformatted("-"); continue; }
+                      const SynastryScore &score = mMatrix.score(i, j);
+                      float b = score.balance(); // (green --> harmonious, red --> tense)
+                      ImGui::PushStyleColor(ImGuiCol_Text, Vec4f(0.6f - 0.4f*b, 0.6f + 0.4f*b, 0.4f, 1.0f));
+                      std::string label = (std::to_string(score.count) + " / " + to_string(score.strength, 1) +
+                                           "##cell" + std::to_string(i) + "-" + std::to_string(j));
+                      if(ImGui::Selectable(label.c_str(), (i == mGroupOuter && j == mGroupInner)))
+                        { mGroupOuter = i; mGroupInner = j; }
+                      ImGui::PopStyleColor();
+                      if(ImGui::IsItemHovered())
+                        {
+                          ImGui::BeginTooltip();
+                          ImGui::Text("%s --> %s", mGroupNames[i].c_str(), mGroupNames[j].c_str());
+                          ImGui::Text("aspects: %d  (strength %.2f)", score.count, score.strength);
+                          ImGui::Text("harmony: %.2f  tension: %.2f", score.harmony(), score.tension());
+                          ImGui::EndTooltip();
+                        }
+                    }
+                }
+            }
+          ImGui::EndTable();
+        }
+    }
+}
+
+
 void CompareNode::onDraw()
 {
   float scale = getScale();
+
+  ImGui::Checkbox("Group", &mGroupMode);
+  ImGui::SameLine();
   
-  Chart *iChart = inputs()[COMPARENODE_INPUT_CHART_INNER]->get<Chart>();
-  Chart *oChart = inputs()[COMPARENODE_INPUT_CHART_OUTER]->get<Chart>();
-
-  bool changed = false;
-  if(oChart != mCompare->getOuterChart())
-    { mCompare->setOuterChart(oChart); changed = true; }
-  if(iChart != mCompare->getInnerChart())
-    { mCompare->setInnerChart(iChart); changed = true; }
-
-  if((oChart && ((oChart->date() != mDateOuter) || (oChart->location() != mLocOuter))) ||
-     (iChart && ((iChart->date() != mDateInner) || (iChart->location() != mLocInner))))
-    { changed = true; }
-  
-  if(changed) { mCompare->update(); changed = false; }
+  Chart *iChart = nullptr;
+  Chart *oChart = nullptr;
+  if(mGroupMode)
+    {
+      updateGroup();
+      if(mMatrix.size() >= 2)
+        {
+          clampGroupPair();
+          oChart = mMatrix.chart(mGroupOuter);
+          iChart = mMatrix.chart(mGroupInner);
+        }
+    }
+  else
+    {
+      iChart = inputs()[COMPARENODE_INPUT_CHART_INNER]->get<Chart>();
+      oChart = inputs()[COMPARENODE_INPUT_CHART_OUTER]->get<Chart>();
+    }
+
+  mCompare->setOuterChart(oChart);
+  mCompare->setInnerChart(iChart);
+  mCompare->update(); // (version check -- picks up changes to either chart)
+  if(mGroupMode && oChart && iChart)
+    { mCompare->setAspects(mParams, mMatrix.aspects(mGroupOuter, mGroupInner)); } // (selected pair from matrix)
   
   ImGui::Text("Chart Size:  "); // size of chart area
   ImGui::SameLine();
   ImGui::SetNextItemWidth(360*scale);
   ImGui::SliderFloat("##chartWidth", &mChartWidth, CHART_SIZE_MIN, CHART_SIZE_MAX, "%.0f"); // Minimal displayed value is 5%
+  if(mGroupMode) { drawGroup(); }
 
   // draw chart view
   mView.draw(mCompare, mChartWidth*scale, isBlocked(), mParams);
@@ -0,0 +1,254 @@
+#include "connectionRouter.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <algorithm>
+
+#include "node.hpp"
+
+
+// true if p is strictly inside r
+static bool inside(const Rect2f &r, const Vec2f &p)
+{ return (p.x > r.p1.x && p.x < r.p2.x && p.y > r.p1.y && p.y < r.p2.y); }
+
+// removes repeated points and points in the middle of straight segments
+static void simplify(std::vector<Vec2f> &path)
+{
+  std::vector<Vec2f> result;
+  for(const auto &p : path)
+    {
+      if(!result.empty() && result.back() == p) { continue; }
+      if(result.size() > 1)
+        {
+          const Vec2f &a = result[result.size()-2];
+          const Vec2f &b = result.back();
+          if((a.x == b.x && b.x == p.x) || (a.y == b.y && b.y == p.y)) { result.back() = p; continue; }
+        }
+      result.push_back(p);
+    }
+  path.swap(result);
+}
+
+
+std::vector<Vec2f> ConnectionRouter::simplePath(const Vec2f &start, const Vec2f &end)
+{
+  std::vector<Vec2f> path;
+  path.push_back(start);
+  Vec2f avg = (start + end)/2.0f;
+  if(start.x+ORTHO_PADDING.x <= end.x-ORTHO_PADDING.x && std::abs(start.y - end.y) > 1.0f)
+    { // forward -- one vertical segment in between
+      path.push_back(Vec2f(avg.x, start.y));
+      path.push_back(Vec2f(avg.x, end.y));
+    }
+  else if(end.x-ORTHO_PADDING.x <= start.x+ORTHO_PADDING.x)
+    { // backward -- loop back between the nodes
+      Vec2f offsetStart = start + Vec2f(ORTHO_PADDING.x, 0);
+      Vec2f offsetEnd   = end   - Vec2f(ORTHO_PADDING.x, 0);
+      path.push_back(offsetStart);
+      path.push_back(Vec2f(offsetStart.x, avg.y));
+      path.push_back(Vec2f(offsetEnd.x, avg.y));
+      path.push_back(offsetEnd);
+    }
+  path.push_back(end);
+  return path;
+}
+
+// collects obstacle rects intersecting area (padded -- rects containing either exit point are ignored)
+void ConnectionRouter::gather(const Rect2f &area, const Vec2f &exitStart, const Vec2f &exitEnd, std::vector<Rect2f> &obstacles) const
+{
+  std::vector<int> ids;
+  mObstacles.query(area, ids);
+  obstacles.clear();
+  for(auto id : ids)
+    {
+      Rect2f r = mObstacles.getRect(id)->expanded(ORTHO_NODE_PADDING);
+      if(!inside(r, exitStart) && !inside(r, exitEnd)) { obstacles.push_back(r); }
+    }
+}
+
+// true if any path segment crosses an obstacle (first/last segments only checked past connector stubs)
+bool ConnectionRouter::blocked(const std::vector<Vec2f> &path, const Vec2f &exitStart, const Vec2f &exitEnd, const std::vector<Rect2f> &obstacles) const
+{
+  for(int i = 0; i < (int)path.size()-1; i++)
+    {
+      Vec2f a = (i == 0 ? exitStart : path[i]);
+      Vec2f b = (i == (int)path.size()-2 ? exitEnd : path[i+1]);
+      Rect2f seg = Rect2f(a, b).fixed();
+      for(const auto &r : obstacles)
+        {
+          if(seg.p1.x < r.p2.x && seg.p2.x > r.p1.x && seg.p1.y < r.p2.y && seg.p2.y > r.p1.y)
+            { return true; }
+        }
+    }
+  return false;
+}
+
+// shortest orthogonal path (length + corners) from start to end over grid lines through obstacle edges
+//  - leaves start and arrives at end horizontally (continuing connector stubs)
+bool ConnectionRouter::searchGrid(const Vec2f &start, const Vec2f &end, const std::vector<Rect2f> &obstacles, std::vector<Vec2f> &path) const
+{
+  Rect2f bounds = Rect2f(start, end).fixed();
+  for(const auto &r : obstacles) { bounds = bounds.combined(r); }
+  bounds = bounds.expanded(ORTHO_NODE_PADDING);
+
+  std::vector<float> xs = { start.x, end.x, (start.x + end.x)/2.0f, bounds.p1.x, bounds.p2.x };
+  std::vector<float> ys = { start.y, end.y, (start.y + end.y)/2.0f, bounds.p1.y, bounds.p2.y };
+  for(const auto &r : obstacles)
+    {
+      xs.push_back(r.p1.x); xs.push_back(r.p2.x);
+      ys.push_back(r.p1.y); ys.push_back(r.p2.y);
+    }
+  std::sort(xs.begin(), xs.end()); xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  std::sort(ys.begin(), ys.end()); ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+  auto xIndex = [&xs](float x) { return (int)(std::lower_bound(xs.begin(), xs.end(), x) - xs.begin()); };
+  auto yIndex = [&ys](float y) { return (int)(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin()); };
+  int nx = xs.size();
+  int ny = ys.size();
+
+  // block grid edges inside obstacles (edges along obstacle borders stay open)
+  std::vector<char> hBlocked(nx*ny, 0); // (i,j) --> (i+1,j)
+  std::vector<char> vBlocked(nx*ny, 0); // (i,j) --> (i,j+1)
+  for(const auto &r : obstacles)
+    {
+      int i1 = xIndex(r.p1.x), i2 = xIndex(r.p2.x);
+      int j1 = yIndex(r.p1.y), j2 = yIndex(r.p2.y);
+      for(int j = j1+1; j < j2; j++)
+        for(int i = i1; i < i2; i++) { hBlocked[j*nx + i] = 1; }
+      for(int j = j1; j < j2; j++)
+        for(int i = i1+1; i < i2; i++) { vBlocked[j*nx + i] = 1; }
+    }
+
+  // dijkstra over (grid point, axis of last segment)
+  const float INF = std::numeric_limits<float>::infinity();
+  std::vector<float> cost(nx*ny*2, INF);
+  std::vector<int>   prev(nx*ny*2, -1);
+  typedef std::pair<float, int> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+  int startState = (yIndex(start.y)*nx + xIndex(start.x))*2;
+  int endPoint   = yIndex(end.y)*nx + xIndex(end.x);
+  cost[startState] = 0.0f;
+  queue.push(Item(0.0f, startState));
+  auto relax = [&](int state, float c, int from)
+  {
+    if(c < cost[state]) { cost[state] = c; prev[state] = from; queue.push(Item(c, state)); }
+  };
+  while(!queue.empty())
+    {
+      Item item = queue.top(); queue.pop();
+      float c = item.first;
+      int state = item.second;
+      if(c > cost[state]) { continue; }
+      int p = state/2, axis = state%2;
+      if(p == endPoint)
+        {
+          if(axis == 0) { break; }
+          relax(endPoint*2, c + ORTHO_BEND_COST, state); // (turn into end stub)
+          continue;
+        }
+      int i = p % nx, j = p / nx;
+      float hBend = (axis != 0 ? ORTHO_BEND_COST : 0.0f);
+      float vBend = (axis != 1 ? ORTHO_BEND_COST : 0.0f);
+      if(i+1 < nx && !hBlocked[j*nx + i])     { relax((p+1)*2,    c + (xs[i+1] - xs[i]) + hBend, state); }
+      if(i > 0    && !hBlocked[j*nx + i-1])   { relax((p-1)*2,    c + (xs[i] - xs[i-1]) + hBend, state); }
+      if(j+1 < ny && !vBlocked[j*nx + i])     { relax((p+nx)*2+1, c + (ys[j+1] - ys[j]) + vBend, state); }
+      if(j > 0    && !vBlocked[(j-1)*nx + i]) { relax((p-nx)*2+1, c + (ys[j] - ys[j-1]) + vBend, state); }
+    }
+  if(cost[endPoint*2] == INF) { return false; }
+
+  path.clear();
+  for(int state = endPoint*2; state >= 0; state = prev[state])
+    { path.push_back(Vec2f(xs[(state/2) % nx], ys[(state/2) / nx])); }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
+
+std::vector<Vec2f> ConnectionRouter::findPath(const Vec2f &start, const Vec2f &end) const
+{
+  std::vector<Vec2f> path = simplePath(start, end);
+  Vec2f exitStart = start + Vec2f(ORTHO_PADDING.x, 0.0f);
+  Vec2f exitEnd   = end   - Vec2f(ORTHO_PADDING.x, 0.0f);
+
+  // keep simple path if clear
+  Rect2f area = Rect2f(exitStart, exitEnd).fixed().expanded(ORTHO_PADDING);
+  std::vector<Rect2f> obstacles;
+  gather(area, exitStart, exitEnd, obstacles);
+  if(!blocked(path, exitStart, exitEnd, obstacles)) { return path; }
+
+  // include obstacles around the ones in the way (detours go around them)
+  for(const auto &r : obstacles) { area = area.combined(r.expanded(ORTHO_PADDING)); }
+  gather(area, exitStart, exitEnd, obstacles);
+  std::vector<Vec2f> points;
+  if(obstacles.size() > ORTHO_MAX_OBSTACLES || !searchGrid(exitStart, exitEnd, obstacles, points))
+    { return path; } // (too crowded or no way around -- fall back to simple path)
+
+  path.clear();
+  path.push_back(start);
+  path.insert(path.end(), points.begin(), points.end());
+  path.push_back(end);
+  simplify(path);
+  return path;
+}
+
+
+void ConnectionRouter::remove(const Key &key)
+{
+  auto iter = mRoutes.find(key);
+  if(iter != mRoutes.end())
+    {
+      mRouteIndex.remove(iter->second.id);
+      mRouteKeys.erase(iter->second.id);
+      mRoutes.erase(iter);
+    }
+}
+
+const std::vector<Vec2f>& ConnectionRouter::get(const ConnectorBase *out, const ConnectorBase *in, const Vec2f &start, const Vec2f &end)
+{
+  Key key(out, in);
+  auto iter = mRoutes.find(key);
+  if(iter != mRoutes.end())
+    {
+      if(iter->second.start == start && iter->second.end == end) { return iter->second.path; }
+      remove(key); // (endpoint moved)
+    }
+
+  Route route;
+  route.id    = mNextId++;
+  route.start = start;
+  route.end   = end;
+  route.path  = findPath(start, end);
+  mFoundCount++;
+  Rect2f bounds(route.path[0], route.path[0]);
+  for(const auto &p : route.path) { bounds = bounds.combined(p); }
+  mRouteIndex.insert(route.id, bounds);
+  mRouteKeys.emplace(route.id, key);
+  return mRoutes.emplace(key, std::move(route)).first->second.path;
+}
+
+void ConnectionRouter::obstacleMoved(const Rect2f &oldRect, const Rect2f &newRect)
+{
+  if(oldRect.p1 == newRect.p1 && oldRect.p2 == newRect.p2) { return; }
+  std::vector<int> ids;
+  mRouteIndex.query(oldRect.expanded(ORTHO_NODE_PADDING), ids);
+  mRouteIndex.query(newRect.expanded(ORTHO_NODE_PADDING), ids);
+  for(auto id : ids)
+    {
+      auto iter = mRouteKeys.find(id);
+      if(iter != mRouteKeys.end()) { remove(iter->second); } // (ids may repeat)
+    }
+}
+
+void ConnectionRouter::prune(const std::function<bool(const ConnectorBase *out, const ConnectorBase *in)> &drop)
+{
+  std::vector<Key> dropped;
+  for(const auto &r : mRoutes) { if(drop(r.first.first, r.first.second)) { dropped.push_back(r.first); } }
+  for(const auto &key : dropped) { remove(key); }
+}
+
+void ConnectionRouter::clear()
+{
+  mRoutes.clear();
+  mRouteKeys.clear();
+  mRouteIndex.clear();
+}
@@ -94,8 +94,13 @@ DateTime DateTime::now()
   // calculate milliseconds for sub-second time
   int ms = std::chrono::duration_cast<std::chrono::duration<int,std::milli>>(current - rounded).count();
   
-  tm *local = localtime(&tt);
-  DateTime d(local->tm_year + 1900, local->tm_mon + 1, local->tm_mday, local->tm_hour, local->tm_min, (double)local->tm_sec + (double)ms / 1000.0);
+  tm local; // (reentrant -- may be called from graph worker threads)
+#ifndef _WIN32
+  localtime_r(&tt, &local);
+#else
+  localtime_s(&local, &tt);
+#endif
+  DateTime d(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, (double)local.tm_sec + (double)ms / 1000.0);
 
   auto zoned = date::make_zoned(date::current_zone(), current);
   int offset = zoned.get_info().offset.count();
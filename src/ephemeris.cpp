@@ -5,6 +5,8 @@ using namespace astro;
 #include <iostream>
 #include <iomanip>
 
+#include "ephemerisFiles.hpp"
+
 
 const std::vector<int> Ephemeris::SWE_IDS = { SE_SUN, SE_MOON,
                                               SE_MERCURY, SE_VENUS, SE_MARS, SE_JUPITER, SE_SATURN, SE_URANUS, SE_NEPTUNE, SE_PLUTO, 60000,//SE_QUAOAR,
@@ -12,6 +14,7 @@ const std::vector<int> Ephemeris::SWE_IDS = { SE_SUN, SE_MOON,
                                               SE_MEAN_APOG,           // (Dark Moon Lilith)
                                               (SE_AST_OFFSET + 19),   // (Fortuna)
                                               SE_TRUE_NODE, SE_TRUE_NODE }; // (south node calculated from north node)
+std::atomic<bool> Ephemeris::mMemoryMapped(false);
 
 Ephemeris::Ephemeris()
 {
@@ -19,10 +22,28 @@ Ephemeris::Ephemeris()
   swe_set_ephe_path(ephemPath);
 }
 
+void Ephemeris::setMemoryMapped(bool state)
+{
+  if(state && !EphemerisFiles::supported())
+    { std::cout << "WARNING: Ephemeris::setMemoryMapped() --> memory-mapped files not supported on this platform\n"; return; }
+  if(state == mMemoryMapped) { return; }
+  mMemoryMapped = state;
+  swe_set_fopen_func(state ? &EphemerisFiles::open : nullptr);
+  swe_set_fmap_func(state ? &EphemerisFiles::data : nullptr);
+
+  // reset path (closes files opened by this thread)
+  char ephemPath[512] = EPHEM_PATH;
+  swe_set_ephe_path(ephemPath);
+}
+
+bool Ephemeris::getMemoryMapped()
+{ return mMemoryMapped; }
+
 void Ephemeris::setDate(const DateTime &dt)
 {
-  mJulDay_et = getJulianDayET(dt, mLocation);
-  mJulDay_ut = getJulianDayUT(dt, mLocation);
+  JulianDay jd = getJulianDays(dt);
+  mJulDay_et = jd.et;
+  mJulDay_ut = jd.ut;
 }
 
 void Ephemeris::setLocation(const Location &loc)
@@ -30,12 +51,14 @@ void Ephemeris::setLocation(const Location &loc)
   mLocation = loc;
 }
 
-double Ephemeris::getJulianDayUT(const DateTime &dt, const Location &loc)
+JulianDay Ephemeris::getJulianDays(const DateTime &dt) const
 {
+  for(const auto &memo : mJulDayMemo)
+    { if(memo.valid && memo.dt == dt) { return memo.jd; } }
+  
   // calculate timezone offset
   double d_timezone = dt.utcOffset()+dt.dstOffset();
   int y, mo, d, h, mi; double s;
-  swe_set_topo(loc.longitude, loc.latitude, loc.altitude);
   swe_utc_time_zone(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(), d_timezone, &y, &mo, &d, &h, &mi, &s);
   
   // compute julian day
@@ -43,28 +66,24 @@ double Ephemeris::getJulianDayUT(const DateTime &dt, const Location &loc)
   double dret[2];
   int ret = swe_utc_to_jd(y, mo, d, h, mi, s, SE_GREG_CAL, dret, serr);
   if(ret < 0) { std::cout << "SWE ERROR: " << serr << "\n"; }
-  
-  return dret[1];
+
+  JulianDayMemo &memo = mJulDayMemo[mJulDayMemoNext];
+  mJulDayMemoNext = (mJulDayMemoNext + 1) % JULDAY_MEMO_SIZE;
+  memo.dt    = dt;
+  memo.jd.et = dret[0];
+  memo.jd.ut = dret[1];
+  memo.valid = (ret >= 0);
+  return memo.jd;
 }
 
-double Ephemeris::getJulianDayET(const DateTime &dt, const Location &loc)
+DateTime Ephemeris::getDateET(double jdEt) const
 {
-  // calculate timezone offset
-  double d_timezone = dt.utcOffset()+dt.dstOffset();
   int y, mo, d, h, mi; double s;
-  swe_set_topo(loc.longitude, loc.latitude, loc.altitude);
-  swe_utc_time_zone(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(), d_timezone, &y, &mo, &d, &h, &mi, &s);
-  
-  // compute julian day
-  char serr[AS_MAXCH];
-  double dret[2];
-  int ret = swe_utc_to_jd(y, mo, d, h, mi, s, SE_GREG_CAL, dret, serr);
-  if(ret < 0) { std::cout << "SWE ERROR: " << serr << "\n"; }
-  
-  return dret[0];
+  swe_jdet_to_utc(jdEt, SE_GREG_CAL, &y, &mo, &d, &h, &mi, &s);
+  return DateTime(y, mo, d, h, mi, s, 0.0);
 }
 
-DateTime Ephemeris::getProgressed(const DateTime &ndt, const Location &nloc, const DateTime &tdt, const Location &tloc)
+DateTime Ephemeris::getProgressed(const DateTime &ndt, const Location &nloc, const DateTime &tdt, const Location &tloc) const
 {
   // transit-natal differences
   double jdNatal   = getJulianDayUT(ndt, nloc);
@@ -82,7 +101,7 @@ DateTime Ephemeris::getProgressed(const DateTime &ndt, const Location &nloc, con
     }
 }
 
-DateTime Ephemeris::getUnprogressed(const DateTime &ndt, const Location &nloc, const DateTime &pdt, const Location &ploc)
+DateTime Ephemeris::getUnprogressed(const DateTime &ndt, const Location &nloc, const DateTime &pdt, const Location &ploc) const
 {
   // transit-natal differences
   double jdNatal = getJulianDayUT(ndt, nloc);
@@ -169,6 +188,50 @@ ObjData Ephemeris::getObjData(ObjType o) const
   return objData;
 }
 
+int Ephemeris::calcObjects(double jdEt, const ObjMask &mask, long flags, ObjDataArray &out) const
+{
+  // set geographic position for calculations (once for all objects)
+  swe_set_topo(mLocation.longitude, mLocation.latitude, mLocation.altitude);
+
+  int count = 0;
+  double data[6];
+  char serr[AS_MAXCH];
+  for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+    {
+      out.valid[o] = false;
+      if(!mask[o]) { continue; }
+      
+      bool valid = true;
+      if(o == OBJ_SOUTHNODE && out.valid[OBJ_NORTHNODE])
+        { // reuse north node (same swe object)
+          data[0] = out.longitude[OBJ_NORTHNODE]; data[1] = out.latitude[OBJ_NORTHNODE]; data[2] = out.distance[OBJ_NORTHNODE];
+          data[3] = out.lonSpeed[OBJ_NORTHNODE];  data[4] = out.latSpeed[OBJ_NORTHNODE]; data[5] = out.distSpeed[OBJ_NORTHNODE];
+        }
+      else if(swe_calc(jdEt, SWE_IDS[o], flags, data, serr) < 0)
+        {
+          std::cout << "SWE ERROR: " << serr << "\n";
+          std::fill(data, data+6, 0.0);
+          valid = false;
+        }
+      
+      if(o == OBJ_SOUTHNODE)
+        { // calculate south lunar node from true node
+          data[1] *= -1;
+          data[0] = fmod(data[0]+180.0, 360.0);
+          data[4] *= -1;
+        }
+      out.longitude[o] = data[0];
+      out.latitude[o]  = data[1];
+      out.distance[o]  = data[2];
+      out.lonSpeed[o]  = data[3];
+      out.latSpeed[o]  = data[4];
+      out.distSpeed[o] = data[5];
+      out.valid[o]     = valid;
+      count += (valid ? 1 : 0);
+    }
+  return count;
+}
+
 double Ephemeris::getAngle(ObjType angle) const
 {
   switch(angle)
@@ -224,9 +287,11 @@ void Ephemeris::printObjects(const astro::DateTime &dt, const astro::Location &l
   std::cout << "|      OBJECT |        ANGLE |     LATITUDE |    LONGITUDE |     DISTANCE |    LAT SPEED |    LON SPEED |   DIST SPEED |\n";
   std::cout << "|             |    (degrees) |    (degrees) |    (degrees) |         (AU) |    (degrees) |    (degrees) |     (AU/day) |\n";
   std::cout << "|=============|==============|==============|==============|==============|==============|==============|==============|\n";
+  ObjDataArray objData;
+  calcObjects(ObjMask().set(), objData);
   for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
     {
-      ObjData obj = getObjData((ObjType)o);
+      ObjData obj = objData.get((ObjType)o);
       double angle = obj.longitude;
       std::string name = getObjName((ObjType)o);
       std::cout << std::fixed << std::setprecision(6)
@@ -0,0 +1,280 @@
+#include "ephemerisCache.hpp"
+using namespace astro;
+
+#include <cmath>
+
+
+// Chebyshev-Lobatto nodes on [-1, 1] (ascending -- includes endpoints so adjacent segments agree)
+//  (static initializers -- thread-safe when first called from pool/graph workers)
+static std::array<double, CHEBY_NODES> calcChebyNodes()
+{
+  std::array<double, CHEBY_NODES> nodes;
+  for(int i = 0; i < CHEBY_NODES; i++)
+    { nodes[i] = -std::cos(M_PI*i/(CHEBY_NODES-1)); }
+  return nodes;
+}
+static const std::array<double, CHEBY_NODES>& chebyNodes()
+{
+  static const std::array<double, CHEBY_NODES> nodes = calcChebyNodes();
+  return nodes;
+}
+
+// inverse of the Hermite interpolation matrix (rows: T_k(x_i), then T_k'(x_i))
+//  --> coefficients = M^-1 * [values, derivatives]
+static std::array<std::array<double, CHEBY_COEFFS>, CHEBY_COEFFS> calcChebyInverse()
+{
+  std::array<std::array<double, CHEBY_COEFFS>, CHEBY_COEFFS> inv;
+  const auto &nodes = chebyNodes();
+  std::array<std::array<double, 2*CHEBY_COEFFS>, CHEBY_COEFFS> m; // augmented [M | I]
+  for(int i = 0; i < CHEBY_NODES; i++)
+    {
+      double x = nodes[i];
+      double t0 = 1.0, t1 = x; // T_k(x)
+      double d0 = 0.0, d1 = 1.0; // T_k'(x)
+      for(int k = 0; k < CHEBY_COEFFS; k++)
+        {
+          m[i][k]             = (k == 0 ? t0 : t1);
+          m[i+CHEBY_NODES][k] = (k == 0 ? d0 : d1);
+          if(k > 0)
+            {
+              double t2 = 2.0*x*t1 - t0;
+              double d2 = 2.0*t1 + 2.0*x*d1 - d0;
+              t0 = t1; t1 = t2; d0 = d1; d1 = d2;
+            }
+        }
+    }
+  for(int r = 0; r < CHEBY_COEFFS; r++)
+    { for(int c = 0; c < CHEBY_COEFFS; c++) { m[r][CHEBY_COEFFS+c] = (r == c ? 1.0 : 0.0); } }
+
+  // gauss-jordan elimination (partial pivoting)
+  for(int c = 0; c < CHEBY_COEFFS; c++)
+    {
+      int pivot = c;
+      for(int r = c+1; r < CHEBY_COEFFS; r++)
+        { if(std::abs(m[r][c]) > std::abs(m[pivot][c])) { pivot = r; } }
+      std::swap(m[c], m[pivot]);
+      double p = m[c][c];
+      for(auto &v : m[c]) { v /= p; }
+      for(int r = 0; r < CHEBY_COEFFS; r++)
+        {
+          if(r == c) { continue; }
+          double f = m[r][c];
+          for(int k = 0; k < 2*CHEBY_COEFFS; k++) { m[r][k] -= f*m[c][k]; }
+        }
+    }
+  for(int r = 0; r < CHEBY_COEFFS; r++)
+    { for(int c = 0; c < CHEBY_COEFFS; c++) { inv[r][c] = m[r][CHEBY_COEFFS+c]; } }
+  return inv;
+}
+static const std::array<std::array<double, CHEBY_COEFFS>, CHEBY_COEFFS>& chebyInverse()
+{
+  static const std::array<std::array<double, CHEBY_COEFFS>, CHEBY_COEFFS> inv = calcChebyInverse();
+  return inv;
+}
+
+// evaluates a chebyshev series and its derivative at x (clenshaw recurrence)
+static inline void chebyEval(const std::array<double, CHEBY_COEFFS> &c, double x, double &val, double &deriv)
+{
+  double b1 = 0.0, b2 = 0.0; // value
+  double d1 = 0.0, d2 = 0.0; // derivative
+  for(int k = CHEBY_COEFFS-1; k >= 1; k--)
+    {
+      double b0 = 2.0*x*b1 - b2 + c[k];
+      double d0 = 2.0*x*d1 - d2 + 2.0*b1;
+      b2 = b1; b1 = b0;
+      d2 = d1; d1 = d0;
+    }
+  val   = x*b1 - b2 + c[0];
+  deriv = x*d1 - d2 + b1;
+}
+
+
+EphemerisCache::EphemerisCache(double maxError)
+  : mMaxError(maxError)
+{ }
+
+void EphemerisCache::setParams(const Location &loc, long sweFlags)
+{
+  if(loc != mLocation || sweFlags != mSweFlags)
+    {
+      clear();
+      mLocation = loc;
+      mSweFlags = sweFlags;
+      mSwe.setLocation(mLocation);
+    }
+}
+
+void EphemerisCache::clear()
+{
+  for(auto &cells : mCells) { cells.clear(); }
+  mCellCount = 0;
+  mFitError  = 0.0;
+}
+
+bool EphemerisCache::fitSegment(Ephemeris &swe, ObjType o, double jd0, double jd1, Segment &seg, double &error) const
+{
+  const auto &nodes = chebyNodes();
+  const auto &inv   = chebyInverse();
+  double mid  = (jd0 + jd1)/2.0;
+  double half = (jd1 - jd0)/2.0;
+
+  ObjMask mask; mask.set(o);
+  ObjDataArray data;
+  std::array<double, CHEBY_COEFFS> rLon, rLat, rDist; // [values, derivatives (per unit x)]
+  for(int i = 0; i < CHEBY_NODES; i++)
+    {
+      if(swe.calcObjects(mid + half*nodes[i], mask, mSweFlags, data) == 0) { return false; }
+      double lon = data.longitude[o];
+      if(i > 0)
+        { // unwrap longitude -- choose branch closest to prediction from speeds
+          double dt = half*(nodes[i] - nodes[i-1]);
+          double predicted = rLon[i-1] + 0.5*(rLon[CHEBY_NODES+i-1]/half + data.lonSpeed[o])*dt;
+          lon += 360.0*std::round((predicted - lon)/360.0);
+        }
+      rLon[i]  = lon;                 rLon[CHEBY_NODES+i]  = data.lonSpeed[o]*half;
+      rLat[i]  = data.latitude[o];    rLat[CHEBY_NODES+i]  = data.latSpeed[o]*half;
+      rDist[i] = data.distance[o];    rDist[CHEBY_NODES+i] = data.distSpeed[o]*half;
+    }
+
+  seg.jdStart = jd0;
+  seg.jdEnd   = jd1;
+  for(int k = 0; k < CHEBY_COEFFS; k++)
+    {
+      double cLon = 0.0, cLat = 0.0, cDist = 0.0;
+      for(int j = 0; j < CHEBY_COEFFS; j++)
+        {
+          cLon  += inv[k][j]*rLon[j];
+          cLat  += inv[k][j]*rLat[j];
+          cDist += inv[k][j]*rDist[j];
+        }
+      seg.lon[k] = cLon; seg.lat[k] = cLat; seg.dist[k] = cDist;
+    }
+
+  // verify between nodes
+  double maxErr = 0.0;
+  for(int i = 0; i < 2*(CHEBY_NODES-1); i++)
+    {
+      double x = nodes[i/2] + (nodes[i/2+1] - nodes[i/2])*(i%2 == 0 ? 1.0/3.0 : 2.0/3.0);
+      if(swe.calcObjects(mid + half*x, mask, mSweFlags, data) == 0) { return false; }
+      double lon, lat, deriv;
+      chebyEval(seg.lon, x, lon, deriv);
+      chebyEval(seg.lat, x, lat, deriv);
+      maxErr = std::max(maxErr, std::abs(angleDiffDegrees(fmod(lon, 360.0) + (lon < 0.0 ? 360.0 : 0.0), data.longitude[o])));
+      maxErr = std::max(maxErr, std::abs(lat - data.latitude[o]));
+    }
+  if(maxErr > CHEBY_CHECK_MARGIN*mMaxError) { return false; }
+  error = std::max(error, maxErr);
+  return true;
+}
+
+EphemerisCache::Cell EphemerisCache::fitCell(Ephemeris &swe, ObjType o, long index, double &error) const
+{
+  Cell cell;
+  double jd0 = index*CHEBY_CELL_DAYS;
+  for(int depth = 0; depth <= CHEBY_MAX_SPLIT; depth++)
+    { // split cell until every segment is within error bound
+      int n = (1 << depth);
+      double span = CHEBY_CELL_DAYS/n;
+      double err  = 0.0;
+      cell.segments.resize(n);
+      bool success = true;
+      for(int s = 0; s < n && success; s++)
+        { success = fitSegment(swe, o, jd0 + s*span, jd0 + (s+1)*span, cell.segments[s], err); }
+      if(success) { error = std::max(error, err); break; }
+      cell.segments.clear(); // (calculate directly if no fit succeeds)
+    }
+  return cell;
+}
+
+const EphemerisCache::Cell& EphemerisCache::getCell(ObjType o, long index)
+{
+  auto iter = mCells[o].find(index);
+  if(iter != mCells[o].end()) { return iter->second; }
+
+  if(mCellCount >= CHEBY_MAX_CELLS) { clear(); }
+  mCellCount++;
+  return mCells[o].emplace(index, fitCell(mSwe, o, index, mFitError)).first->second;
+}
+
+void EphemerisCache::setWindow(double jdStart, double jdEnd, const ObjMask &mask, EphemerisPool *pool)
+{
+  long i0 = (long)std::floor(std::min(jdStart, jdEnd)/CHEBY_CELL_DAYS);
+  long i1 = (long)std::floor(std::max(jdStart, jdEnd)/CHEBY_CELL_DAYS);
+  if((i1 - i0 + 1)*mask.count() + mCellCount > CHEBY_MAX_CELLS) { clear(); }
+
+  // find missing cells
+  std::vector<std::pair<ObjType, long>> missing;
+  for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+    {
+      if(!mask[o]) { continue; }
+      for(long i = i0; i <= i1; i++)
+        { if(mCells[o].find(i) == mCells[o].end()) { missing.emplace_back((ObjType)o, i); } }
+    }
+  if(missing.empty()) { return; }
+  
+  if(!pool)
+    { for(auto &m : missing) { getCell(m.first, m.second); } }
+  else
+    { // fit cells on worker threads (each with its own ephemeris context)
+      std::vector<Cell>   cells(missing.size());
+      std::vector<double> errors(missing.size(), 0.0);
+      pool->parallel_for(missing.size(), [&](Ephemeris &swe, int i)
+                         {
+                           swe.setLocation(mLocation);
+                           cells[i] = fitCell(swe, missing[i].first, missing[i].second, errors[i]);
+                         });
+      for(int i = 0; i < missing.size(); i++)
+        {
+          mCells[missing[i].first].emplace(missing[i].second, std::move(cells[i]));
+          mFitError = std::max(mFitError, errors[i]);
+        }
+      mCellCount += missing.size();
+    }
+}
+
+int EphemerisCache::calcObjects(double jdEt, const ObjMask &mask, ObjDataArray &out)
+{
+  int count = 0;
+  long index = (long)std::floor(jdEt/CHEBY_CELL_DAYS);
+  ObjMask direct; // objects without a valid fit
+  for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+    {
+      out.valid[o] = false;
+      if(!mask[o]) { continue; }
+
+      const Cell &cell = getCell((ObjType)o, index);
+      if(cell.segments.empty()) { direct.set(o); continue; }
+
+      int n = cell.segments.size();
+      int s = std::min(n-1, std::max(0, (int)((jdEt - index*CHEBY_CELL_DAYS)/(CHEBY_CELL_DAYS/n))));
+      const Segment &seg = cell.segments[s];
+      double half = (seg.jdEnd - seg.jdStart)/2.0;
+      double x    = (jdEt - (seg.jdStart + half))/half;
+
+      double lon, lonSpeed;
+      chebyEval(seg.lon,  x, lon, lonSpeed);
+      chebyEval(seg.lat,  x, out.latitude[o], out.latSpeed[o]);
+      chebyEval(seg.dist, x, out.distance[o], out.distSpeed[o]);
+      lon = fmod(lon, 360.0);
+      out.longitude[o] = (lon < 0.0 ? lon + 360.0 : lon);
+      out.lonSpeed[o]  = lonSpeed/half;
+      out.latSpeed[o]  /= half;
+      out.distSpeed[o] /= half;
+      out.valid[o] = true;
+      count++;
+    }
+
+  if(direct.any())
+    {
+      ObjDataArray data;
+      count += mSwe.calcObjects(jdEt, direct, mSweFlags, data);
+      for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+        {
+          if(!direct[o]) { continue; }
+          out.longitude[o] = data.longitude[o]; out.latitude[o] = data.latitude[o]; out.distance[o]  = data.distance[o];
+          out.lonSpeed[o]  = data.lonSpeed[o];  out.latSpeed[o] = data.latSpeed[o]; out.distSpeed[o] = data.distSpeed[o];
+          out.valid[o]     = data.valid[o];
+        }
+    }
+  return count;
+}
@@ -0,0 +1,89 @@
+#include "ephemerisFiles.hpp"
+using namespace astro;
+
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+EphemerisFiles& EphemerisFiles::instance()
+{
+  static EphemerisFiles files;
+  return files;
+}
+
+bool EphemerisFiles::supported()
+{
+#ifndef _WIN32
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool EphemerisFiles::map(const std::string &path, Mapping &mapping)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto iter = mFiles.find(path);
+  if(iter != mFiles.end()) { mapping = iter->second; return true; }
+
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) { return false; } // (missing files are normal -- swe searches each path)
+  struct stat st;
+  if(fstat(fd, &st) < 0 || st.st_size <= 0) { ::close(fd); return false; }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // (mapping stays valid)
+  if(data == MAP_FAILED)
+    {
+      std::cout << "WARNING: EphemerisFiles --> could not map '" << path << "'\n";
+      return false;
+    }
+  mapping.data = data;
+  mapping.size = st.st_size;
+  mFiles.emplace(path, mapping);
+  return true;
+#else
+  return false;
+#endif
+}
+
+FILE* EphemerisFiles::open(const char *path, const char *mode)
+{
+  Mapping mapping;
+#ifndef _WIN32
+  if(instance().map(path, mapping))
+    {
+      FILE *f = fmemopen(mapping.data, mapping.size, "r");
+      if(f) { return f; }
+    }
+#endif
+  return fopen(path, mode);
+}
+
+const unsigned char* EphemerisFiles::data(const char *path, size_t *size)
+{
+  Mapping mapping;
+  if(!instance().map(path, mapping)) { *size = 0; return nullptr; }
+  *size = mapping.size;
+  return (const unsigned char*)mapping.data;
+}
+
+int EphemerisFiles::fileCount()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mFiles.size();
+}
+
+size_t EphemerisFiles::mappedBytes()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  size_t bytes = 0;
+  for(auto &iter : mFiles) { bytes += iter.second.size; }
+  return bytes;
+}
@@ -0,0 +1,75 @@
+#include "ephemerisPool.hpp"
+using namespace astro;
+
+#include <algorithm>
+
+
+EphemerisPool::EphemerisPool(int numThreads)
+{
+  if(numThreads <= 0) { numThreads = std::max(1u, std::thread::hardware_concurrency()); }
+  for(int i = 0; i < numThreads; i++)
+    { mThreads.emplace_back(&EphemerisPool::workerLoop, this); }
+}
+
+EphemerisPool::~EphemerisPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQuit = true;
+  }
+  mWorkCv.notify_all();
+  for(auto &t : mThreads) { t.join(); }
+}
+
+EphemerisPool& EphemerisPool::global()
+{
+  static EphemerisPool pool;
+  return pool;
+}
+
+void EphemerisPool::workerLoop()
+{
+  Ephemeris swe; // (constructed on this thread -- initializes thread-local swe context)
+  unsigned long job = 0;
+  std::unique_lock<std::mutex> lock(mMutex);
+  while(true)
+    {
+      mWorkCv.wait(lock, [&]() { return (mQuit || mJob != job); });
+      if(mQuit) { return; }
+      job = mJob;
+      const IndexFunc *func = mFunc;
+      int count = mCount;
+      int chunk = mChunk;
+      lock.unlock();
+
+      for(int i0 = mNext.fetch_add(chunk); i0 < count; i0 = mNext.fetch_add(chunk))
+        {
+          int i1 = std::min(i0 + chunk, count);
+          for(int i = i0; i < i1; i++) { (*func)(swe, i); }
+        }
+
+      lock.lock();
+      if(--mActive == 0) { mDoneCv.notify_all(); }
+    }
+}
+
+void EphemerisPool::parallel_for(int count, const IndexFunc &func)
+{
+  if(count <= 0) { return; }
+  std::lock_guard<std::mutex> call(mCallMutex);
+  std::unique_lock<std::mutex> lock(mMutex);
+  mFunc   = &func;
+  mCount  = count;
+  mChunk  = std::max(1, count / (int)(mThreads.size()*EPHEMERIS_POOL_CHUNKS));
+  mNext   = 0;
+  mActive = mThreads.size();
+  mJob++;
+  mWorkCv.notify_all();
+  mDoneCv.wait(lock, [&]() { return (mActive == 0); });
+  mFunc = nullptr;
+}
+
+void EphemerisPool::parallel_for(double jdStart, double jdStep, int count, const JulianDayFunc &func)
+{
+  parallel_for(count, [&](Ephemeris &swe, int i) { func(swe, i, jdStart + i*jdStep); });
+}
@@ -0,0 +1,441 @@
+#include "eventSearch.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+
+// sample spacing for each object (julian days)
+//  - short enough that the cubic model between samples stays close (no missed double crossings)
+//  - shorter than the shortest retrograde period (stations)
+static const std::array<double, OBJ_COUNT> EVENT_SAMPLE_DAYS =
+  { 4.0,  // sun
+    1.0,  // moon
+    2.0,  // mercury
+    4.0,  // venus
+    4.0,  // mars
+    8.0,  // jupiter
+    8.0,  // saturn
+    8.0,  // uranus
+    8.0,  // neptune
+    8.0,  // pluto
+    8.0,  // quaoar
+    4.0,  // chiron
+    4.0,  // ceres
+    4.0,  // juno
+    4.0,  // pallas
+    4.0,  // vesta
+    4.0,  // lilith
+    4.0,  // fortuna
+    1.0,  // north node (true node oscillates -- reversals shorter than a day are skipped)
+    1.0 };// south node (copied from north node)
+
+// brent's method -- finds root of f in [a, b] (fa and fb must have opposite signs)
+static bool brentRoot(const std::function<bool(double, double&)> &f, double a, double b, double fa, double fb, double &root)
+{
+  if((fa > 0.0) == (fb > 0.0)) { return false; }
+  if(std::abs(fa) < std::abs(fb)) { std::swap(a, b); std::swap(fa, fb); }
+  double c = a, fc = fa, d = b - a;
+  bool bisected = true;
+  for(int i = 0; i < EVENT_MAX_BRENT; i++)
+    {
+      if(fb == 0.0 || std::abs(b - a) < EVENT_TOLERANCE) { root = b; return true; }
+      double s;
+      if(fa != fc && fb != fc) // inverse quadratic interpolation
+        { s = (a*fb*fc/((fa-fb)*(fa-fc)) + b*fa*fc/((fb-fa)*(fb-fc)) + c*fa*fb/((fc-fa)*(fc-fb))); }
+      else                     // secant
+        { s = b - fb*(b - a)/(fb - fa); }
+
+      double m = (3.0*a + b)/4.0;
+      if(!((s > std::min(m, b) && s < std::max(m, b))) ||
+         ( bisected && std::abs(s - b) >= std::abs(b - c)/2.0) ||
+         (!bisected && std::abs(s - b) >= std::abs(c - d)/2.0))
+        { s = (a + b)/2.0; bisected = true; } // bisection
+      else
+        { bisected = false; }
+
+      double fs;
+      if(!f(s, fs)) { return false; }
+      d = c; c = b; fc = fb;
+      if((fa > 0.0) != (fs > 0.0)) { b = s; fb = fs; }
+      else                         { a = s; fa = fs; }
+      if(std::abs(fa) < std::abs(fb)) { std::swap(a, b); std::swap(fa, fb); }
+    }
+  root = b;
+  return true;
+}
+
+
+EventSearch::EventSearch(long sweFlags)
+  : mSweFlags(sweFlags | SEFLG_SPEED)
+{ }
+
+void EventSearch::setRange(double jdStart, double jdEnd)
+{
+  mJdStart = std::min(jdStart, jdEnd);
+  mJdEnd   = std::max(jdStart, jdEnd);
+}
+
+void EventSearch::addIngresses(ObjType o)
+{
+  if(o <= OBJ_INVALID || o >= OBJ_COUNT) { std::cout << "WARNING: EventSearch::addIngresses() --> invalid object (" << o << ")\n"; return; }
+  Query q; q.type = EVENT_INGRESS; q.obj1 = o;
+  mQueries.push_back(q);
+}
+
+void EventSearch::addCuspCrossings(ObjType o, const std::array<double, 12> &cusps)
+{
+  if(o <= OBJ_INVALID || o >= OBJ_COUNT) { std::cout << "WARNING: EventSearch::addCuspCrossings() --> invalid object (" << o << ")\n"; return; }
+  Query q; q.type = EVENT_CUSP; q.obj1 = o; q.targets.assign(cusps.begin(), cusps.end());
+  mQueries.push_back(q);
+}
+
+void EventSearch::addCrossings(ObjType o, const std::vector<double> &longitudes)
+{
+  if(o <= OBJ_INVALID || o >= OBJ_COUNT) { std::cout << "WARNING: EventSearch::addCrossings() --> invalid object (" << o << ")\n"; return; }
+  Query q; q.type = EVENT_CROSSING; q.obj1 = o; q.targets = longitudes;
+  mQueries.push_back(q);
+}
+
+void EventSearch::addStations(ObjType o)
+{
+  if(o <= OBJ_INVALID || o >= OBJ_COUNT) { std::cout << "WARNING: EventSearch::addStations() --> invalid object (" << o << ")\n"; return; }
+  Query q; q.type = EVENT_STATION; q.obj1 = o;
+  mQueries.push_back(q);
+}
+
+void EventSearch::addAspect(ObjType o1, ObjType o2, AspectType asp)
+{
+  if(o1 <= OBJ_INVALID || o1 >= OBJ_COUNT || o2 <= OBJ_INVALID || o2 >= OBJ_COUNT || o1 == o2)
+    { std::cout << "WARNING: EventSearch::addAspect() --> invalid objects (" << o1 << ", " << o2 << ")\n"; return; }
+  if(asp <= ASPECT_INVALID || asp >= ASPECT_COUNT)
+    { std::cout << "WARNING: EventSearch::addAspect() --> invalid aspect (" << asp << ")\n"; return; }
+  Query q; q.type = EVENT_ASPECT; q.obj1 = o1; q.obj2 = o2; q.aspect = asp;
+  mQueries.push_back(q);
+}
+
+void EventSearch::forEach(int count, EphemerisPool *pool, const EphemerisPool::IndexFunc &func)
+{
+  if(pool)
+    {
+      pool->parallel_for(count, [&](Ephemeris &swe, int i)
+                         {
+                           swe.setLocation(mLocation);
+                           func(swe, i);
+                         });
+    }
+  else
+    { for(int i = 0; i < count; i++) { func(mSwe, i); } }
+}
+
+void EventSearch::sampleTracks(const ObjMask &objects, EphemerisPool *pool)
+{
+  bool southNode = objects[OBJ_SOUTHNODE];
+  ObjMask sampled = objects;
+  if(southNode) { sampled.set(OBJ_NORTHNODE).reset(OBJ_SOUTHNODE); }
+
+  // flatten (object, sample) pairs
+  std::vector<std::pair<ObjType, int>> samples;
+  for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+    {
+      Track &track = mTracks[o];
+      track.lon.clear(); track.spd.clear();
+      if(!sampled[o]) { continue; }
+      int n = std::max(2, (int)std::ceil((mJdEnd - mJdStart)/EVENT_SAMPLE_DAYS[o]) + 1);
+      track.step = (mJdEnd - mJdStart)/(n-1);
+      track.lon.resize(n, 0.0); track.spd.resize(n, 0.0);
+      for(int i = 0; i < n; i++) { samples.emplace_back((ObjType)o, i); }
+    }
+
+  forEach(samples.size(), pool, [&](Ephemeris &swe, int s)
+          {
+            ObjType o = samples[s].first;
+            int     i = samples[s].second;
+            Track &track = mTracks[o];
+            ObjDataArray data;
+            swe.calcObjects(mJdStart + i*track.step, ObjMask().set(o), mSweFlags, data);
+            track.lon[i] = data.longitude[o];
+            track.spd[i] = data.lonSpeed[o];
+          });
+
+  // unwrap longitudes (choose branch closest to prediction from speeds)
+  for(int o = OBJ_SUN; o < OBJ_COUNT; o++)
+    {
+      Track &track = mTracks[o];
+      for(int i = 1; i < track.lon.size(); i++)
+        {
+          double predicted = track.lon[i-1] + 0.5*(track.spd[i-1] + track.spd[i])*track.step;
+          track.lon[i] += 360.0*std::round((predicted - track.lon[i])/360.0);
+        }
+    }
+  if(southNode)
+    { // opposite north node
+      mTracks[OBJ_SOUTHNODE] = mTracks[OBJ_NORTHNODE];
+      for(auto &lon : mTracks[OBJ_SOUTHNODE].lon) { lon += 180.0; }
+    }
+}
+
+void EventSearch::trackValue(ObjType o, double jd, double &lon, double &spd) const
+{ // cubic hermite interpolation between samples
+  const Track &track = mTracks[o];
+  int n = track.lon.size();
+  int i = std::min(n-2, std::max(0, (int)std::floor((jd - mJdStart)/track.step)));
+  double h = track.step;
+  double s = (jd - (mJdStart + i*h))/h;
+  double p0 = track.lon[i], p1 = track.lon[i+1];
+  double m0 = track.spd[i]*h, m1 = track.spd[i+1]*h;
+  double s2 = s*s, s3 = s2*s;
+  lon = (2*s3 - 3*s2 + 1)*p0 + (s3 - 2*s2 + s)*m0 + (-2*s3 + 3*s2)*p1 + (s3 - s2)*m1;
+  spd = ((6*s2 - 6*s)*p0 + (3*s2 - 4*s + 1)*m0 + (-6*s2 + 6*s)*p1 + (3*s2 - 2*s)*m1)/h;
+}
+
+void EventSearch::findCrossings(int qi, ObjType o1, ObjType o2, const std::vector<double> &targets, std::vector<Candidate> &out) const
+{ // model value: lon(o1) [- lon(o2)], sampled on the finer of the two tracks
+  double h = mTracks[o1].step;
+  int    n = mTracks[o1].lon.size();
+  if(o2 != OBJ_INVALID && mTracks[o2].step < h) { h = mTracks[o2].step; n = mTracks[o2].lon.size(); }
+
+  // targets sorted by longitude [0, 360) (paired with index)
+  std::vector<std::pair<double, int>> sorted;
+  for(int ti = 0; ti < targets.size(); ti++)
+    {
+      double t = fmod(targets[ti], 360.0);
+      sorted.emplace_back((t < 0.0 ? t + 360.0 : t), ti);
+    }
+  std::sort(sorted.begin(), sorted.end());
+
+  auto value = [&](double jd, double &v, double &dv)
+               {
+                 trackValue(o1, jd, v, dv);
+                 if(o2 != OBJ_INVALID)
+                   {
+                     double v2, dv2;
+                     trackValue(o2, jd, v2, dv2);
+                     v -= v2; dv -= dv2;
+                   }
+               };
+
+  double t0 = mJdStart, v0, d0;
+  value(t0, v0, d0);
+  for(int i = 1; i < n; i++)
+    {
+      double t1 = (i == n-1 ? mJdEnd : mJdStart + i*h), v1, d1;
+      value(t1, v1, d1);
+
+      // cubic in s = t - t0:  v0 + b*s + c*s^2 + d*s^3
+      double dt = t1 - t0;
+      double b  = d0;
+      double c  = (3.0*(v1 - v0)/dt - 2.0*d0 - d1)/dt;
+      double d  = (d0 + d1 - 2.0*(v1 - v0)/dt)/(dt*dt);
+      auto cubic = [&](double s) { return v0 + s*(b + s*(c + s*d)); };
+
+      // split into monotonic pieces at interior extrema
+      std::vector<double> splits = { 0.0 };
+      double qa = 3.0*d, qb = 2.0*c, qc = b;
+      if(std::abs(qa) > 1e-14)
+        {
+          double disc = qb*qb - 4.0*qa*qc;
+          if(disc > 0.0)
+            {
+              double r1 = (-qb - std::sqrt(disc))/(2.0*qa);
+              double r2 = (-qb + std::sqrt(disc))/(2.0*qa);
+              if(r1 > r2) { std::swap(r1, r2); }
+              if(r1 > 0.0 && r1 < dt) { splits.push_back(r1); }
+              if(r2 > 0.0 && r2 < dt) { splits.push_back(r2); }
+            }
+        }
+      else if(std::abs(qb) > 1e-14)
+        {
+          double r = -qc/qb;
+          if(r > 0.0 && r < dt) { splits.push_back(r); }
+        }
+      splits.push_back(dt);
+
+      for(int p = 0; p+1 < splits.size(); p++)
+        {
+          double sa = splits[p], sb = splits[p+1];
+          double va = (p == 0 ? v0 : cubic(sa));
+          double vb = (p+2 == splits.size() ? v1 : cubic(sb));
+          double lo = std::min(va, vb), hi = std::max(va, vb);
+          for(long k = (long)std::floor(lo/360.0); k <= (long)std::floor(hi/360.0); k++)
+            { // (only targets within range of this piece)
+              double base = 360.0*k;
+              for(auto iter = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(lo - base, -1));
+                  iter != sorted.end() && iter->first + base <= hi; iter++)
+                {
+                  double target = iter->first + base;
+                  if((va < target) == (vb < target)) { continue; } // (half-open -- counted once at shared endpoints)
+
+                  // locate root on the (monotonic) model
+                  double a = sa, z = sb;
+                  bool rising = (vb > va);
+                  for(int j = 0; j < 24; j++)
+                    {
+                      double m = (a + z)/2.0;
+                      if((cubic(m) < target) == rising) { a = m; } else { z = m; }
+                    }
+                  Candidate cand;
+                  cand.query  = qi;
+                  cand.target = iter->first;
+                  cand.index  = iter->second;
+                  cand.t0     = t0 + sa;
+                  cand.t1     = t0 + sb;
+                  cand.guess  = t0 + (a + z)/2.0;
+                  cand.accel  = std::abs(2.0*c) + std::abs(6.0*d)*dt; // (bound on model acceleration)
+                  out.push_back(cand);
+                }
+            }
+        }
+      t0 = t1; v0 = v1; d0 = d1;
+    }
+}
+
+// brackets stations of object o -- speed changes sign between samples (exact speeds -- valid bracket)
+void EventSearch::findStations(int qi, ObjType o, std::vector<Candidate> &out) const
+{
+  const Track &track = mTracks[o];
+  for(int i = 1; i < track.spd.size(); i++)
+    {
+      if((track.spd[i-1] < 0.0) == (track.spd[i] < 0.0)) { continue; }
+      Candidate cand;
+      cand.query = qi;
+      cand.t0    = mJdStart + (i-1)*track.step;
+      cand.t1    = mJdStart + i*track.step;
+      cand.guess = (cand.t0 + cand.t1)/2.0;
+      out.push_back(cand);
+    }
+}
+
+bool EventSearch::refine(const Candidate &cand, Ephemeris &swe, AstroEvent &event) const
+{
+  const Query &q = mQueries[cand.query];
+  ObjMask mask; mask.set(q.obj1);
+  if(q.obj2 != OBJ_INVALID) { mask.set(q.obj2); }
+  ObjDataArray data;
+
+  // evaluates signed distance from target (and its rate)
+  auto eval = [&](double jd, double &f, double &df) -> bool
+              {
+                if(swe.calcObjects(jd, mask, mSweFlags, data) < mask.count()) { return false; }
+                if(q.type == EVENT_STATION)
+                  { f = data.lonSpeed[q.obj1]; df = 0.0; }
+                else if(q.obj2 == OBJ_INVALID)
+                  { f = angleDiffSignedDegrees(data.longitude[q.obj1], cand.target); df = data.lonSpeed[q.obj1]; }
+                else
+                  {
+                    f  = angleDiffSignedDegrees(data.longitude[q.obj1] - data.longitude[q.obj2], cand.target);
+                    df = data.lonSpeed[q.obj1] - data.lonSpeed[q.obj2];
+                  }
+                return true;
+              };
+  auto evalF = [&](double jd, double &f) -> bool { double df; return eval(jd, f, df); };
+
+  double root = cand.guess;
+  double lastStep = 0.0; // (data is from root-lastStep if newton converged)
+  bool   converged = false;
+  double slack = (cand.t1 - cand.t0);
+  if(q.type != EVENT_STATION)
+    { // newton iteration (speeds from swe_calc)
+      for(int i = 0; i < EVENT_MAX_NEWTON; i++)
+        {
+          double f, df;
+          if(!eval(root, f, df) || df == 0.0) { break; }
+          lastStep = -f/df;
+          root += lastStep;
+          if(root < cand.t0 - slack || root > cand.t1 + slack) { break; } // diverging
+          // converged if step is small, or if error remaining after this step is (~accel*step^2/speed)
+          if(std::abs(lastStep) < EVENT_TOLERANCE ||
+             cand.accel*lastStep*lastStep < EVENT_TOLERANCE*std::abs(df)) { converged = true; break; }
+        }
+    }
+  if(!converged)
+    { // brent's method over bracket
+      double fa, fb;
+      if(!evalF(cand.t0, fa) || !evalF(cand.t1, fb)) { return false; }
+      if(!brentRoot(evalF, cand.t0, cand.t1, fa, fb, root)) { return false; }
+      if(!evalF(root, fa)) { return false; }
+      lastStep = 0.0;
+    }
+  // model bracket may be slightly off near its ends, but a root outside it belongs to a neighboring candidate
+  if(root < cand.t0 - 0.1*slack || root > cand.t1 + 0.1*slack) { return false; }
+  if(root < mJdStart || root > mJdEnd) { return false; }
+
+  event.type  = q.type;
+  event.query = cand.query;
+  event.jd    = root;
+  event.obj1  = q.obj1;
+  event.obj2  = q.obj2;
+  event.angle = fmod(data.longitude[q.obj1] + data.lonSpeed[q.obj1]*lastStep + 360.0, 360.0);
+  event.dir   = (data.lonSpeed[q.obj1] < 0.0 ? -1 : 1);
+  switch(q.type)
+    {
+    case EVENT_INGRESS:  event.index = (event.dir > 0 ? cand.index : (cand.index + 11) % 12); break;
+    case EVENT_CUSP:     event.index = cand.index + 1; break;
+    case EVENT_CROSSING: event.index = cand.index;     break;
+    case EVENT_ASPECT:   event.index = (int)q.aspect;  break;
+    case EVENT_STATION:
+      { // direction after station
+        double fEnd;
+        if(!evalF(cand.t1, fEnd)) { return false; }
+        event.index = (fEnd < 0.0 ? 1 : 0);
+        event.dir   = (fEnd < 0.0 ? -1 : 1);
+      } break;
+    default: return false;
+    }
+  return true;
+}
+
+std::vector<AstroEvent> EventSearch::search(EphemerisPool *pool)
+{
+  std::vector<AstroEvent> events;
+  if(mQueries.empty() || mJdEnd <= mJdStart) { return events; }
+
+  ObjMask objects;
+  for(auto &q : mQueries)
+    {
+      objects.set(q.obj1);
+      if(q.obj2 != OBJ_INVALID) { objects.set(q.obj2); }
+    }
+  sampleTracks(objects, pool);
+
+  // bracket events on sampled tracks
+  std::vector<Candidate> candidates;
+  for(int qi = 0; qi < mQueries.size(); qi++)
+    {
+      const Query &q = mQueries[qi];
+      std::vector<double> targets;
+      switch(q.type)
+        {
+        case EVENT_INGRESS:
+          for(int s = 0; s < 12; s++) { targets.push_back(s*30.0); }
+          findCrossings(qi, q.obj1, OBJ_INVALID, targets, candidates);
+          break;
+        case EVENT_CUSP:
+        case EVENT_CROSSING:
+          findCrossings(qi, q.obj1, OBJ_INVALID, q.targets, candidates);
+          break;
+        case EVENT_ASPECT:
+          {
+            double angle = getAspectInfo(q.aspect)->angle;
+            targets.push_back(angle);
+            if(angle > 0.0 && angle < 180.0) { targets.push_back(-angle); }
+            findCrossings(qi, q.obj1, q.obj2, targets, candidates);
+          } break;
+        case EVENT_STATION:
+          findStations(qi, q.obj1, candidates);
+          break;
+        default: break;
+        }
+    }
+
+  // refine against swe_calc
+  std::vector<AstroEvent> refined(candidates.size());
+  std::vector<char>       valid(candidates.size(), 0);
+  forEach(candidates.size(), pool, [&](Ephemeris &swe, int i)
+          { valid[i] = refine(candidates[i], swe, refined[i]); });
+
+  for(int i = 0; i < candidates.size(); i++)
+    { if(valid[i]) { events.push_back(refined[i]); } }
+  std::sort(events.begin(), events.end(), [](const AstroEvent &e1, const AstroEvent &e2) { return e1.jd < e2.jd; });
+  return events;
+}
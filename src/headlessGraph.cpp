@@ -0,0 +1,329 @@
+#include "headlessGraph.hpp"
+using namespace astro;
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+#include <functional>
+
+
+// splits saved settings string into key/value pairs (e.g. "key1:val1|key2:val2|" --> sep='|', assign=':')
+static std::map<std::string, std::string> splitSettings(const std::string &str, char sep, char assign)
+{
+  std::map<std::string, std::string> values;
+  std::stringstream ss(str);
+  std::string entry;
+  while(std::getline(ss, entry, sep))
+    {
+      std::size_t pos = entry.find(assign);
+      if(pos != std::string::npos) { values.emplace(entry.substr(0, pos), entry.substr(pos+1)); }
+    }
+  return values;
+}
+
+// applies saved ChartNode options (SettingsForm "opt" param --> house system/zodiac/true positions)
+static void applyChartOptions(Chart *chart, const std::string &opt)
+{
+  std::map<std::string, std::string> options = splitSettings(opt, '|', ':');
+
+  // house system (combo index into saved choices)
+  std::map<std::string, std::string> hsys = splitSettings(options["hsys"], '/', ';');
+  int index = -1;
+  std::istringstream(hsys["value"]) >> index;
+  HouseSystem hs = HOUSE_PLACIDUS;
+  std::vector<std::string> choices;
+  std::stringstream ss(hsys["choices"]);
+  std::string choice;
+  while(std::getline(ss, choice, ',')) { if(!choice.empty()) { choices.push_back(choice); } }
+  if(index >= 0 && index < choices.size()) { hs = getHouseSystem(choices[index]); }
+  if(hs == HOUSE_INVALID)
+    { std::cout << "WARNING: Unknown house system '" << (index >= 0 && index < choices.size() ? choices[index] : "") << "' (using Placidus)\n"; hs = HOUSE_PLACIDUS; }
+  chart->setHouseSystem(hs);
+
+  // zodiac
+  int zodiac = ZODIAC_TROPICAL;
+  std::istringstream(splitSettings(options["zodiac"], '/', ';')["value"]) >> zodiac;
+  chart->setZodiac((ZodiacType)std::max(0, std::min(zodiac, (int)ZODIAC_COUNT-1)));
+
+  // true positions
+  chart->setTruePos(splitSettings(options["truePos"], '/', ';')["value"] == "1");
+}
+
+// chart nodes show objects, angles hidden (see ChartNode/ProgressNode)
+static void initVisibility(Chart *chart)
+{
+  for(int o = 0; o < OBJ_END; o++) { chart->showObject((ObjType)o, (o < OBJ_COUNT)); }
+}
+
+// escapes string for JSON output
+static std::string jsonString(const std::string &str)
+{
+  std::ostringstream ss;
+  ss << "\"";
+  for(char c : str)
+    {
+      switch(c)
+        {
+        case '"':  ss << "\\\""; break;
+        case '\\': ss << "\\\\"; break;
+        case '\n': ss << "\\n";  break;
+        case '\t': ss << "\\t";  break;
+        default:
+          if((unsigned char)c < 0x20) { ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec; }
+          else                        { ss << c; }
+        }
+    }
+  ss << "\"";
+  return ss.str();
+}
+
+// quotes CSV field if needed
+static std::string csvString(const std::string &str)
+{
+  if(str.find_first_of(",\"\n") == std::string::npos) { return str; }
+  std::string quoted = "\"";
+  for(char c : str) { quoted += (c == '"' ? std::string("\"\"") : std::string(1, c)); }
+  return quoted + "\"";
+}
+
+
+HeadlessGraph::~HeadlessGraph()
+{ clear(); }
+
+bool HeadlessGraph::supported(const std::string &type)
+{ return (type == "TimeNode" || type == "LocationNode" || type == "ChartNode" || type == "ProgressNode"); }
+
+void HeadlessGraph::clear()
+{
+  for(auto &iter : mNodes) { if(iter.second.chart) { delete iter.second.chart; } }
+  mNodes.clear();
+  mOrder.clear();
+  mSkipped.clear();
+}
+
+bool HeadlessGraph::load(const ProjectFile &project)
+{
+  clear();
+  for(const auto &n : project.nodes())
+    {
+      if(!supported(n.type)) { mSkipped.push_back(n.id); continue; }
+      if(mNodes.count(n.id) > 0) { std::cout << "WARNING: HeadlessGraph::load() --> duplicate node id (" << n.id << ")\n"; continue; }
+      HeadlessNode &node = mNodes[n.id];
+      node.id    = n.id;
+      node.type  = n.type;
+      node.name  = n.name;
+      node.saved = &n;
+    }
+  for(const auto &con : project.connections())
+    {
+      auto iter = mNodes.find(con.inNode);
+      if(iter != mNodes.end() && mNodes.count(con.outNode) > 0) // (both ends evaluated)
+        { iter->second.inputs[con.inIndex] = con.outNode; }
+    }
+  updateOrder();
+  return true;
+}
+
+HeadlessNode* HeadlessGraph::input(const HeadlessNode &node, int index)
+{
+  auto iter = node.inputs.find(index);
+  if(iter == node.inputs.end()) { return nullptr; }
+  auto nIter = mNodes.find(iter->second);
+  return (nIter != mNodes.end() ? &nIter->second : nullptr);
+}
+
+// orders nodes so inputs are evaluated first (depth-first -- cycles broken with a warning)
+void HeadlessGraph::updateOrder()
+{
+  mOrder.clear();
+  std::set<int> done;
+  std::set<int> visiting;
+  std::function<void(int)> visit = [&](int id)
+  {
+    if(done.count(id) > 0) { return; }
+    if(visiting.count(id) > 0) { std::cout << "WARNING: HeadlessGraph --> cycle at node " << id << "\n"; return; }
+    visiting.insert(id);
+    for(const auto &in : mNodes[id].inputs) { visit(in.second); }
+    visiting.erase(id);
+    done.insert(id);
+    mOrder.push_back(id);
+  };
+  for(const auto &iter : mNodes) { visit(iter.first); }
+}
+
+void HeadlessGraph::update()
+{
+  for(int id : mOrder) { evaluate(mNodes[id]); }
+}
+
+void HeadlessGraph::evaluate(HeadlessNode &node)
+{
+  const ProjectNode &saved = *node.saved;
+  if(node.type == "TimeNode")
+    { // TIMENODE_INPUT_LOCATION(0) --> sets timezone
+      if(saved.param("live") == "1") { node.date = DateTime::now(); }
+      else                           { node.date = DateTime(saved.param("date")); }
+      HeadlessNode *locIn = input(node, 0);
+      if(locIn) { locIn->location.getTimezoneOffset(node.date); }
+    }
+  else if(node.type == "LocationNode")
+    { node.location = Location(saved.param("location")); }
+  else if(node.type == "ChartNode")
+    { // CHARTNODE_INPUT_DATE(0), CHARTNODE_INPUT_LOCATION(1)
+      if(!node.chart)
+        {
+          node.chart = new Chart(DateTime::now(), Location());
+          initVisibility(node.chart);
+        }
+      HeadlessNode *dtIn  = input(node, 0);
+      HeadlessNode *locIn = input(node, 1);
+      if(dtIn)                            { node.chart->setDate(dtIn->date); }
+      else if(saved.params.count("date")) { node.chart->setDate(DateTime(saved.param("date"))); }
+      if(locIn)                               { node.chart->setLocation(locIn->location); }
+      else if(saved.params.count("location")) { node.chart->setLocation(Location(saved.param("location"))); }
+      applyChartOptions(node.chart, saved.param("opt"));
+      node.chart->update();
+    }
+  else if(node.type == "ProgressNode")
+    { // PROGRESSNODE_INPUT_CHART(0), PROGRESSNODE_INPUT_DATE(1), PROGRESSNODE_INPUT_LOCATION(2)
+      HeadlessNode *chartIn = input(node, 0);
+      if(!chartIn || !chartIn->chart)
+        {
+          std::cout << "WARNING: HeadlessGraph --> progress node " << node.id << " has no input chart (skipped)\n";
+          delete node.chart; node.chart = nullptr;
+          return;
+        }
+      HeadlessNode *dtIn  = input(node, 1);
+      HeadlessNode *locIn = input(node, 2);
+      if(!dtIn)
+        { // (ProgressNode::onUpdate only sets the date from its date input -- chart would keep its default date)
+          std::cout << "WARNING: HeadlessGraph --> progress node " << node.id << " has no input date (skipped)\n";
+          delete node.chart; node.chart = nullptr;
+          return;
+        }
+      if(!node.chart)
+        {
+          node.chart = new Chart(DateTime(), Location());
+          initVisibility(node.chart);
+        }
+      // same as ProgressNode::onUpdate -- location only set from location input (progression uses original location otherwise)
+      const DateTime &dtOrig  = chartIn->chart->date();
+      const Location &locOrig = chartIn->chart->location();
+      Location locComp = (locIn ? locIn->location : locOrig);
+      node.chart->setDate(node.chart->swe().getProgressed(dtOrig, locOrig, dtIn->date, locComp));
+      if(locIn) { node.chart->setLocation(locIn->location); }
+      node.chart->update();
+    }
+}
+
+std::vector<const HeadlessNode*> HeadlessGraph::charts() const
+{
+  std::vector<const HeadlessNode*> result;
+  for(int id : mOrder)
+    {
+      const HeadlessNode &node = mNodes.at(id);
+      if(node.chart) { result.push_back(&node); }
+    }
+  return result;
+}
+
+
+void HeadlessGraph::writeJson(std::ostream &os) const
+{
+  os.unsetf(std::ios::floatfield);
+  os << std::setprecision(12);
+
+  std::vector<const HeadlessNode*> nodes = charts();
+  os << "{\n  \"charts\": [";
+  for(int i = 0; i < nodes.size(); i++)
+    {
+      const HeadlessNode &node = *nodes[i];
+      Chart *chart = node.chart;
+      const DateTime &dt  = chart->date();
+      const Location &loc = chart->location();
+      const ChartObjectArrays &a = chart->objectArrays();
+
+      os << (i > 0 ? "," : "") << "\n    {\n"
+         << "      \"id\": "          << node.id << ",\n"
+         << "      \"type\": "        << jsonString(node.type) << ",\n"
+         << "      \"name\": "        << jsonString(node.name) << ",\n"
+         << "      \"date\": "        << jsonString(dt.toString()) << ",\n"
+         << "      \"utcOffset\": "   << dt.utcOffset() << ",\n"
+         << "      \"julianDayET\": " << chart->swe().getJulianDayET() << ",\n"
+         << "      \"location\": { \"latitude\": " << loc.latitude << ", \"longitude\": " << loc.longitude
+         << ", \"altitude\": " << loc.altitude << ", \"timezone\": " << jsonString(loc.timezoneId) << " },\n"
+         << "      \"houseSystem\": " << jsonString(getHouseSystemName(chart->getHouseSystem())) << ",\n"
+         << "      \"zodiac\": "      << jsonString(getZodiacName(chart->getZodiac())) << ",\n"
+         << "      \"truePos\": "     << (chart->getTruePos() ? "true" : "false") << ",\n";
+
+      // objects (planets/asteroids/angles)
+      os << "      \"objects\": [";
+      bool first = true;
+      for(int o = 0; o < OBJ_END; o++)
+        {
+          if(!a.valid[o]) { continue; }
+          double angle = a.angle[o];
+          int    sign  = chart->getSign(angle);
+          os << (first ? "" : ",") << "\n        { \"name\": " << jsonString(getObjName((ObjType)o))
+             << ", \"position\": " << angle << ", \"sign\": " << jsonString(getSignName(sign))
+             << ", \"degree\": " << (angle - sign*30.0) << ", \"house\": " << chart->getHouse(angle)
+             << ", \"longitude\": " << a.longitude[o] << ", \"latitude\": " << a.latitude[o]
+             << ", \"distance\": " << a.distance[o] << ", \"lonSpeed\": " << a.lonSpeed[o]
+             << ", \"retrograde\": " << (a.retrograde[o] ? "true" : "false") << " }";
+          first = false;
+        }
+      os << "\n      ],\n";
+
+      // house cusps
+      os << "      \"houses\": [";
+      for(int h = 1; h <= 12; h++) { os << (h > 1 ? ", " : " ") << chart->getHouseCusp(h); }
+      os << " ],\n";
+
+      // aspects (default params -- visible objects)
+      const std::vector<ChartAspect> &aspects = chart->getAspects(ChartParams());
+      os << "      \"aspects\": [";
+      first = true;
+      for(const auto &asp : aspects)
+        {
+          if(!asp.valid) { continue; }
+          os << (first ? "" : ",") << "\n        { \"type\": " << jsonString(getAspectName(asp.type))
+             << ", \"obj1\": " << jsonString(getObjName(asp.obj1)) << ", \"obj2\": " << jsonString(getObjName(asp.obj2))
+             << ", \"orb\": " << asp.orb << ", \"strength\": " << asp.strength << " }";
+          first = false;
+        }
+      os << (first ? "" : "\n      ") << "]\n    }";
+    }
+  os << (nodes.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+void HeadlessGraph::writeCsv(std::ostream &os) const
+{
+  os.unsetf(std::ios::floatfield);
+  os << std::setprecision(12);
+
+  os << "chart,type,name,date,row,object,position,sign,degree,house,longitude,latitude,distance,lonSpeed,retrograde\n";
+  for(const HeadlessNode *node : charts())
+    {
+      Chart *chart = node->chart;
+      const ChartObjectArrays &a = chart->objectArrays();
+      std::string prefix = (std::to_string(node->id) + "," + csvString(node->type) + "," + csvString(node->name) + "," +
+                            csvString(chart->date().toString()) + ",");
+      for(int o = 0; o < OBJ_END; o++)
+        {
+          if(!a.valid[o]) { continue; }
+          double angle = a.angle[o];
+          int    sign  = chart->getSign(angle);
+          os << prefix << "object," << csvString(getObjName((ObjType)o)) << "," << angle << "," << getSignName(sign) << ","
+             << (angle - sign*30.0) << "," << chart->getHouse(angle) << "," << a.longitude[o] << "," << a.latitude[o] << ","
+             << a.distance[o] << "," << a.lonSpeed[o] << "," << (a.retrograde[o] ? 1 : 0) << "\n";
+        }
+      for(int h = 1; h <= 12; h++)
+        {
+          double cusp = chart->getHouseCusp(h);
+          int    sign = chart->getSign(cusp);
+          os << prefix << "cusp,house" << h << "," << cusp << "," << getSignName(sign) << "," << (cusp - sign*30.0) << ","
+             << h << ",,,,,\n";
+        }
+    }
+}
@@ -3,7 +3,6 @@ using namespace astro;
 
 #include "dateTime.hpp"
 #include "date/tz.h"
-#include <curl/curl.h>
 
 //// LOCATION ////
 // Location::Location() : Location(NYSE_LAT, NYSE_LON, NYSE_ALT) { }
@@ -54,67 +53,6 @@ Location Location::fixed() const
 }
 
 // TIMEZONE //
-std::size_t Location::curlCallback(const char* in, std::size_t size, std::size_t num, std::string *out)
-{
-  const std::size_t totalBytes(size*num);
-  out->append(in, totalBytes);
-  return totalBytes;
-}
-
-// hacky timezone query
-std::string Location::getTimezoneCurl(const astro::Location &loc)
-{
-  std::string timezone = "";
-  CURL *curl = curl_easy_init();
-  if(curl)
-    {
-      std::string url = (std::string(GEONAMES_URL GEONAMES_TIMEZONE_PREFIX) +
-                         "lat=" + to_string(loc.latitude, 12) + "&lng=" + to_string(loc.longitude, 12) +
-                         "&username=" + GEONAMES_USERNAME);
-
-      std::cout << "Querying timezone using Geonames...\n";
-      std::cout << "  (URL: " << url << ")\n";
-      
-      std::unique_ptr<std::string> httpData(new std::string());
-      
-      curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlCallback);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, httpData.get());
-      std::cout << "...";
-      CURLcode res = curl_easy_perform(curl);
-      
-      std::cout << "DONE\n";
-      
-      long httpCode = 0L;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-      curl_easy_cleanup(curl);
-
-      // TODO: proper JSON parsing
-      if(httpCode == 200)
-        {
-          std::cout << "  --> Result: " << *httpData.get() << "\n";
-          // find "timezoneId" section
-          std::string tzLabel = "timezoneId";
-          std::size_t labelPos = httpData.get()->find(tzLabel);
-          if(labelPos != std::string::npos)
-            { // separate value from label
-              std::string rest = httpData.get()->substr(labelPos+tzLabel.size()+1);
-              std::size_t colonPos = rest.find(":");
-              std::size_t commaPos = rest.find(",");
-              std::string valueStr = rest.substr(colonPos+2, commaPos-(colonPos+2)-1);
-              timezone = valueStr;
-            }
-        }
-    }
-  return timezone;
-}
-
-void Location::updateTimezone()
-{
-  timezoneId = getTimezoneCurl(*this);
-  updateUtcOffset();
-}
-
 void Location::updateUtcOffset()
 {
   if(timezoneId.empty())
@@ -0,0 +1,176 @@
+#include "midpointNode.hpp"
+using namespace astro;
+
+#include "imgui.h"
+#include "tools.hpp"
+#include "objectRegistry.hpp"
+
+
+MidpointNode::MidpointNode()
+  : Node(CONNECTOR_INPUTS(), CONNECTOR_OUTPUTS(), "Midpoint Node")
+{
+  setMinSize(Vec2f(480, 0));
+}
+
+void MidpointNode::getPoints(const Chart *chart, std::vector<AspectPoint> &out) const
+{
+  out.clear();
+  const ChartObjectArrays &a = chart->objectArrays();
+  for(int o = 0; o < OBJ_END; o++)
+    {
+      if(a.visible[o] && a.valid[o])
+        { out.push_back(AspectPoint{o, a.angle[o], 0.0}); }
+    }
+  if(mExtras)
+    { // registry objects (index offset by OBJ_END)
+      const ExtraObjectArrays &e = chart->extraObjects();
+      e.visible.forEach([&](int i)
+                        {
+                          if(e.valid.test(i)) { out.push_back(AspectPoint{OBJ_END+i, e.angle[i], 0.0}); }
+                        });
+    }
+}
+
+std::string MidpointNode::pointName(const AspectPoint &p) const
+{
+  if(p.index < OBJ_END) { return getObjName((ObjType)p.index); }
+  const ObjectRegistry &registry = ObjectRegistry::instance();
+  int i = p.index - OBJ_END;
+  return (i < registry.size() ? registry.get(i).name : "?");
+}
+
+void MidpointNode::onUpdate()
+{
+  Chart *chart  = inputs()[MIDPOINTNODE_INPUT_CHART]->get<Chart>();
+  Chart *chart2 = inputs()[MIDPOINTNODE_INPUT_CHART2]->get<Chart>();
+  if(mMode == MIDPOINT_MODE_NATAL) { chart2 = nullptr; } // (second chart unused)
+
+  unsigned long version   = (chart  ? chart->version()  : 0);
+  unsigned long version2  = (chart2 ? chart2->version() : 0);
+  unsigned long settings  = (chart  ? chart->settingsVersion()  : 0); // (object visibility)
+  unsigned long settings2 = (chart2 ? chart2->settingsVersion() : 0);
+  if(chart == mLastChart && chart2 == mLastChart2 && version == mLastVersion && version2 == mLastVersion2 &&
+     settings == mLastSettings && settings2 == mLastSettings2 && mMode == mLastMode && mOrb == mLastOrb && mExtras == mLastExtras)
+    { return; } // (unchanged)
+  mLastChart     = chart;
+  mLastChart2    = chart2;
+  mLastVersion   = version;
+  mLastVersion2  = version2;
+  mLastSettings  = settings;
+  mLastSettings2 = settings2;
+  mLastMode     = mMode;
+  mLastOrb      = mOrb;
+  mLastExtras   = mExtras;
+  mNamesDirty   = true;
+
+  if(!chart || (mMode != MIDPOINT_MODE_NATAL && !chart2))
+    { mTree.clear(); return; }
+
+  getPoints(chart, mPoints);
+  switch(mMode)
+    {
+    case MIDPOINT_MODE_NATAL:
+      mTree.update(mPoints, mPoints, mOrb, true);
+      break;
+    case MIDPOINT_MODE_TRANSIT: // (natal midpoints only recalculated if natal chart changed)
+      getPoints(chart2, mHitPoints);
+      mTree.update(mPoints, mHitPoints, mOrb, false);
+      break;
+    case MIDPOINT_MODE_COMPOSITE:
+      getPoints(chart2, mPoints2);
+      compositePoints(mPoints, mPoints2, mHitPoints);
+      mTree.update(mHitPoints, mHitPoints, mOrb, true);
+      break;
+    default:
+      break;
+    }
+}
+
+void MidpointNode::onDraw()
+{
+  float scale = getScale();
+  ImGuiTreeNodeFlags flags = (ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_FramePadding);
+
+  ImGui::SetNextItemWidth(150*scale);
+  if(ImGui::BeginCombo("Mode##midpointMode", MIDPOINT_MODE_NAMES[mMode].c_str()))
+    {
+      ImGui::SetWindowFontScale(scale);
+      for(int m = 0; m < MIDPOINT_MODE_COUNT; m++)
+        { if(ImGui::Selectable(MIDPOINT_MODE_NAMES[m].c_str(), m == mMode)) { mMode = (MidpointMode)m; } }
+      ImGui::EndCombo();
+    }
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(150*scale);
+  ImGui::InputDouble("Orb##midpointOrb", &mOrb, 0.1, 0.5, "%.2f");
+  mOrb = std::max(0.0, std::min(mOrb, MIDPOINT_ORB_MAX));
+  ImGui::SameLine();
+  ImGui::Checkbox("Extras", &mExtras);
+
+  const std::vector<AspectPoint> &points = mTree.points();
+  const std::vector<Midpoint>    &mids   = mTree.midpoints();
+  const std::vector<MidpointHit> &hits   = mTree.hits();
+  const std::vector<AspectPoint> &hitPoints = (mMode == MIDPOINT_MODE_NATAL ? mPoints : mHitPoints);
+  ImGui::Text("%d points, %d midpoints, %d hits", (int)points.size(), (int)mids.size(), (int)hits.size());
+
+  // composite positions
+  if(mMode == MIDPOINT_MODE_COMPOSITE)
+    {
+      ImGui::SetNextTreeNodeOpen(mCompositeOpen);
+      if(ImGui::CollapsingHeader("composite", nullptr, flags))
+        {
+          mCompositeOpen = true;
+          for(const auto &p : points)
+            { ImGui::Text("%-12s %s", pointName(p).c_str(), angle_string(p.lon).c_str()); }
+        }
+      else if(isBodyVisible())
+        { mCompositeOpen = false; }
+    }
+
+  // midpoint tree (point = midpoint/midpoint/...)
+  ImGui::SetNextTreeNodeOpen(mTreeOpen);
+  if(ImGui::CollapsingHeader("midpointTree", nullptr, flags))
+    {
+      mTreeOpen = true;
+      ImGui::PushStyleVar(ImGuiStyleVar_ScrollbarSize, ImGui::GetStyle().ScrollbarSize*scale);
+      ImGui::BeginChild("##midpointChild", Vec2f(480, 360)*scale);
+      {
+        ImGui::SetWindowFontScale(scale);
+        if(mNamesDirty)
+          {
+            mHitNames.resize(hits.size());
+            mMidNames.resize(hits.size());
+            for(int i = 0; i < (int)hits.size(); i++)
+              {
+                const Midpoint &m = mids[hits[i].midpoint];
+                mHitNames[i] = ((i == 0 || hits[i].point != hits[i-1].point) ? pointName(hitPoints[hits[i].point]) + " =" : "");
+                mMidNames[i] = pointName(points[m.point1]) + "/" + pointName(points[m.point2]);
+              }
+            mNamesDirty = false;
+          }
+        
+        if(ImGui::BeginTable("##midpointCols", 3)) // COLUMNS --> point(0), midpoint(1), orb(2)
+          {
+            ImGuiListClipper clipper; // (only visible rows drawn)
+            clipper.Begin(hits.size());
+            while(clipper.Step())
+              {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                  {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::TextUnformatted(mHitNames[i].c_str());
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::TextUnformatted(mMidNames[i].c_str());
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.2f", hits[i].orb);
+                  }
+              }
+            ImGui::EndTable();
+          }
+      }
+      ImGui::EndChild();
+      ImGui::PopStyleVar();
+    }
+  else if(isBodyVisible())
+    { mTreeOpen = false; }
+}
@@ -0,0 +1,141 @@
+#include "midpoints.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+
+double astro::midpointDegrees(double lon1, double lon2)
+{
+  double mid = std::fmod(lon1 + angleDiffSignedDegrees(lon2, lon1)/2.0 + 360.0, 360.0);
+  return (mid < 0.0 ? mid + 360.0 : mid);
+}
+
+void astro::compositePoints(const std::vector<AspectPoint> &points1, const std::vector<AspectPoint> &points2,
+                            std::vector<AspectPoint> &out)
+{
+  out.clear();
+  for(const auto &p1 : points1)
+    {
+      for(const auto &p2 : points2)
+        {
+          if(p2.index == p1.index)
+            {
+              out.push_back(AspectPoint{p1.index, midpointDegrees(p1.lon, p2.lon), p1.orb});
+              break;
+            }
+        }
+    }
+}
+
+static inline double midpointAxis(double lon)
+{
+  double axis = std::fmod(lon, 180.0);
+  return (axis < 0.0 ? axis + 180.0 : axis);
+}
+
+
+void MidpointTree::rebuild(const std::vector<AspectPoint> &points)
+{
+  int n = points.size();
+  mPoints = points;
+  mMidpoints.clear();
+  mMidpoints.reserve(n*(n-1)/2);
+  for(int i = 0; i < n; i++)
+    {
+      for(int j = i+1; j < n; j++)
+        {
+          double lon = midpointDegrees(points[i].lon, points[j].lon);
+          mMidpoints.push_back(Midpoint{i, j, lon, midpointAxis(lon)});
+        }
+    }
+  mOrder.resize(mMidpoints.size());
+  for(int i = 0; i < (int)mOrder.size(); i++) { mOrder[i] = i; }
+  std::sort(mOrder.begin(), mOrder.end(), [this](int m1, int m2) { return mMidpoints[m1].axis < mMidpoints[m2].axis; });
+}
+
+bool MidpointTree::updateMoved(const std::vector<AspectPoint> &points)
+{
+  int n = points.size();
+  mMoved.assign(n, false);
+  bool any = false;
+  for(int i = 0; i < n; i++)
+    {
+      mMoved[i] = (points[i].lon != mPoints[i].lon);
+      any |= mMoved[i];
+    }
+  if(!any) { return false; }
+  mPoints = points;
+
+  for(auto &m : mMidpoints)
+    {
+      if(mMoved[m.point1] || mMoved[m.point2])
+        {
+          m.lon  = midpointDegrees(mPoints[m.point1].lon, mPoints[m.point2].lon);
+          m.axis = midpointAxis(m.lon);
+        }
+    }
+  // repair order (insertion sort -- small moves between updates)
+  long shifts    = 0;
+  long maxShifts = MIDPOINT_SORT_SHIFTS*(long)mOrder.size();
+  for(int i = 1; i < (int)mOrder.size() && shifts <= maxShifts; i++)
+    {
+      int    m    = mOrder[i];
+      double axis = mMidpoints[m].axis;
+      int    j    = i;
+      for(; j > 0 && mMidpoints[mOrder[j-1]].axis > axis; j--)
+        { mOrder[j] = mOrder[j-1]; }
+      mOrder[j] = m;
+      shifts += i - j;
+    }
+  if(shifts > maxShifts) // (large jump -- full sort)
+    { std::sort(mOrder.begin(), mOrder.end(), [this](int m1, int m2) { return mMidpoints[m1].axis < mMidpoints[m2].axis; }); }
+  return true;
+}
+
+void MidpointTree::findHits(const std::vector<AspectPoint> &hitPoints, double orb, bool excludeSelf)
+{
+  mHits.clear();
+  int count = mAxes.size();
+  if(count == 0) { return; }
+  for(int p = 0; p < (int)hitPoints.size(); p++)
+    {
+      const AspectPoint &hp = hitPoints[p];
+      double axis  = midpointAxis(hp.lon);
+      int    first = mHits.size();
+      // window [axis-orb, axis+orb] (split where it wraps past 0/180)
+      auto visit = [&](double lo, double hi)
+                   {
+                     for(int k = std::lower_bound(mAxes.begin(), mAxes.end(), lo) - mAxes.begin(); k < count && mAxes[k] <= hi; k++)
+                       {
+                         const Midpoint &m = mMidpoints[mOrder[k]];
+                         if(excludeSelf && (mPoints[m.point1].index == hp.index || mPoints[m.point2].index == hp.index)) { continue; }
+                         double d = std::abs(mAxes[k] - axis);
+                         mHits.push_back(MidpointHit{p, mOrder[k], std::min(d, 180.0 - d)});
+                       }
+                   };
+      visit(std::max(0.0, axis-orb), std::min(180.0, axis+orb));
+      if(axis - orb < 0.0)   { visit(axis - orb + 180.0, 180.0); }
+      if(axis + orb > 180.0) { visit(0.0, axis + orb - 180.0); }
+      std::sort(mHits.begin()+first, mHits.end(), [](const MidpointHit &h1, const MidpointHit &h2) { return h1.orb < h2.orb; });
+    }
+}
+
+bool MidpointTree::update(const std::vector<AspectPoint> &points, const std::vector<AspectPoint> &hitPoints, double orb, bool excludeSelf)
+{
+  bool same = (points.size() == mPoints.size());
+  for(int i = 0; same && i < (int)points.size(); i++)
+    { same = (points[i].index == mPoints[i].index); }
+
+  bool changed = true;
+  if(same) { changed = updateMoved(points); }
+  else     { rebuild(points); }
+
+  if(changed)
+    {
+      mAxes.resize(mOrder.size());
+      for(int i = 0; i < (int)mOrder.size(); i++) { mAxes[i] = mMidpoints[mOrder[i]].axis; }
+    }
+  findHits(hitPoints, orb, excludeSelf);
+  return changed;
+}
@@ -139,6 +139,10 @@ void MoonNode::renderTexture()
 void MoonNode::onUpdate()
 {
   Chart *chart = inputs()[MOONNODE_INPUT_CHART]->get<Chart>();
+  if(chart == mLastChart && (!chart || chart->positionsVersion() == mLastVersion)) { return; } // (unchanged)
+  mLastChart   = chart;
+  mLastVersion = (chart ? chart->positionsVersion() : 0);
+  mTexDirty    = true;
   if(chart)
     {
       mMoonData = chart->getObjectData(OBJ_MOON);
@@ -163,8 +167,8 @@ void MoonNode::onDraw()
       ImGui::Text("MOON: %f", mMoonData.longitude);
       ImGui::Text("SUN: %f",  mSunData.longitude);
 
-      ImGui::Checkbox("Fancy", &mFancyShading);
-      renderTexture();
+      mTexDirty |= ImGui::Checkbox("Fancy", &mFancyShading);
+      if(mTexDirty) { renderTexture(); mTexDirty = false; }
     }
   ImGui::Image(reinterpret_cast<ImTextureID*>(mTex), MOON_DRAW_SIZE*scale, Vec2f(0,0), Vec2f(1,1), Vec4f(1,1,1,1), Vec4f(1,1,1,1));
 }
@@ -2,11 +2,13 @@
 using namespace astro;
 
 #include <string>
+#include <charconv>
 
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "chart.hpp"
 #include "nodeGraph.hpp"
+#include "projectFile.hpp"
 #include "viewSettings.hpp"
   
 static std::unordered_map<std::string, Vec4f> CONNECTOR_COLORS =
@@ -15,6 +17,38 @@ static std::unordered_map<std::string, Vec4f> CONNECTOR_COLORS =
    {std::string(typeid(Chart).name()),    Vec4f(1.0f, 0.2f, 0.2f, 1.0f)}};
 
 
+unsigned long ConnectorBase::CONNECTION_VERSION = 0;
+
+bool ConnectorState<Chart>::poll(const Chart *d)
+{
+  bool changed = (d != data || (d && (d->hasChanged() || d->version() != version || d->settingsVersion() != settings)));
+  data     = d;
+  version  = (d ? d->version() : 0);
+  settings = (d ? d->settingsVersion() : 0);
+  stale |= changed;
+  if(!d) { snapshot.reset(); stale = false; }
+  else if(stale && !d->hasChanged()) // (pending edits published after the chart updates)
+    {
+      d->getSnapshot(snapshot.back());
+      snapshot.publish(Chart::nextVersion());
+      stale = false;
+    }
+  return changed;
+}
+
+
+// connections to/from a connector (output --> input)
+static std::vector<Node::Connection> getConnections(ConnectorBase *con)
+{
+  std::vector<Node::Connection> cons;
+  for(auto other : con->getConnected())
+    {
+      if(con->direction() == CONNECTOR_OUTPUT) { cons.push_back(Node::Connection{con->parent()->id(), con->conId(), other->parent()->id(), other->conId()}); }
+      else                                     { cons.push_back(Node::Connection{other->parent()->id(), other->conId(), con->parent()->id(), con->conId()}); }
+    }
+  return cons;
+}
+
 bool ConnectorBase::connect(ConnectorBase *other, bool force)
 {
   if(!other || other == this || type() != other->type() || mDirection == other->mDirection) { return false; }
@@ -38,9 +72,12 @@ bool ConnectorBase::connect(ConnectorBase *other, bool force)
 
   other->mConnected.push_back(this);
   mConnected.push_back(other);
+  CONNECTION_VERSION++;
   
   other->parent()->onConnect(other);
   mParent->onConnect(this);
+  other->parent()->setDirty();
+  mParent->setDirty();
   return true;
 }
 
@@ -53,6 +90,9 @@ void ConnectorBase::disconnect(ConnectorBase *other)
       if(con == other)
         {
           mConnected.erase(mConnected.begin() + i);
+          CONNECTION_VERSION++;
+          if(mParent)      { mParent->setDirty(); }
+          if(con->mParent) { con->mParent->setDirty(); }
           // disconnect other
           for(int j = 0; j < con->mConnected.size(); j++)
             {
@@ -78,14 +118,17 @@ void ConnectorBase::disconnectAll()
           if(con->mConnected[j] == mThisPtr)
             { con->mConnected.erase(con->mConnected.begin() + j--); }
         }
+      if(con->mParent) { con->mParent->setDirty(); }
     }
+  if(!mConnected.empty()) { CONNECTION_VERSION++; }
   mConnected.clear();
 }
 
 void ConnectorBase::sendSignal(NodeSignal signal)
 {
   mSignals = (NodeSignal)(mSignals | signal);
-  for(auto con : mConnected) { con->sendSignal(signal); }
+  if(mDirection == CONNECTOR_OUTPUT)
+    { for(auto con : mConnected) { con->sendSignal(signal); } } // (inputs don't pass signals back)
 }
 
 void ConnectorBase::draw(bool blocked)
@@ -117,7 +160,12 @@ void ConnectorBase::draw(bool blocked)
       ImGui::TextUnformatted(mName.c_str());
       ImGui::EndTooltip();
 
-      if(ImGui::IsItemClicked(ImGuiMouseButton_Middle))  { disconnectAll(); }   // MIDDLE CLICK -- disconnect all
+      if(ImGui::IsItemClicked(ImGuiMouseButton_Middle))  // MIDDLE CLICK -- disconnect all
+        {
+          std::vector<Node::Connection> before = getConnections(this);
+          disconnectAll();
+          mParent->getGraph()->recordConnect(before, {});
+        }
       if(ImGui::IsMouseClicked(ImGuiMouseButton_Left))   { beginConnecting(); } // LEFT MOUSE DOWN -- start connecting
     }
   
@@ -145,14 +193,26 @@ void ConnectorBase::draw(bool blocked)
           if(source)
             {
               std::cout << "Connecting " << source->parent()->id() << " to " << parent()->id() << "\n";
+              std::vector<Node::Connection> before = getConnections(this);
+              std::vector<Node::Connection> sourceCons = getConnections(source);
+              before.insert(before.end(), sourceCons.begin(), sourceCons.end());
               connect(source);
+              std::vector<Node::Connection> after = getConnections(this);
+              sourceCons = getConnections(source);
+              after.insert(after.end(), sourceCons.begin(), sourceCons.end());
+              mParent->getGraph()->recordConnect(before, after);
             }
         }
       ImGui::EndDragDropTarget();
     }
   if(ImGui::BeginPopupContextItem(("nodeContext"+std::to_string(conId())).c_str()))
     {
-      if(ImGui::MenuItem("Disconnect All")) { disconnectAll(); }
+      if(ImGui::MenuItem("Disconnect All"))
+        {
+          std::vector<Node::Connection> before = getConnections(this);
+          disconnectAll();
+          mParent->getGraph()->recordConnect(before, {});
+        }
       ImGui::EndPopup();
     }
   if(ImGui::IsMouseReleased(ImGuiMouseButton_Left)) { endConnecting(); }   // LEFT MOUSE UP -- stop connecting
@@ -179,37 +239,38 @@ void ConnectorBase::drawConnections(ImDrawList *nodeDrawList, ImDrawList *graphD
   Vec2f offsetPos = graphPos;
   Vec2f protrudePos = getProtrudePos();
   
-  std::vector<Vec2f> connectLines;
+  std::vector<Vec2f> mouseLines;
+  const std::vector<Vec2f> *connectLines = &mouseLines;
   // connecting (draw line to mouse)
   if(isConnecting())
     { // use foreground drawlist (only while actively connecting, otherwise connections will show above file dialog)
       ImDrawList *fgDrawList = ImGui::GetForegroundDrawList();
-      if(mDirection == CONNECTOR_OUTPUT) { connectLines = graph->findOrthogonalPath(offsetPos, graph->screenToGraph(ImGui::GetMousePos())); }
-      else                               { connectLines = graph->findOrthogonalPath(graph->screenToGraph(ImGui::GetMousePos()), offsetPos); }
-      for(int i = 0; i < connectLines.size()-1; i++)
-        { fgDrawList->AddLine(graph->graphToScreen(connectLines[i]), graph->graphToScreen(connectLines[i+1]), ImColor(connectingColor), connectingW); }
-      for(int i = 1; i < connectLines.size()-1; i++)
-        { fgDrawList->AddCircleFilled(graph->graphToScreen(connectLines[i]), 3.0f*scale, ImColor(connectDotColor), 20); }
+      if(mDirection == CONNECTOR_OUTPUT) { mouseLines = graph->findOrthogonalPath(offsetPos, graph->screenToGraph(ImGui::GetMousePos())); }
+      else                               { mouseLines = graph->findOrthogonalPath(graph->screenToGraph(ImGui::GetMousePos()), offsetPos); }
+      for(int i = 0; i < mouseLines.size()-1; i++)
+        { fgDrawList->AddLine(graph->graphToScreen(mouseLines[i]), graph->graphToScreen(mouseLines[i+1]), ImColor(connectingColor), connectingW); }
+      for(int i = 1; i < mouseLines.size()-1; i++)
+        { fgDrawList->AddCircleFilled(graph->graphToScreen(mouseLines[i]), 3.0f*scale, ImColor(connectDotColor), 20); }
     }
   else if(mConnected.size() > 0)
-    { // draw connection line(s)
+    { // draw connection line(s) -- routed paths cached by graph
       for(auto con : mConnected)
         {
-          Vec2f offsetPos2 = con->graphPos;
-          Vec2f protrudePos2 = con->getProtrudePos();
-          if(mDirection == CONNECTOR_OUTPUT) { connectLines = graph->findOrthogonalPath(offsetPos, offsetPos2); }
-          else                               { connectLines = graph->findOrthogonalPath(offsetPos2, offsetPos); }          
-          for(int i = 0; i < connectLines.size()-1; i++)
-            { graphDrawList->AddLine(graph->graphToScreen(connectLines[i]), graph->graphToScreen(connectLines[i+1]), ImColor(connectedColor), connectedW); }
-          for(int i = 1; i < connectLines.size()-1; i++)
-            { graphDrawList->AddCircleFilled(graph->graphToScreen(connectLines[i]), 3.0f*scale, ImColor(connectDotColor), 20); }
+          if(mDirection == CONNECTOR_OUTPUT) { connectLines = &graph->getRoute(this, con); }
+          else                               { connectLines = &graph->getRoute(con, this); }
+          const std::vector<Vec2f> &lines = *connectLines;
+          for(int i = 0; i < lines.size()-1; i++)
+            { graphDrawList->AddLine(graph->graphToScreen(lines[i]), graph->graphToScreen(lines[i+1]), ImColor(connectedColor), connectedW); }
+          for(int i = 1; i < lines.size()-1; i++)
+            { graphDrawList->AddCircleFilled(graph->graphToScreen(lines[i]), 3.0f*scale, ImColor(connectDotColor), 20); }
         }
     }
-  if(isConnecting() || mConnected.size() > 0 && connectLines.size() > 1)
+  const std::vector<Vec2f> &lines = *connectLines;
+  if(isConnecting() || mConnected.size() > 0 && lines.size() > 1)
     { // draw first and last lines over node window
-      nodeDrawList->AddLine(graph->graphToScreen(connectLines[0]), graph->graphToScreen(connectLines[1]),
+      nodeDrawList->AddLine(graph->graphToScreen(lines[0]), graph->graphToScreen(lines[1]),
                             ImColor(connectedColor), 3.0f*scale);
-      nodeDrawList->AddLine(graph->graphToScreen(connectLines[connectLines.size()-2]), graph->graphToScreen(connectLines[connectLines.size()-1]),
+      nodeDrawList->AddLine(graph->graphToScreen(lines[lines.size()-2]), graph->graphToScreen(lines[lines.size()-1]),
                             ImColor(connectedColor), 3.0f*scale);
     }
   // draw connection dot
@@ -241,9 +302,34 @@ Node::~Node()
 void Node::setPos(const Vec2f &p)
 {
   mParams->rect.setPos(p);
+  updateRect();
   bringToFront();
 }
 
+void Node::setSize(const Vec2f &s)
+{
+  if(s != mParams->rect.size()) { mParams->rect.setSize(s); updateRect(); }
+}
+
+void Node::setRect(const Rect2f &r)
+{
+  mParams->rect = r;
+  updateRect();
+}
+
+void Node::updateRect()
+{
+  // connector centers (graph space -- valid whether or not node is drawn)
+  for(int i = 0; i < mInputs.size(); i++)
+    { mInputs[i]->graphPos = rect().p1 + CONNECTOR_PADDING + CONNECTOR_SIZE/2.0f + Vec2f(0.0f, i*(CONNECTOR_SIZE.y + CONNECTOR_PADDING.y)); }
+  for(int i = 0; i < mOutputs.size(); i++)
+    {
+      mOutputs[i]->graphPos = Vec2f(rect().p2.x - CONNECTOR_PADDING.x - CONNECTOR_SIZE.x/2.0f,
+                                    rect().p1.y + CONNECTOR_PADDING.y + CONNECTOR_SIZE.y/2.0f + i*(CONNECTOR_SIZE.y + CONNECTOR_PADDING.y));
+    }
+  if(mGraph) { mGraph->nodeMoved(this); }
+}
+
 float Node::getScale() const
 { return mGraph->getScale(); }
 
@@ -252,7 +338,8 @@ ViewSettings* Node::getViewSettings()
 
 void Node::bringToFront()
 {
-  mParams->z = NODE_TOP_Z;
+  if(mGraph) { mGraph->raiseNode(this); }
+  else       { mParams->z = NODE_TOP_Z; } // (ranked when added to a graph)
 }
 
 std::vector<Node::Connection> Node::getInputConnections()
@@ -478,6 +565,8 @@ bool Node::draw(ImDrawList *graphDrawList, bool blocked, bool ghost)
     
     mActive |= ImGui::IsItemActive();
     mHover  = !blocked && (ImGui::IsItemHovered() || ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows));
+    if(mHover || mActive) { mDirty = true; } // (settings may be edited through node ui -- update next frame)
+    if(!ghost) { trackEdit(mHover || mActive); }
     
     //if(mVisible)
       { // calculate size
@@ -530,9 +619,85 @@ bool Node::draw(ImDrawList *graphDrawList, bool blocked, bool ghost)
   return mVisible;
 }
 
+void Node::trackEdit(bool editing)
+{
+  if(editing && !mEditing)
+    {
+      mEditParams.clear();
+      getSaveParams(mEditParams);
+      mEditLive = isLive();
+      mEditing  = true;
+    }
+  else if(!editing && mEditing)
+    {
+      commitEdit();
+      mEditing = false;
+      mEditParams.clear();
+    }
+}
+
+void Node::commitEdit()
+{
+  if(!mEditing || !mGraph) { return; }
+  std::map<std::string, std::string> params;
+  getSaveParams(params);
+  if(!(mEditLive && isLive()))
+    {
+      std::map<std::string, std::string> oldParams, newParams;
+      for(const auto &p : params)
+        {
+          auto iter = mEditParams.find(p.first);
+          if(iter != mEditParams.end() && iter->second != p.second)
+            {
+              oldParams.emplace(*iter);
+              newParams.emplace(p);
+            }
+        }
+      if(!newParams.empty()) { mGraph->recordParams(this, oldParams, newParams); }
+    }
+  mEditParams = params;
+  mEditLive   = isLive();
+}
+
+void Node::applyParams(const std::map<std::string, std::string> &changed)
+{
+  std::map<std::string, std::string> params;
+  getSaveParams(params);
+  for(const auto &p : changed) { params[p.first] = p.second; }
+  setSaveParams(params);
+  if(mEditing) { mEditParams.clear(); getSaveParams(mEditParams); } // (not recorded as a new edit)
+  setDirty();
+}
+
+void Node::cull()
+{
+  mVisible     = false;
+  mBodyVisible = false;
+  mHover       = false;
+  mActive      = false;
+  mClicked     = false;
+  mDragging    = false;
+  trackEdit(false);
+}
+
 void Node::update()
 {
-  onUpdate();
+  // output data changed outside of onUpdate (e.g. edited through a connected node) --> update to pick it up
+  bool outChanged = false;
+  for(auto con : mOutputs)
+    {
+      if(con->pollChanged()) { con->sendSignal(NODE_SIGNAL_CHANGED); outChanged = true; }
+    }
+  bool inChanged = false;
+  for(auto con : mInputs) { inChanged |= (con->takeSignals() & NODE_SIGNAL_CHANGED); }
+  
+  if(mDirty || outChanged || inChanged || isLive())
+    {
+      mDirty = false;
+      onUpdate();
+      for(auto con : mOutputs)
+        { if(con->pollChanged()) { con->sendSignal(NODE_SIGNAL_CHANGED); } }
+    }
 }
 
 void Node::DrawInputs(bool blocked)
@@ -556,8 +721,7 @@ void Node::DrawInputs(bool blocked)
   {
     for(int i = 0; i < mInputs.size(); i++)
       {
-        mInputs[i]->draw(blocked);
-        mInputs[i]->graphPos = rect().p1+CONNECTOR_PADDING + CONNECTOR_SIZE/2.0f + Vec2f(0.0f, i*(CONNECTOR_SIZE.y + CONNECTOR_PADDING.y));
+        mInputs[i]->draw(blocked); // (graphPos set by updateRect)
         ImGui::SetCursorPos(Vec2f(ImGui::GetCursorPos()) + Vec2f(0.0f, conPadding.y));
       }
   }
@@ -597,9 +761,7 @@ void Node::DrawOutputs(bool blocked)
   {
     for(int i = 0; i < mOutputs.size(); i++)
       {
-        mOutputs[i]->draw(blocked);
-        mOutputs[i]->graphPos = Vec2f(rect().p2.x - CONNECTOR_PADDING.x - CONNECTOR_SIZE.x/2.0f,
-                                      rect().p1.y + CONNECTOR_PADDING.y + CONNECTOR_SIZE.y/2.0f + i*(CONNECTOR_SIZE.y + CONNECTOR_PADDING.y));
+        mOutputs[i]->draw(blocked); // (graphPos set by updateRect)
         ImGui::SetCursorPos(Vec2f(ImGui::GetCursorPos()) + Vec2f(0.0f, conPadding.y));
       }
   }
@@ -641,9 +803,8 @@ std::map<std::string, std::string> Node::getSaveHeader(const std::string &saveSt
   return header;
 }
 
-std::string Node::toSaveString() const
+std::map<std::string, std::string>& Node::getParams(std::map<std::string, std::string> &params) const
 {
-  std::map<std::string, std::string> params;
   params.emplace("nodeType", type());
   params.emplace("nodeName", mParams->name);
   params.emplace("nodeId",   std::to_string(id()));
@@ -652,7 +813,13 @@ std::string Node::toSaveString() const
   params.emplace("bodySize", mBodySize.toString());
   params.emplace("inputsSize", mInputsSize.toString());
   params.emplace("outputsSize", mOutputsSize.toString());
-  getSaveParams(params);
+  return getSaveParams(params);
+}
+
+std::string Node::toSaveString() const
+{
+  std::map<std::string, std::string> params;
+  getParams(params);
       
   std::ostringstream ss;
   ss << "NODE { ";
@@ -666,26 +833,16 @@ std::string Node::toSaveString() const
 std::string Node::fromSaveString(const std::string &saveStr)
 {
   // convert string to params
-  std::map<std::string, std::string> params;
-  std::istringstream ss(saveStr);
-  std::string temp, nodeType;
-  ss >> temp; // "NODE {"
-  ss.ignore(2, '{');
-  std::string name, value;
-  do
-    {
-      ss >> name;
-      ss.ignore(2, ':');
-      ss >> std::quoted(value);
-      ss.ignore(2, ',');
-      if(!name.empty() && name != "\n" && name.find("}") == std::string::npos && value.find("}") == std::string::npos)
-        {
-          std::cout << "     -->  '" << name << "' = '" << value << "'\n";
-          params.emplace(name, value);
-        }
-    } while(!name.empty() && name != "\n" && name.find("}") == std::string::npos && value.find("}") == std::string::npos);
-  
+  std::map<std::string, std::string> params = ProjectFile::parseNodeParams(saveStr);
+  setParams(params);
+  return "";
+}
+
+void Node::setParams(std::map<std::string, std::string> &params)
+{
   // load stored values
+  std::istringstream ss;
+  std::string nodeType;
   ss.str(params["nodeType"]); ss.clear();
   ss >> nodeType;
   ss.str(params["nodeName"]); ss.clear();
@@ -712,5 +869,44 @@ std::string Node::fromSaveString(const std::string &saveStr)
   mOutputsSize = outputsSize;
   mInputsSize  = inputsSize;
   setSaveParams(params);
-  return "";
+}
+
+void Node::setParams(const std::vector<std::pair<std::string_view, std::string_view>> &params)
+{
+  auto token = [](std::string_view str) -> std::string_view
+  { // (first whitespace-separated token -- same as stream extraction)
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if(start == std::string_view::npos) { return std::string_view(); }
+    size_t end = str.find_first_of(" \t\r\n", start);
+    return str.substr(start, (end == std::string_view::npos ? end : end-start));
+  };
+  
+  setFirstFrame(false);
+  Vec2f nextPos;
+  Vec2f nextSize;
+  Vec2f bodySize;
+  Vec2f inputsSize;
+  Vec2f outputsSize;
+  mParams->id = 0;
+  
+  std::map<std::string, std::string> saveParams;
+  for(const auto &p : params)
+    {
+      if(p.first == "nodeType")         { }
+      else if(p.first == "nodeName")    { std::string_view name = token(p.second); if(!name.empty()) { mParams->name = name; } }
+      else if(p.first == "nodeId")      { std::string_view id = token(p.second); std::from_chars(id.data(), id.data()+id.size(), mParams->id); }
+      else if(p.first == "nodePos")     { nextPos.fromString(std::string(p.second)); }
+      else if(p.first == "nodeSize")    { nextSize.fromString(std::string(p.second)); }
+      else if(p.first == "bodySize")    { bodySize.fromString(std::string(p.second)); }
+      else if(p.first == "inputsSize")  { inputsSize.fromString(std::string(p.second)); }
+      else if(p.first == "outputsSize") { outputsSize.fromString(std::string(p.second)); }
+      else { saveParams.emplace(p.first, p.second); }
+    }
+  
+  setPos(nextPos);
+  setSize(nextSize);
+  mBodySize    = bodySize;
+  mOutputsSize = outputsSize;
+  mInputsSize  = inputsSize;
+  setSaveParams(saveParams);
 }
@@ -8,10 +8,18 @@ using namespace astro;
 using namespace imgui_addons;
 
 #include <fstream>
+#include <set>
+#include <unordered_set>
+#include <tuple>
+#include <chrono>
+#include <algorithm>
 #include "tools.hpp"
 
 #include "geometry.hpp"
 #include "viewSettings.hpp"
+#include "ephemerisPool.hpp"
+#include "objectRegistry.hpp"
+#include "projectBinary.hpp"
 #include "timeNode.hpp"
 #include "locationNode.hpp"
 #include "chartNode.hpp"
@@ -22,6 +30,9 @@ using namespace imgui_addons;
 #include "aspectNode.hpp"
 #include "plotNode.hpp"
 #include "moonNode.hpp"
+#include "transitNode.hpp"
+#include "midpointNode.hpp"
+
 
 
 const std::unordered_map<std::string, NodeType> NodeGraph::NODE_TYPES =
@@ -35,11 +46,13 @@ const std::unordered_map<std::string, NodeType> NodeGraph::NODE_TYPES =
    { "ChartDataNode",    {"ChartDataNode",    "Chart Data Node",    [](){ return new ChartDataNode(); }} },
    { "AspectNode",       {"AspectNode",       "Aspect Node",        [](){ return new AspectNode();    }} },
    { "PlotNode",         {"PlotNode",         "Plot Node",          [](){ return new PlotNode();      }} }, 
-   { "MoonNode",         {"MoonNode",         "Moon Node",          [](){ return new MoonNode();      }} }, };
+   { "MoonNode",         {"MoonNode",         "Moon Node",          [](){ return new MoonNode();      }} },
+   { "TransitNode",      {"TransitNode",      "Transit Node",       [](){ return new TransitNode();   }} },
+   { "MidpointNode",     {"MidpointNode",     "Midpoint Node",      [](){ return new MidpointNode();  }} }, };
 
 const std::vector<NodeGroup> NodeGraph::NODE_GROUPS =
   { {"Parameters",    {"TimeNode", "TimeSpanNode", "LocationNode"}},
-    {"Calculation",   {"ChartNode", "ProgressNode"}},
+    {"Calculation",   {"ChartNode", "ProgressNode", "TransitNode", "MidpointNode"}},
     {"Visualization", {"ChartViewNode", "ChartCompareNode", "ChartDataNode", "AspectNode", "MoonNode", "PlotNode"}}, };
 
 
@@ -66,6 +79,7 @@ NodeGraph::~NodeGraph()
 {
   clear();
   delete mFileDialog;
+  delete mBranchPool;
 }
 
 
@@ -88,131 +102,169 @@ NodeGraph::~NodeGraph()
  **/
 bool NodeGraph::saveToFile(const std::string &path)
 {
-  std::ofstream f(path, std::ios::out);
+  ProjectFile project;
   // save graph center/scale
-  f << "VERSION " << SAVE_FILE_VERSION << "\n";
-  f << "CENTER " << mGraphCenter << "\n";
-  f << "SCALE "  << mGraphScale  << "\n";
+  project.setCenter(mGraphCenter);
+  project.setScale(mGraphScale);
   // save nodes
   for(auto n : mNodes)
     {
-      std::ostringstream ss;
-      ss << n.second->toSaveString() << "\n";
-      std::cout << "--> " << ss.str();
-      f << ss.str();
+      ProjectNode node;
+      node.id   = n.first;
+      node.type = n.second->type();
+      node.name = n.second->name();
+      n.second->getParams(node.params);
+      project.addNode(node);
     }
   // save connections
   for(auto n : mNodes)
     {
       for(int i = 0; i < n.second->outputs().size(); i++)
         {
-          if(n.second->outputs()[i]->getConnected().size() == 0)
-            { continue; } // no connections
-          std::ostringstream ss;
-          ss << "CON " << n.first << " OUTPUT " << i;
-          // list all connected node ids
           for(auto con : n.second->outputs()[i]->getConnected())
-            { ss << " " << con->parent()->id() << " " << con->conId(); }
-          ss << "\n";
-          std::cout << "--> " << ss.str();
-          f << ss.str();
+            { project.addConnection(ProjectConnection{n.first, i, con->parent()->id(), con->conId()}); }
         }
     }
+  // (binary if path has PROJECT_BINARY_EXT)
+  if(!project.save(path))
+    {
+      std::cout << "ERROR: Could not save project to '" << path << "'!\n";
+      return false;
+    }
+  std::cout << "Saved project to '" << path << "' (" << mNodes.size() << " nodes)\n";
   mSaveFile = path;
   mChangedSinceSave = false;
   return true;
 }
 
-bool NodeGraph::loadFromFile(const std::string &path)
+// loads nodes/connections from text project file (.ags)
+bool NodeGraph::loadText(const std::string &path, std::string &version)
 {
-  if(fileExists(path)) // fs::exists(path) && fs::is_regular_file(path))
+  std::ifstream f(path, std::ios::in);
+  std::cout << "=============================================================================================\n";
+  std::cout << "= READING FILE '" << path << "'...\n";
+  std::cout << "=============================================================================================\n";
+  std::string line;
+  bool firstLine = true;
+  while(std::getline(f, line))
     {
-      clear();
-      std::ifstream f(path, std::ios::in);
+      if(line.empty() || line == "\n") { continue; }
+      std::istringstream ss(line);
+      std::string lineType, type, name;
+      ss >> lineType;
+
+      if(lineType == "VERSION" || firstLine)
+        { // save file version
+          if(lineType == "VERSION") { ss >> version; }
+          std::cout << "= VERSION: " << version << "\n";
+          if(version != SAVE_FILE_VERSION)
+            { std::cout << "= WARNING: Save file may be out of date! (current version: " << SAVE_FILE_VERSION << ")\n"; }
+          std::cout << "=============================================================================================\n";
+        }
+      firstLine = false;
 
-      std::cout << "=============================================================================================\n";
-      std::cout << "= READING FILE '" << path << "'...\n";
-      std::cout << "=============================================================================================\n";
-      std::string line;
-      std::string version="0.0";
-      bool firstLine = true;
-      while(std::getline(f, line))
+      if(lineType == "CENTER")
+        { ss >> std::ws >> mGraphCenter; } // (skip space before "<")
+      else if(lineType == "SCALE")
+        { ss >> mGraphScale; }
+      else if(lineType == "NODE")
         {
-          if(line.empty() || line == "\n") { continue; }
-          std::istringstream ss(line);
-          std::string lineType, type, name;
-          int id;
-          Vec2f pos;
-          ss >> lineType;
-
-          if(lineType == "VERSION" || firstLine)
-            { // save file version
-              if(lineType == "VERSION") { ss >> version; }
-              std::cout << "= VERSION: " << version << "\n";
-              if(version != SAVE_FILE_VERSION)
-                { std::cout << "= WARNING: Save file may be out of date! (current version: " << SAVE_FILE_VERSION << ")\n"; }
-              std::cout << "=============================================================================================\n";
-            }
-          firstLine = false;
-
-          if(lineType == "CENTER")
-            { ss >> mGraphCenter; }
-          else if(lineType == "SCALE")
-            { ss >> mGraphScale; }
-          else if(lineType == "NODE")
+          std::map<std::string, std::string> params = ProjectFile::parseNodeParams(line); // (tokenized once)
+          type = params["nodeType"];
+          name = params["nodeName"];
+          Node *newNode = makeNode(type);
+          if(newNode)
             {
-              std::map<std::string, std::string> saveHeader = Node::getSaveHeader(line);
-              type = saveHeader["nodeType"];
-              name = saveHeader["nodeName"];
-              pos.fromString(saveHeader["nodePos"]);
-              ss.str(saveHeader["nodeId"]); ss >> id;
-              
-              std::cout << " --> ADDING NODE '" << name << "': type=" << type << " | id=" << id << " | pos=" << pos << "\n";
-              Node *newNode = makeNode(type);
-              if(newNode)
-                {
-                  newNode->fromSaveString(line);
-                  std::cout << "N" << id << " --> " << newNode->id() << "\n";
-                  newNode->setGraph(this);
-                  mNodes.emplace(newNode->id(), newNode);
-                }
-              else
-                { std::cout << "ERROR: Could not load Node '" << name << "'!\n"; }
+              newNode->setParams(params);
+              newNode->setGraph(this);
+              mNodes.emplace(newNode->id(), newNode);
+              nodesChanged();
             }
-          else if(lineType == "CON")
-            { // load connections
-              for(auto n : mNodes) { std::cout << n.first << " --> " << n.second->id() << "\n"; }
-              std::stringstream ss(line);
-              std::string temp, io;
-              int nId, cId;
-              ss >> temp; // "CON "
-              ss >> nId;  // node id
-              ss >> io;   // always OUTPUT (TODO: ?)
-              ss >> cId;  // output connector index
-
-              ConnectorBase *con = nullptr;
-              if(mNodes[nId]->outputs().size() > cId)
-                { con = mNodes[nId]->outputs()[cId]; }
-              else
-                { std::cout << "WARNING: Node connector missing! May be an old save file.\n"; continue; }
-
-              std::cout << "SS: '" << ss.str() << "'\n";
-
-              while(!ss.eof())
-                { // check if end of line
-                  ss >> std::skipws;
-                  if(ss.str().substr(ss.tellg()).empty()) { break; }
-                  // read connection ids
-                  int nId2, cId2;
-                  ss >> nId2; ss >> cId2;
-                  std::cout << "|  Connecting N" << nId << "[C" << cId << "] --> N" << nId2 << "[C" << cId2 << "] \n";
-                  std::cout << "(" << mNodes[nId]->outputs().size() << "|" << mNodes[nId2]->inputs().size() << ")\n";
-                  ConnectorBase *con2 = mNodes[nId2]->inputs()[cId2];
-                  // force connection
-                  if(!con->connect(con2)) { std::cout << "Failed to connect!\n"; }
-                }
+          else
+            { std::cout << "ERROR: Could not load Node '" << name << "'!\n"; }
+        }
+      else if(lineType == "CON")
+        { // load connections
+          std::stringstream ss(line);
+          std::string temp, io;
+          int nId, cId;
+          ss >> temp; // "CON "
+          ss >> nId;  // node id
+          ss >> io;   // always OUTPUT (TODO: ?)
+          ss >> cId;  // output connector index
+
+          ConnectorBase *con = nullptr;
+          if(mNodes[nId]->outputs().size() > cId)
+            { con = mNodes[nId]->outputs()[cId]; }
+          else
+            { std::cout << "WARNING: Node connector missing! May be an old save file.\n"; continue; }
+
+          while(!ss.eof())
+            { // check if end of line
+              ss >> std::skipws;
+              if(ss.str().substr(ss.tellg()).empty()) { break; }
+              // read connection ids
+              int nId2, cId2;
+              ss >> nId2; ss >> cId2;
+              ConnectorBase *con2 = mNodes[nId2]->inputs()[cId2];
+              // force connection
+              if(!con->connect(con2)) { std::cout << "Failed to connect!\n"; }
             }
         }
+    }
+  return true;
+}
+
+// loads nodes/connections from binary project file (.agb) -- reads the mapped tables in place
+bool NodeGraph::loadBinary(const std::string &path, std::string &version)
+{
+  ProjectBinary project;
+  if(!project.open(path)) { return false; }
+  version      = std::string(project.version());
+  mGraphCenter = project.center();
+  mGraphScale  = project.scale();
+
+  std::vector<std::pair<std::string_view, std::string_view>> params; // (views into mapped string table)
+  for(int i = 0; i < project.nodeCount(); i++)
+    {
+      const ProjectBinaryNode &bn = project.node(i);
+      Node *newNode = makeNode(std::string(project.str(bn.type)));
+      if(!newNode)
+        { std::cout << "ERROR: Could not load Node '" << project.str(bn.name) << "' (type " << project.str(bn.type) << ")!\n"; continue; }
+      params.clear();
+      const ProjectBinaryParam *p = project.params(i);
+      for(uint32_t j = 0; j < bn.paramCount; j++)
+        { params.emplace_back(project.str(p[j].key), project.str(p[j].value)); }
+      newNode->setParams(params);
+      newNode->setGraph(this);
+      if(!mNodes.emplace(newNode->id(), newNode).second)
+        { std::cout << "WARNING: Duplicate node id (" << newNode->id() << ")!\n"; delete newNode; }
+    }
+  for(int i = 0; i < project.connectionCount(); i++)
+    {
+      const ProjectBinaryConnection &c = project.connection(i);
+      auto out = mNodes.find(c.outNode);
+      auto in  = mNodes.find(c.inNode);
+      if(out == mNodes.end() || in == mNodes.end() || c.outIndex < 0 || c.inIndex < 0 ||
+         c.outIndex >= out->second->outputs().size() || c.inIndex >= in->second->inputs().size())
+        { std::cout << "WARNING: Node connector missing! (N" << c.outNode << "[C" << c.outIndex << "] --> N" << c.inNode << "[C" << c.inIndex << "])\n"; continue; }
+      if(!out->second->outputs()[c.outIndex]->connect(in->second->inputs()[c.inIndex]))
+        { std::cout << "Failed to connect!\n"; }
+    }
+  nodesChanged();
+  std::cout << "= Loaded binary project '" << path << "' (" << mNodes.size() << " nodes, " << project.connectionCount() << " connections)\n";
+  return true;
+}
+
+bool NodeGraph::loadFromFile(const std::string &path)
+{
+  if(fileExists(path)) // fs::exists(path) && fs::is_regular_file(path))
+    {
+      clear();
+      std::string version = "0.0";
+      bool loaded = (ProjectBinary::isBinary(path) ? loadBinary(path, version) : loadText(path, version));
+      if(!loaded) { clear(); return false; }
+      
       // new node ids start right after maximum saved id
       int maxId = -1;
       for(auto n : mNodes)
@@ -222,12 +274,8 @@ bool NodeGraph::loadFromFile(const std::string &path)
         }
       Node::NEXT_ID = maxId + 1;
 
-      mSaveFile = path;      
-      for(auto n : mNodes)
-        {
-          n.second->update();
-          n.second->setChanged(false);
-        }
+      mSaveFile = path;
+      update(); // (all nodes dirty -- evaluated once in order)
       mChangedSinceSave = false;
       std::cout << "=============================================================================================\n";
       if(version != SAVE_FILE_VERSION)
@@ -294,15 +342,21 @@ void NodeGraph::addNode(Node *n, bool select)
       mChangedSinceSave = true;
       n->setGraph(this);
       mNodes.emplace(n->id(), n);
+      nodesChanged();
       if(select) { deselectAll(); n->setSelected(true); }
     }
 }
 
 void NodeGraph::clear()
 {
+  clearHistory();
   for(auto n : mNodes) { delete n.second; }
   mNodes.clear();
+  mDrawNodes.clear();
+  mLastDrawn.clear();
   mNodes = std::unordered_map<int, Node*>(); // clear nodes and free allocation
+  mOrder.clear();
+  nodesChanged();
   Node::NEXT_ID = 0;
   mSaveFile = "";
   mGraphCenter = Vec2f(0,0);
@@ -319,13 +373,9 @@ void NodeGraph::cut()
       for(auto n : mClipboard) { delete n; }
       mClipboard.clear();
       
-      // disconnect cut group from other nodes
-      disconnectExternal(selected, true, true);
-      for(auto n : selected) { mNodes.erase(n->id()); }
-      
-      // move selected nodes to clipboard
-      mClipboard = selected;
-      mChangedSinceSave = true;
+      // copy selected nodes to clipboard (internal connections only), then remove them (kept in undo history)
+      mClipboard = makeCopies(selected, false);
+      removeNodes(selected);
     }
 }
 
@@ -377,9 +427,9 @@ void NodeGraph::paste()
 
 bool NodeGraph::isConnecting()
 {
-  for(auto n : mNodes)
+  for(auto n : mDrawNodes) // (connecting nodes are always drawn)
     {
-      if(n.second->isConnecting())
+      if(n->isConnecting())
         { return true; }
     }
   return false;
@@ -432,6 +482,7 @@ void NodeGraph::moveSelected(const Vec2f &dpos)
           if(n.second->isSelected())
             { n.second->setPos(n.second->pos() + dpos); }
         }
+      recordMove(getSelected(), dpos);
       mChangedSinceSave = true;
     }
 }
@@ -545,12 +596,211 @@ void NodeGraph::copySelected()
           n->bringToFront();
           addNode(n, false);
         }
+      recordAdd(newNodes);
       mChangedSinceSave = true;
       mClickCopied = true;
     }
 }
 
 
+//// UNDO HISTORY ////
+
+void NodeGraph::pushAction(GraphAction *action)
+{
+  for(auto a : mRedoStack) { delete a; }
+  mRedoStack.clear();
+  mUndoStack.push_back(action);
+  size_t historySize = (size_t)std::max(0, (mViewSettings ? mViewSettings->graphHistory : GRAPH_HISTORY_DEFAULT));
+  while(mUndoStack.size() > historySize) { delete mUndoStack.front(); mUndoStack.pop_front(); }
+  mChangedSinceSave = true;
+}
+
+void NodeGraph::clearHistory()
+{
+  for(auto a : mUndoStack) { delete a; }
+  for(auto a : mRedoStack) { delete a; }
+  mUndoStack.clear();
+  mRedoStack.clear();
+}
+
+bool NodeGraph::connect(const Node::Connection &con)
+{
+  auto outIter = mNodes.find(con.nodeOut);
+  auto inIter  = mNodes.find(con.nodeIn);
+  if(outIter == mNodes.end() || inIter == mNodes.end() ||
+     con.conOut < 0 || con.conOut >= outIter->second->outputs().size() || con.conIn < 0 || con.conIn >= inIter->second->inputs().size())
+    { std::cout << "WARNING: NodeGraph::connect() --> invalid connection (" << con.nodeOut << "[" << con.conOut << "] --> " << con.nodeIn << "[" << con.conIn << "])\n"; return false; }
+  ConnectorBase *out = outIter->second->outputs()[con.conOut];
+  ConnectorBase *in  = inIter->second->inputs()[con.conIn];
+  for(auto c : out->getConnected()) { if(c == in) { return true; } } // (already connected -- connect() would toggle)
+  return out->connect(in);
+}
+
+void NodeGraph::disconnect(const Node::Connection &con)
+{
+  auto outIter = mNodes.find(con.nodeOut);
+  auto inIter  = mNodes.find(con.nodeIn);
+  if(outIter != mNodes.end() && inIter != mNodes.end() &&
+     con.conOut >= 0 && con.conOut < outIter->second->outputs().size() && con.conIn >= 0 && con.conIn < inIter->second->inputs().size())
+    { outIter->second->outputs()[con.conOut]->disconnect(inIter->second->inputs()[con.conIn]); }
+}
+
+void NodeGraph::detachNodes(GraphAction *action)
+{
+  // save connections (inputs of each node, outputs to nodes outside the group)
+  std::unordered_set<int> group;
+  for(auto n : action->nodes) { group.insert(n->id()); }
+  action->removed.clear();
+  for(auto n : action->nodes)
+    {
+      for(const auto &c : n->getInputConnections())  { action->removed.push_back(c); }
+      for(const auto &c : n->getOutputConnections()) { if(group.count(c.nodeIn) == 0) { action->removed.push_back(c); } }
+    }
+  for(auto n : action->nodes)
+    {
+      n->disconnectAll();
+      n->setSelected(false);
+      n->setDragging(false);
+      mNodes.erase(n->id());
+      mDrawNodes.erase(std::remove(mDrawNodes.begin(), mDrawNodes.end(), n), mDrawNodes.end());
+      mLastDrawn.erase(std::remove(mLastDrawn.begin(), mLastDrawn.end(), n), mLastDrawn.end());
+    }
+  action->ownsNodes = true;
+  nodesChanged();
+}
+
+void NodeGraph::attachNodes(GraphAction *action)
+{
+  deselectAll();
+  for(auto n : action->nodes)
+    {
+      n->setGraph(this);
+      n->setSelected(true);
+      n->setDirty();
+      mNodes.emplace(n->id(), n);
+    }
+  for(const auto &c : action->removed) { connect(c); }
+  action->ownsNodes = false;
+  nodesChanged();
+}
+
+void NodeGraph::removeNodes(const std::vector<Node*> &nodes)
+{
+  if(nodes.empty()) { return; }
+  GraphAction *action = new GraphAction(ACTION_REMOVE_NODES);
+  action->nodes = nodes;
+  detachNodes(action);
+  pushAction(action);
+}
+
+void NodeGraph::recordAdd(const std::vector<Node*> &nodes)
+{
+  if(nodes.empty()) { return; }
+  GraphAction *action = new GraphAction(ACTION_ADD_NODES);
+  action->nodes = nodes;
+  pushAction(action);
+}
+
+void NodeGraph::recordMove(const std::vector<Node*> &nodes, const Vec2f &dpos)
+{
+  std::vector<int> ids;
+  for(auto n : nodes) { ids.push_back(n->id()); }
+  std::sort(ids.begin(), ids.end());
+  GraphAction *last = (mUndoStack.empty() ? nullptr : mUndoStack.back());
+  if(last && last->type == ACTION_MOVE_NODES && last->moving && last->ids == ids)
+    { last->move += dpos; return; } // (same drag)
+  GraphAction *action = new GraphAction(ACTION_MOVE_NODES);
+  action->ids    = ids;
+  action->move   = dpos;
+  action->moving = true;
+  pushAction(action);
+}
+
+void NodeGraph::recordConnect(const std::vector<Node::Connection> &before, const std::vector<Node::Connection> &after)
+{
+  typedef std::tuple<int, int, int, int> ConKey;
+  std::set<ConKey> oldCons, newCons;
+  for(const auto &c : before) { oldCons.emplace(c.nodeOut, c.conOut, c.nodeIn, c.conIn); }
+  for(const auto &c : after)  { newCons.emplace(c.nodeOut, c.conOut, c.nodeIn, c.conIn); }
+  GraphAction *action = new GraphAction(ACTION_CONNECT);
+  for(const auto &c : newCons)
+    { if(oldCons.count(c) == 0) { action->added.push_back(Node::Connection{std::get<0>(c), std::get<1>(c), std::get<2>(c), std::get<3>(c)}); } }
+  for(const auto &c : oldCons)
+    { if(newCons.count(c) == 0) { action->removed.push_back(Node::Connection{std::get<0>(c), std::get<1>(c), std::get<2>(c), std::get<3>(c)}); } }
+  if(action->added.empty() && action->removed.empty()) { delete action; return; }
+  pushAction(action);
+}
+
+void NodeGraph::recordParams(Node *n, const std::map<std::string, std::string> &oldParams, const std::map<std::string, std::string> &newParams)
+{
+  if(!n || newParams.empty()) { return; }
+  GraphAction *action = new GraphAction(ACTION_CHANGE_PARAMS);
+  action->ids       = { n->id() };
+  action->oldParams = oldParams;
+  action->newParams = newParams;
+  pushAction(action);
+}
+
+void NodeGraph::applyAction(GraphAction *action, bool undo)
+{
+  switch(action->type)
+    {
+    case ACTION_ADD_NODES:
+      if(undo) { detachNodes(action); } else { attachNodes(action); }
+      break;
+    case ACTION_REMOVE_NODES:
+      if(undo) { attachNodes(action); } else { detachNodes(action); }
+      break;
+    case ACTION_MOVE_NODES:
+      for(auto id : action->ids)
+        {
+          auto iter = mNodes.find(id);
+          if(iter != mNodes.end()) { iter->second->setPos(iter->second->pos() + (undo ? -1.0f : 1.0f)*action->move); }
+        }
+      break;
+    case ACTION_CONNECT:
+      for(const auto &c : (undo ? action->added : action->removed)) { disconnect(c); }
+      for(const auto &c : (undo ? action->removed : action->added)) { connect(c); }
+      break;
+    case ACTION_CHANGE_PARAMS:
+      for(auto id : action->ids)
+        {
+          auto iter = mNodes.find(id);
+          if(iter != mNodes.end()) { iter->second->applyParams(undo ? action->oldParams : action->newParams); }
+        }
+      break;
+    default:
+      break;
+    }
+  mChangedSinceSave = true;
+}
+
+bool NodeGraph::undo()
+{
+  if(mLocked) { return false; }
+  for(auto n : mNodes) { n.second->commitEdit(); } // (record edits still in progress first)
+  if(mUndoStack.empty()) { return false; }
+  GraphAction *action = mUndoStack.back();
+  mUndoStack.pop_back();
+  action->moving = false;
+  applyAction(action, true);
+  mRedoStack.push_back(action);
+  return true;
+}
+
+bool NodeGraph::redo()
+{
+  if(mLocked) { return false; }
+  for(auto n : mNodes) { n.second->commitEdit(); }
+  if(mRedoStack.empty()) { return false; }
+  GraphAction *action = mRedoStack.back();
+  mRedoStack.pop_back();
+  applyAction(action, false);
+  mUndoStack.push_back(action);
+  return true;
+}
+
+
 bool NodeGraph::isHovered() const
 {
   return Rect2f(mViewPos, mViewSize).contains(ImGui::GetMousePos());
@@ -558,9 +808,9 @@ bool NodeGraph::isHovered() const
 
 bool NodeGraph::isSelectedHovered()
 {
-  for(auto n : mNodes)
+  for(auto n : mDrawNodes) // (culled nodes are never hovered)
     {
-      if(n.second->isSelected() && n.second->isHovered())
+      if(n->isSelected() && n->isHovered())
         { return true; }
     }
   return false;
@@ -568,9 +818,9 @@ bool NodeGraph::isSelectedHovered()
 
 bool NodeGraph::isSelectedActive()
 {
-  for(auto n : mNodes)
+  for(auto n : mDrawNodes) // (culled nodes are never active)
     {
-      if(n.second->isSelected() && n.second->isActive())
+      if(n->isSelected() && n->isActive())
         { return true; }
     }
   return false;
@@ -578,9 +828,9 @@ bool NodeGraph::isSelectedActive()
 
 bool NodeGraph::isSelectedDragged()
 {
-  for(auto n : mNodes)
+  for(auto n : mDrawNodes) // (dragged nodes are always drawn)
     {
-      if(n.second->isSelected() && n.second->isDragging())
+      if(n->isSelected() && n->isDragging())
         { return true; }
     }
   return false;
@@ -668,15 +918,216 @@ void NodeGraph::EndDraw()
   ImGui::PopStyleVar(2);
 }
 
+void NodeGraph::updateOrder()
+{
+  if(!mOrderDirty && mOrderConnections == ConnectorBase::CONNECTION_VERSION && mOrder.size() == mNodes.size()) { return; }
+  mOrderDirty       = false;
+  mOrderConnections = ConnectorBase::CONNECTION_VERSION;
+  mOrder.clear();
+
+  std::vector<Node*> nodes;
+  for(auto n : mNodes) { nodes.push_back(n.second); }
+  std::sort(nodes.begin(), nodes.end(), [](Node *n1, Node *n2) { return n1->id() < n2->id(); });
+
+  // count inputs from other nodes in graph
+  std::unordered_map<Node*, int> inputCount;
+  for(auto n : nodes) { inputCount.emplace(n, 0); }
+  for(auto n : nodes)
+    {
+      for(auto con : n->inputs())
+        {
+          for(auto other : con->getConnected())
+            { if(inputCount.count(other->parent()) > 0) { inputCount[n]++; } }
+        }
+    }
+  
+  // Kahn's algorithm (ready nodes taken by id -- same order every rebuild)
+  std::set<std::pair<int, Node*>> ready;
+  for(auto n : nodes) { if(inputCount[n] == 0) { ready.emplace(n->id(), n); } }
+  while(!ready.empty())
+    {
+      Node *n = ready.begin()->second;
+      ready.erase(ready.begin());
+      mOrder.push_back(n);
+      for(auto con : n->outputs())
+        {
+          for(auto other : con->getConnected())
+            {
+              auto iter = inputCount.find(other->parent());
+              if(iter != inputCount.end() && --iter->second == 0) { ready.emplace(iter->first->id(), iter->first); }
+            }
+        }
+    }
+  // nodes in cycles (updated last -- changes around a cycle take a frame per loop)
+  for(auto n : nodes) { if(inputCount[n] > 0) { mOrder.push_back(n); } }
+
+  // independent branches (flood fill over connections in both directions)
+  std::unordered_map<Node*, int> branch;
+  int numBranches = 0;
+  for(auto n : mOrder)
+    {
+      if(branch.count(n) > 0) { continue; }
+      std::vector<Node*> stack = { n };
+      branch.emplace(n, numBranches);
+      while(!stack.empty())
+        {
+          Node *b = stack.back(); stack.pop_back();
+          for(const auto *cons : { &b->inputs(), &b->outputs() })
+            {
+              for(auto con : *cons)
+                {
+                  for(auto other : con->getConnected())
+                    {
+                      Node *o = other->parent();
+                      if(inputCount.count(o) > 0 && branch.emplace(o, numBranches).second) { stack.push_back(o); }
+                    }
+                }
+            }
+        }
+      numBranches++;
+    }
+  mBranches.assign(numBranches, std::vector<Node*>());
+  for(auto n : mOrder) { mBranches[branch[n]].push_back(n); } // (keeps topological order within each branch)
+  // largest branches first (claimed by workers before small ones -- shorter tail)
+  std::stable_sort(mBranches.begin(), mBranches.end(),
+                   [](const std::vector<Node*> &b1, const std::vector<Node*> &b2) { return b1.size() > b2.size(); });
+}
+
+void NodeGraph::updateIndex()
+{
+  if(!mIndexDirty) { return; }
+  mIndexDirty = false;
+  mNodeIndex.clear();
+  for(auto n : mNodes) { mNodeIndex.insert(n.first, n.second->rect()); }
+}
+
+void NodeGraph::updateZ()
+{
+  if(!mZDirty) { return; }
+  mZDirty = false;
+  std::vector<Node*> sorted;
+  sorted.reserve(mNodes.size());
+  for(auto n : mNodes) { sorted.push_back(n.second); }
+  std::sort(sorted.begin(), sorted.end(), [](const Node *n1, const Node *n2) -> bool
+            { return (n1->getZ() < n2->getZ()) || (n1->getZ() == n2->getZ() && n1->id() < n2->id()); });
+  for(int i = 0; i < (int)sorted.size(); i++) { sorted[i]->setZ(i); }
+  mTopZ = (float)sorted.size() - 1.0f;
+}
+
+void NodeGraph::raiseNode(Node *n)
+{
+  if(mZDirty) { n->setZ(NODE_TOP_Z); return; } // (ranked by next updateZ)
+  if(n->getZ() == mTopZ) { return; }           // (already in front)
+  mTopZ += 1.0f;
+  n->setZ(mTopZ);
+  if(mTopZ >= NODE_TOP_Z) { mZDirty = true; }  // (compacted before float precision runs out)
+}
+
+void NodeGraph::updateConnectionIndex()
+{
+  if(!mConnectionsDirty && mConnectionsVersion == ConnectorBase::CONNECTION_VERSION) { return; }
+  mConnectionsDirty   = false;
+  mConnectionsVersion = ConnectorBase::CONNECTION_VERSION;
+  mConnectionIndex.clear();
+  mConnectionList.clear();
+  for(auto n : mNodes)
+    {
+      for(auto con : n.second->outputs())
+        {
+          for(auto other : con->getConnected())
+            {
+              mConnectionIndex.insert((int)mConnectionList.size(), Rect2f(con->graphPos, other->graphPos).fixed().expanded(ORTHO_PADDING));
+              mConnectionList.emplace_back(con, other);
+            }
+        }
+    }
+}
+
+void NodeGraph::nodeMoved(Node *n)
+{
+  mConnectionsDirty = true;
+  if(mIndexDirty) { return; }
+  const Rect2f *oldRect = mNodeIndex.getRect(n->id());
+  if(oldRect) // (ignored if not in graph -- e.g. ghost/clipboard nodes)
+    {
+      mRouter.obstacleMoved(*oldRect, n->rect());
+      mNodeIndex.update(n->id(), n->rect());
+    }
+}
+
+const std::vector<Vec2f>& NodeGraph::getRoute(ConnectorBase *out, ConnectorBase *in)
+{
+  auto inGraph = [this](ConnectorBase *con)
+  {
+    auto iter = mNodes.find(con->parent()->id());
+    return (iter != mNodes.end() && iter->second == con->parent());
+  };
+  if(!inGraph(out) || !inGraph(in))
+    { // (not cached -- e.g. ghost/clipboard nodes)
+      mRouteScratch = findOrthogonalPath(out->graphPos, in->graphPos);
+      return mRouteScratch;
+    }
+  updateIndex();
+  if(mRouteConnections != ConnectorBase::CONNECTION_VERSION)
+    { // drop routes of removed connections
+      mRouteConnections = ConnectorBase::CONNECTION_VERSION;
+      mRouter.prune([](const ConnectorBase *o, const ConnectorBase *i) { return !o->isConnectedTo(i); });
+    }
+  return mRouter.get(out, in, out->graphPos, in->graphPos);
+}
+
+Node* NodeGraph::nodeAt(const Vec2f &p)
+{
+  updateIndex();
+  std::vector<int> ids;
+  mNodeIndex.queryPoint(p, ids);
+  Node *top = nullptr;
+  for(auto id : ids)
+    {
+      Node *n = mNodes[id];
+      if(!top || n->getZ() > top->getZ() || (n->getZ() == top->getZ() && n->id() > top->id())) { top = n; }
+    }
+  return top;
+}
+
+int NodeGraph::updatePool()
+{
+  int threads = (mViewSettings ? mViewSettings->graphThreads : 0);
+  if(threads <= 0) { threads = std::thread::hardware_concurrency(); } // (auto)
+  threads = std::max(1, std::min(threads, GRAPH_THREADS_MAX));
+  if(threads == 1)
+    { delete mBranchPool; mBranchPool = nullptr; } // (serial)
+  else if(!mBranchPool || mBranchPool->size() != threads)
+    {
+      delete mBranchPool;
+      mBranchPool = new EphemerisPool(threads); // (each worker initializes its own swe context)
+    }
+  return threads;
+}
+
 void NodeGraph::update()
 {
+  updateOrder();
+  updatePool();
+  auto t0 = std::chrono::steady_clock::now();
+  
+  // update nodes (dirty/signaled only)
+  if(mBranchPool && mBranches.size() > 1)
+    { // branches share no connections -- each is updated in order by a single worker
+      ObjectRegistry::instance().snapshot(); // (rebuilt here on the main thread if registry changed -- charts on workers only load it)
+      mBranchPool->parallel_for(mBranches.size(), [this](Ephemeris &swe, int b)
+                                { for(auto n : mBranches[b]) { n->update(); } });
+    }
+  else
+    { for(auto n : mOrder) { n->update(); } }
+
   bool changed = false;
-  for(auto n : mNodes)
+  for(auto n : mOrder)
     {
-      n.second->update();
-      changed |= n.second->hasChanged();
-      n.second->setChanged(false);
-    } // update nodes
+      changed |= n->hasChanged();
+      n->setChanged(false);
+    }
+  mUpdateTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
   
   // TODO: Indicator for unsaved changed (file name tabs with asterisk?)
   
@@ -698,7 +1149,10 @@ void NodeGraph::draw()
     
     // reset click copy flag if mouse released
     if(ImGui::IsMouseReleased(ImGuiMouseButton_Left))
-      { mClickCopied = false; }
+      {
+        mClickCopied = false;
+        if(!mUndoStack.empty()) { mUndoStack.back()->moving = false; } // (drag finished -- stop coalescing moves)
+      }
     
     // update nodes (TODO: call in main loop? (main.cpp))
     update();
@@ -715,36 +1169,66 @@ void NodeGraph::draw()
         for(auto n : mNodes)
           { if(n.second->isSelected()) { n.second->bringToFront(); } }
       }
-    // sort nodes by z value
-    std::vector<std::pair<int, Node*>> sorted(mNodes.begin(), mNodes.end());
-    std::sort(sorted.begin(), sorted.end(),
-              [](const std::pair<int, Node*> &n1, const std::pair<int, Node*> &n2) -> bool
-              { return (n1.second->getZ() < n2.second->getZ()) || (n1.second->getZ() == n2.second->getZ() && n1.first < n2.first); });
-    // clean up z ordering (z = i)
-    for(int i = 0; i < sorted.size(); i++) { sorted[i].second->setZ(i); }
-
-    // block from front to back
-    std::vector<bool> blocked(sorted.size(), false);
-    bool mouseBlocked = false;
-    for(int i = sorted.size()-1; i >= 0; i--)
-      {
-        Node *n = sorted[i].second;
-        bool b = n->rect().contains(screenToGraph(ImGui::GetMousePos()));
-        blocked[i] = mouseBlocked;
-        mouseBlocked |= b;
-      }
+    updateZ();
+
+    // cull off-screen nodes (still drawn if being created/dragged/connected)
+    updateIndex();
+    Rect2f cullRect = graphRect.expanded(screenToGraphVec(Vec2f(GRAPH_CULL_PADDING, GRAPH_CULL_PADDING)));
+    std::vector<int> visibleIds;
+    mNodeIndex.query(cullRect, visibleIds);
+    std::vector<Node*> drawNodes;
+    drawNodes.reserve(visibleIds.size() + mDrawNodes.size());
+    for(auto id : visibleIds) { drawNodes.push_back(mNodes[id]); }
+    for(auto n : mDrawNodes)
+      { if(n->isFirstFrame() || n->isDragging() || n->isConnecting()) { drawNodes.push_back(n); } }
+    // (back to front -- duplicates adjacent)
+    std::sort(drawNodes.begin(), drawNodes.end(), [](const Node *n1, const Node *n2) -> bool
+              { return (n1->getZ() < n2->getZ()) || (n1->getZ() == n2->getZ() && n1->id() < n2->id()); });
+    drawNodes.erase(std::unique(drawNodes.begin(), drawNodes.end()), drawNodes.end());
+    mDrawNodes.swap(drawNodes);
+    
+    // reset state of nodes that left the view (drawn last frame)
+    std::vector<Node*> drawn(mDrawNodes);
+    std::sort(drawn.begin(), drawn.end());
+    for(auto n : mLastDrawn)
+      { if(!std::binary_search(drawn.begin(), drawn.end(), n)) { n->cull(); } }
+    mLastDrawn.swap(drawn);
+    
+    // nodes under mouse are blocked by the top one
+    Node *mouseNode = nodeAt(screenToGraph(ImGui::GetMousePos()));
     // draw nodes
-    for(int i = 0; i < sorted.size(); i++) // draw from back to front
+    for(auto n : mDrawNodes) // draw from back to front
       {
-        sorted[i].second->draw(winDrawList, blocked[i]);
+        n->draw(winDrawList, (mouseNode && n->getZ() < mouseNode->getZ()));
         if(mShowIds)
           {
-            ImGui::SetCursorPos(graphToScreen(sorted[i].second->pos()) - mViewPos - Vec2f(0.0f, 20.0f));
-            ImGui::Text("%d", sorted[i].second->id());
+            ImGui::SetCursorPos(graphToScreen(n->pos()) - mViewPos - Vec2f(0.0f, 20.0f));
+            ImGui::Text("%d", n->id());
           }
       }
     // draw node connections
-    for(auto n : sorted) { n.second->drawConnections(winDrawList); }
+    for(auto n : mDrawNodes) { n->drawConnections(winDrawList); }
+    // (connections between off-screen nodes that cross the view)
+    updateConnectionIndex();
+    std::vector<int> crossingIds;
+    mConnectionIndex.query(cullRect, crossingIds);
+    std::vector<Node*> crossing;
+    for(auto id : crossingIds)
+      {
+        Node *n1 = mConnectionList[id].first->parent();
+        Node *n2 = mConnectionList[id].second->parent();
+        if(!std::binary_search(mLastDrawn.begin(), mLastDrawn.end(), n1) && !std::binary_search(mLastDrawn.begin(), mLastDrawn.end(), n2))
+          { crossing.push_back(n1); }
+      }
+    std::sort(crossing.begin(), crossing.end());
+    crossing.erase(std::unique(crossing.begin(), crossing.end()), crossing.end());
+    for(auto n : crossing) { n->drawConnections(winDrawList); }
+    if(mShowIds)
+      { // evaluation stats
+        ImGui::SetCursorPos(Vec2f(10.0f, 10.0f));
+        ImGui::Text("update: %.3f ms (%d nodes, %d branches, %d workers) | drawn: %d nodes", mUpdateTime, (int)mOrder.size(),
+                    (int)mBranches.size(), (mBranchPool ? mBranchPool->size() : 1), (int)mDrawNodes.size());
+      }
 
 
     if(!mLocked)
@@ -753,23 +1237,17 @@ void NodeGraph::draw()
         bool active = false;
         bool hover = false;
         Vec2f offsetMouse = screenToGraph(ImGui::GetMousePos());
-        for(auto n : mNodes)
+        for(auto n : mDrawNodes) // (culled nodes aren't active/hovered)
           {
-            active |= n.second->isActive();
-            hover  |= n.second->isHovered() || n.second->rect().intersection(graphRect).contains(offsetMouse);
+            active |= n->isActive();
+            hover  |= n->isHovered();
           }
+        hover |= (mouseNode && graphRect.contains(offsetMouse));
         
         // DELETE key --> delete selected nodes
         if(!active && ImGui::IsKeyPressed(GLFW_KEY_DELETE))
           {
-            std::vector<int> erased;
-            for(auto n : mNodes) // delete selected nodes
-              {
-                if(n.second->isSelected())
-                  { erased.push_back(n.second->id()); }
-              }
-            for(auto nid : erased)
-              { delete mNodes[nid]; mNodes.erase(nid); mChangedSinceSave = true; }
+            removeNodes(getSelected()); // (deleted when dropped from undo history)
           }
     
         // node selection/highlighting
@@ -836,7 +1314,10 @@ void NodeGraph::draw()
                 // draw selection rect
                 fgDrawList->AddRect(graphToScreen(mSelectRect.p1), graphToScreen(mSelectRect.p2), ImColor(Vec4f(1.0f,1.0f,1.0f,0.5f)), 0.0f, ImDrawCornerFlags_All, 3.0f);
                 // select nodes that intersect selection rect
-                for(auto n : mNodes) { n.second->setSelected((n.second->isSelected() && io.KeyCtrl) || n.second->rect().intersects(mSelectRect)); }
+                if(!io.KeyCtrl) { deselectAll(); }
+                std::vector<int> selectIds;
+                mNodeIndex.query(mSelectRect, selectIds);
+                for(auto id : selectIds) { mNodes[id]->setSelected(true); }
               }
           }
         else
@@ -880,6 +1361,7 @@ void NodeGraph::draw()
                 if(ImGui::IsMouseClicked(ImGuiMouseButton_Left))
                   {
                     addNode(mPlaceNode);
+                    recordAdd({ mPlaceNode });
                     mPlaceNode = nullptr;
                     mPlacing = false;
                     if(ImGui::IsKeyDown(GLFW_KEY_LEFT_SHIFT))
@@ -922,6 +1404,8 @@ void NodeGraph::draw()
                         n->setFirstFrame(true);
                         mNodes.emplace(n->id(), n);
                       }
+                    nodesChanged();
+                    recordAdd(mClipboard);
                     mClipboard.clear();
                     mClipboard = copied;
                     mChangedSinceSave = true;
@@ -983,12 +1467,12 @@ void NodeGraph::draw()
   if(mOpenSave)        { ImGui::OpenPopup("Save File"); mSaveDialogOpen = true; mOpenSave = false; deselectAll(); }
   else if(mOpenLoad)   { ImGui::OpenPopup("Load File"); mLoadDialogOpen = true; mOpenLoad = false; deselectAll(); }
 
-  if(mFileDialog->showFileDialog("Save File", ImGuiFileBrowser::DialogMode::SAVE, FILE_DIALOG_SIZE, ".ags"))
+  if(mFileDialog->showFileDialog("Save File", ImGuiFileBrowser::DialogMode::SAVE, FILE_DIALOG_SIZE, ".ags," PROJECT_BINARY_EXT))
     {
       // fs::path fp = mFileDialog->selected_path;
       std::string path = mFileDialog->selected_path;
       std::string ext = getFileExtension(path);
-      if(ext != ".ags")
+      if(ext != ".ags" && ext != PROJECT_BINARY_EXT)
         {
           std::cout << "EXT: '" << ext << "' --> adding .ags extension...\n";
           path += ".ags"; // fix extension
@@ -1004,7 +1488,7 @@ void NodeGraph::draw()
       //setLocked(false);
     }
 
-  if(mFileDialog->showFileDialog("Load File", ImGuiFileBrowser::DialogMode::OPEN, FILE_DIALOG_SIZE, ".ags"))
+  if(mFileDialog->showFileDialog("Load File", ImGuiFileBrowser::DialogMode::OPEN, FILE_DIALOG_SIZE, ".ags," PROJECT_BINARY_EXT))
     {
       loadFromFile(mFileDialog->selected_path);
       mLoadDialogOpen = false;
@@ -1016,81 +1500,3 @@ void NodeGraph::draw()
       //setLocked(false);
     }
 }
-
-
-
-
-
-// TODO: find path that doesn't intersect any node rects. (recursion?)
-
-#define ORTHO_PADDING (CONNECTOR_SIZE/2.0f + CONNECTOR_PADDING + Vec2f(10.0f, 10.0f))
-#define ORTHO_NODE_PADDING 10.0f
-
-std::vector<Vec2f> NodeGraph::findOrthogonalPath(const Vec2f &start, const Vec2f &end)
-{
-  std::vector<Vec2f> path;
-
-  path.push_back(start);
-
-  Vec2f avg = (start + end)/2.0f;
-
-  if(start.x+ORTHO_PADDING.x <= end.x-ORTHO_PADDING.x && std::abs(start.y - end.y) > 1.0f) // 
-    {
-      // bool collides = false;
-      // Rect2f collideRect;
-      // for(auto n : mNodes)
-      //   {
-      //     if(intersects(n.second->rect(), Vec2f(avg.x, start.y), Vec2f(avg.x, end.y)))
-      //       {
-      //         collides = true;
-      //         collideRect = n.second->rect().expanded(ORTHO_NODE_PADDING);
-      //         break;
-      //       }
-      //   }
-      // if(collides)
-      //   {
-      //     float closerX = (std::abs(collideRect.p2.x - avg.x) < std::abs(collideRect.p1.x - avg.x) ? collideRect.p2.x : collideRect.p1.x);
-      //     path.push_back(Vec2f(closerX, start.y));
-      //     path.push_back(Vec2f(closerX, end.y));
-      //   }
-      // else
-      {
-        path.push_back(Vec2f(avg.x, start.y));
-        path.push_back(Vec2f(avg.x, end.y));
-      }
-    }
-  else if(end.x-ORTHO_PADDING.x <= start.x+ORTHO_PADDING.x)
-    {
-      Vec2f offsetStart = start + Vec2f(ORTHO_PADDING.x, 0);
-      Vec2f offsetEnd   = end   - Vec2f(ORTHO_PADDING.x, 0);
-      
-      // bool collides = false;
-      // Rect2f collideRect;
-      // for(auto n : mNodes)
-      //   {
-      //     if(intersects(n.second->rect(), Vec2f(offsetStart.x, avg.y), Vec2f(offsetEnd.x, avg.y)))
-      //       {
-      //         collides = true;
-      //         collideRect = n.second->rect().expanded(ORTHO_NODE_PADDING);
-      //         break;
-      //       }
-      //   }
-      
-      // if(collides)
-      //   {
-      //     float closerX = (std::abs(collideRect.p2.x - avg.x) < std::abs(collideRect.p1.x - avg.x) ? collideRect.p2.x : collideRect.p1.x);
-      //     path.push_back(Vec2f(closerX, start.y));
-      //     path.push_back(Vec2f(closerX, end.y));
-      //   }
-      // else
-      {
-        path.push_back(offsetStart);
-        path.push_back(Vec2f(offsetStart.x, avg.y));
-        path.push_back(Vec2f(offsetEnd.x, avg.y));
-        path.push_back(offsetEnd);
-      }
-    }
-  
-  path.push_back(end);
-  return path;
-}
@@ -0,0 +1,262 @@
+#include "objectRegistry.hpp"
+using namespace astro;
+
+#include <iostream>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <set>
+
+#include "ephemerisPool.hpp"
+
+
+//// DYNAMIC BITSET ////
+
+void DynamicBitset::resize(int size, bool value)
+{
+  int oldSize = mSize;
+  mSize = size;
+  mWords.resize((size + 63) / 64, 0);
+  if(value)
+    { for(int i = oldSize; i < size; i++) { set(i); } }
+  if(size & 63)
+    { mWords.back() &= (uint64_t(1) << (size & 63)) - 1; } // (clear bits past end)
+}
+
+void DynamicBitset::fill(bool value)
+{
+  std::fill(mWords.begin(), mWords.end(), (value ? ~uint64_t(0) : uint64_t(0)));
+  if(value && (mSize & 63))
+    { mWords.back() &= (uint64_t(1) << (mSize & 63)) - 1; }
+}
+
+int DynamicBitset::count() const
+{
+  int n = 0;
+  for(auto w : mWords) { n += __builtin_popcountll(w); }
+  return n;
+}
+
+bool DynamicBitset::any() const
+{
+  for(auto w : mWords) { if(w) { return true; } }
+  return false;
+}
+
+DynamicBitset& DynamicBitset::operator&=(const DynamicBitset &other)
+{
+  for(int w = 0; w < (int)std::min(mWords.size(), other.mWords.size()); w++)
+    { mWords[w] &= other.mWords[w]; }
+  return *this;
+}
+
+
+//// EXTRA OBJECT ARRAYS ////
+
+void ExtraObjectArrays::resize(int n)
+{
+  longitude.resize(n, 0.0);
+  latitude.resize(n, 0.0);
+  distance.resize(n, 0.0);
+  lonSpeed.resize(n, 0.0);
+  angle.resize(n, 0.0);
+  valid.resize(n, false);
+  visible.resize(n, false);
+}
+
+
+//// OBJECT REGISTRY ////
+
+ObjectRegistry& ObjectRegistry::instance()
+{
+  static ObjectRegistry registry;
+  return registry;
+}
+
+int ObjectRegistry::find(const std::string &name) const
+{
+  for(int i = 0; i < (int)mObjects.size(); i++)
+    { if(mObjects[i].name == name) { return i; } }
+  return -1;
+}
+
+std::shared_ptr<const ObjectList> ObjectRegistry::snapshot() const
+{
+  // (published atomically -- charts updated on graph worker threads may call this concurrently;
+  //  the registry itself is only modified on the main thread outside graph updates)
+  std::shared_ptr<const ObjectList> snapshot = std::atomic_load(&mSnapshot);
+  if(!snapshot || snapshot->version != mVersion)
+    {
+      auto list = std::make_shared<ObjectList>();
+      list->version = mVersion;
+      list->objects = mObjects;
+      std::atomic_store(&mSnapshot, std::shared_ptr<const ObjectList>(list));
+      snapshot = list;
+    }
+  return snapshot;
+}
+
+int ObjectRegistry::addAsteroid(int number, const std::string &name)
+{
+  int sweId = SE_AST_OFFSET + number;
+  for(int i = 0; i < (int)mObjects.size(); i++)
+    { if(mObjects[i].kind == EXTRA_ASTEROID && mObjects[i].sweId == sweId) { return i; } }
+
+  ExtraObject obj;
+  obj.kind  = EXTRA_ASTEROID;
+  obj.sweId = sweId;
+  obj.name  = (name.empty() ? ("Asteroid " + std::to_string(number)) : name);
+  mObjects.push_back(obj);
+  mVersion++;
+  return mObjects.size()-1;
+}
+
+int ObjectRegistry::addStar(const std::string &name, const std::string &nomenclature, double magnitude)
+{
+  std::string key = (nomenclature.empty() ? name : ("," + nomenclature));
+  for(int i = 0; i < (int)mObjects.size(); i++)
+    { if(mObjects[i].kind == EXTRA_STAR && mObjects[i].starKey == key) { return i; } }
+
+  ExtraObject obj;
+  obj.kind      = EXTRA_STAR;
+  obj.name      = (name.empty() ? nomenclature : name);
+  obj.starKey   = key;
+  obj.magnitude = magnitude;
+  mObjects.push_back(obj);
+  mVersion++;
+  return mObjects.size()-1;
+}
+
+void ObjectRegistry::clear()
+{
+  if(!mObjects.empty()) { mObjects.clear(); mVersion++; }
+}
+
+void ObjectRegistry::clear(ExtraObjKind kind)
+{
+  auto end = std::remove_if(mObjects.begin(), mObjects.end(), [kind](const ExtraObject &obj) { return obj.kind == kind; });
+  if(end != mObjects.end()) { mObjects.erase(end, mObjects.end()); mVersion++; }
+}
+
+static std::string trim(const std::string &str)
+{
+  size_t start = str.find_first_not_of(" \t\r");
+  size_t end   = str.find_last_not_of(" \t\r");
+  return (start == std::string::npos ? "" : str.substr(start, end-start+1));
+}
+
+int ObjectRegistry::loadStars(double maxMagnitude, const std::string &path)
+{
+  std::ifstream file(path);
+  if(!file.is_open())
+    {
+      std::cout << "WARNING: Could not open star catalog (" << path << ")\n";
+      return 0;
+    }
+
+  // CSV -- name, nomenclature, frame, ra(h,m,s), dec(d,m,s), pm(ra,dec), radial velocity, parallax, magnitude, ...
+  int count = 0;
+  std::string line;
+  while(std::getline(file, line))
+    {
+      if(line.empty() || line[0] == '#') { continue; }
+      std::vector<std::string> fields;
+      std::stringstream ss(line);
+      for(std::string f; std::getline(ss, f, ',');) { fields.push_back(trim(f)); }
+      if(fields.size() < 14) { continue; }
+
+      double mag = 0.0;
+      std::istringstream(fields[13]) >> mag;
+      if(mag > maxMagnitude) { continue; }
+
+      int n = mObjects.size();
+      addStar(fields[0], fields[1], mag);
+      count += (mObjects.size() > n ? 1 : 0);
+    }
+  return count;
+}
+
+int ObjectRegistry::loadAsteroids(const std::string &path)
+{
+  namespace fs = std::filesystem;
+  std::error_code err;
+  std::set<int> numbers;
+  for(auto &dir : fs::directory_iterator(path, err))
+    {
+      if(!dir.is_directory() || dir.path().filename().string().rfind("ast", 0) != 0) { continue; }
+      for(auto &f : fs::directory_iterator(dir.path(), err))
+        { // se00019s.se1 / se50000.se1 / s123456.se1 --> asteroid number
+          std::string name = f.path().filename().string();
+          if(f.path().extension() != ".se1" || name[0] != 's') { continue; }
+          size_t start = name.find_first_of("0123456789");
+          if(start == std::string::npos) { continue; }
+          int number = std::atoi(name.c_str() + start);
+          if(number > 0) { numbers.insert(number); }
+        }
+    }
+  if(err) { std::cout << "WARNING: Could not read asteroid directories (" << path << ") --> " << err.message() << "\n"; }
+
+  int count = 0;
+  char sname[AS_MAXCH];
+  for(auto number : numbers)
+    {
+      int n = mObjects.size();
+      swe_get_planet_name(SE_AST_OFFSET + number, sname); // (name from ephemeris file header)
+      addAsteroid(number, (std::isdigit(sname[0]) ? "" : sname));
+      count += (mObjects.size() > n ? 1 : 0);
+    }
+  return count;
+}
+
+
+//// OBJECT LIST ////
+
+void ObjectList::calcObjects(double jdEt, long flags, const Location &loc, int begin, int end, ExtraObjectArrays &out) const
+{
+  // set geographic position for calculations (once for all objects)
+  swe_set_topo(loc.longitude, loc.latitude, loc.altitude);
+
+  double data[6];
+  char serr[AS_MAXCH];
+  char star[SE_MAX_STNAME*2+1];
+  for(int i = begin; i < end; i++)
+    {
+      const ExtraObject &obj = objects[i];
+      long result;
+      if(obj.kind == EXTRA_STAR)
+        {
+          strncpy(star, obj.starKey.c_str(), SE_MAX_STNAME*2); // (swe overwrites search key)
+          star[SE_MAX_STNAME*2] = '\0';
+          result = swe_fixstar2(star, jdEt, flags, data, serr);
+        }
+      else
+        { result = swe_calc(jdEt, obj.sweId, flags, data, serr); }
+
+      bool valid = (result >= 0);
+      if(!valid) { std::fill(data, data+6, 0.0); }
+      out.longitude[i] = data[0];
+      out.latitude[i]  = data[1];
+      out.distance[i]  = data[2];
+      out.lonSpeed[i]  = data[3];
+      out.valid.set(i, valid);
+    }
+}
+
+void ObjectList::calcObjects(double jdEt, long flags, const Location &loc, ExtraObjectArrays &out, EphemerisPool *pool) const
+{
+  int n      = objects.size();
+  int chunks = (n + OBJ_REGISTRY_CHUNK-1) / OBJ_REGISTRY_CHUNK;
+  if(pool && chunks > 1)
+    {
+      pool->parallel_for(chunks, [&](Ephemeris &swe, int c)
+      {
+        int begin = c*OBJ_REGISTRY_CHUNK;
+        calcObjects(jdEt, flags, loc, begin, std::min(begin+OBJ_REGISTRY_CHUNK, n), out);
+      });
+    }
+  else
+    { calcObjects(jdEt, flags, loc, 0, n, out); }
+}
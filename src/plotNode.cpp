@@ -6,7 +6,8 @@ using namespace astro;
 
 
 PlotNode::PlotNode()
-  : Node(CONNECTOR_INPUTS(), CONNECTOR_OUTPUTS(), "Plot Node")
+  : Node(CONNECTOR_INPUTS(), CONNECTOR_OUTPUTS(), "Plot Node"),
+    mJob([this](const PlotRequest &request, PlotData &out) { calcPlot(request, out); })
 {
   //setMinSize(Vec2f(1024, 512));
 }
@@ -16,45 +17,88 @@ PlotNode::~PlotNode()
 
 void PlotNode::onUpdate()
 {
-  Chart *chart = inputs()[PLOTNODE_INPUT_CHART]->get<Chart>();
+  std::shared_ptr<const ChartSnapshot> chart = inputs()[PLOTNODE_INPUT_CHART]->snapshot<Chart>();
   // DateTime *dtStartIn = inputs()[PLOTNODE_INPUT_STARTDATE]->get<DateTime>();
   // DateTime *dtEndIn   = inputs()[PLOTNODE_INPUT_ENDDATE]->get<DateTime>();
-  if(chart)
-    { // TODO: May only need to update data points at start and end, or adjust!
-      DateTime dtOrig  = chart->date();
-      DateTime dtStart = dtOrig;
-      DateTime dtEnd   = dtOrig;
-      dtStart.setDay(dtStart.day() - mDayRadius); dtStart.fix();
-      dtEnd.setDay(dtEnd.day() + mDayRadius); dtEnd.fix();
+  if(chart && (chart->version != mLastVersion || chart->settingsVersion != mLastSettings ||
+               mObjType != mLastObjType || mDayRadius != mLastDayRadius))
+    { // plotted on background thread (last complete plot drawn until done)
+      mLastVersion   = chart->version;
+      mLastSettings  = chart->settingsVersion;
+      mLastObjType   = mObjType;
+      mLastDayRadius = mDayRadius;
+
+      PlotRequest request;
+      request.chart     = *chart;
+      request.objType   = mObjType;
+      request.dayRadius = mDayRadius;
+      mJob.request(request);
+    }
+}
+
+void PlotNode::calcPlot(const PlotRequest &request, PlotData &out)
+{ // TODO: May only need to update data points at start and end, or adjust!
+  const ChartSnapshot &chart = request.chart;
+  ObjType objType   = request.objType;
+  int     dayRadius = request.dayRadius;
+  bool settingsChanged = (chart.settingsVersion != mOldSettings);
       
-      if(mObjType != mOldObjType ||
-         (dtStart.year() != mOldStartDate.year()) || (dtStart.month() != mOldStartDate.month()) || (dtStart.day() != mOldStartDate.day()) ||
-         (dtEnd.year()   != mOldEndDate.year())   || (dtEnd.month()   != mOldEndDate.month())   || (dtEnd.day()   != mOldEndDate.day())   ||
-         (chart->getHouseSystem() != mOldChart.getHouseSystem()) ||
-         (chart->getZodiac()      != mOldChart.getZodiac())      ||
-         (chart->getTruePos()     != mOldChart.getTruePos()))
-        {
-          mOldChart.setDate(dtOrig);
-          mOldChart.setLocation(chart->location());
-          mOldChart.setHouseSystem(chart->getHouseSystem());
-          mOldChart.setZodiac(chart->getZodiac());
-          mOldChart.setTruePos(chart->getTruePos());
+  DateTime dtOrig  = chart.date;
+  DateTime dtStart = dtOrig;
+  DateTime dtEnd   = dtOrig;
+  dtStart.setDay(dtStart.day() - dayRadius); dtStart.fix();
+  dtEnd.setDay(dtEnd.day() + dayRadius); dtEnd.fix();
+      
+  if(settingsChanged || objType != mOldObjType || dayRadius != mOldDayRadius ||
+     (dtStart.year() != mOldStartDate.year()) || (dtStart.month() != mOldStartDate.month()) || (dtStart.day() != mOldStartDate.day()) ||
+     (dtEnd.year()   != mOldEndDate.year())   || (dtEnd.month()   != mOldEndDate.month())   || (dtEnd.day()   != mOldEndDate.day())   ||
+     (chart.location != mOldChart.location()))
+    {
+      mOldChart.setSnapshot(chart);
           
-          mData.clear();
-          mData.reserve(2*mDayRadius);
+      mData.clear();
+      mData.reserve(2*dayRadius);
+      if(objType < OBJ_COUNT)
+        { // step julian day directly
+          //  (daily steps are much wider than CHEBY_SWEEP_STEP -- fitting cache segments costs more swe_calc calls than it saves)
+          mOldChart.setDate(dtStart);
+          mOldChart.update();
+          Ephemeris &swe = mOldChart.swe();
+          bool draconic = (mOldChart.getZodiac() == ZODIAC_DRACONIC);
+          ObjMask mask; mask.set(objType); mask.set(OBJ_NORTHNODE, draconic);
+          ObjDataArray objData;
+          double jd = swe.getJulianDayET();
+          long flags = swe.getSweFlags();
+          for(int i = 0; i < 2*dayRadius; i++, jd += 1.0)
+            {
+              swe.calcObjects(jd, mask, flags, objData);
+              double angle = objData.longitude[objType];
+              if(draconic) // set aries 0-degrees to true node
+                { angle = fmod(angle - objData.longitude[OBJ_NORTHNODE] + 360.0, 360.0); }
+              mData.push_back(angle);
+            }
+        }
+      else
+        { // angles depend on houses -- step by date
           DateTime dt = dtStart;
-          for(int i = 0; i < 2*mDayRadius; i++)
+          for(int i = 0; i < 2*dayRadius; i++)
             {
               mOldChart.setDate(dt);
-              mData.push_back(mOldChart.getSingleAngle(mObjType));
+              mData.push_back(mOldChart.getSingleAngle(objType));
               dt.setDay(dt.day()+1); dt.fix();
             }
-          mOldChart.setDate(dtOrig);
-          mOldStartDate = dtStart;
-          mOldEndDate   = dtEnd;
-          mOldObjType   = mObjType;
         }
+      mOldChart.setDate(dtOrig);
+      mOldStartDate = dtStart;
+      mOldEndDate   = dtEnd;
+      mOldObjType   = objType;
+      mOldDayRadius = dayRadius;
+      mOldSettings  = chart.settingsVersion;
     }
+  out.data      = mData;
+  out.startDate = mOldStartDate;
+  out.endDate   = mOldEndDate;
+  out.objType   = mOldObjType;
 }
 
 void PlotNode::onDraw()
@@ -73,16 +117,17 @@ void PlotNode::onDraw()
       for(int o = 0; o < OBJ_END; o++)
         {
           if(ImGui::Selectable(((o == mObjType ? "* " : "") + getObjNameLong((ObjType)o)).c_str()))
-            { mOldObjType = mObjType; mObjType = (ObjType)o; break; }
+            { mObjType = (ObjType)o; break; }
         }
       ImGui::EndCombo();
     }
   
-  if(chart)
+  std::shared_ptr<const PlotData> plot = mJob.result(); // (last complete plot)
+  if(chart && plot)
     {
       Vec2f cursorPos = ImGui::GetCursorScreenPos();
-      std::string overlay = mOldStartDate.toString() + " --> " + mOldEndDate.toString();
-      ImGui::PlotLines(getObjName(mObjType).c_str(), mData.data(), mData.size(), 0, overlay.c_str(), 0.0f, 360.0f, Vec2f(950, 500)*scale);
+      std::string overlay = plot->startDate.toString() + " --> " + plot->endDate.toString();
+      ImGui::PlotLines(getObjName(plot->objType).c_str(), plot->data.data(), plot->data.size(), 0, overlay.c_str(), 0.0f, 360.0f, Vec2f(950, 500)*scale);
       ImGui::GetWindowDrawList()->AddLine(Vec2f(475, 0)*scale + cursorPos, Vec2f(475, 500)*scale + cursorPos, ImColor(Vec4f(1.0f, 0.0f, 0.0f, 1.0f)), 2.0f);
     }
 }
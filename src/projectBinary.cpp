@@ -0,0 +1,240 @@
+#include "projectBinary.hpp"
+using namespace astro;
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include "projectFile.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(sizeof(ProjectBinaryHeader)     % PROJECT_BINARY_ALIGN == 0, "ProjectBinaryHeader must keep tables aligned");
+static_assert(sizeof(ProjectBinaryNode)       % 4 == 0, "unexpected ProjectBinaryNode padding");
+static_assert(sizeof(ProjectBinaryParam)      == 16,    "unexpected ProjectBinaryParam padding");
+static_assert(sizeof(ProjectBinaryConnection) == 16,    "unexpected ProjectBinaryConnection padding");
+
+
+// rounds offset up to table alignment
+static uint64_t alignOffset(uint64_t offset)
+{ return (offset + PROJECT_BINARY_ALIGN-1) & ~(uint64_t)(PROJECT_BINARY_ALIGN-1); }
+
+bool ProjectBinary::isBinary(const std::string &path)
+{
+  std::ifstream f(path, std::ios::in | std::ios::binary);
+  char magic[4] = {0};
+  return (f.read(magic, 4) && std::memcmp(magic, PROJECT_BINARY_MAGIC, 4) == 0);
+}
+
+bool ProjectBinary::write(const ProjectFile &project, const std::string &path)
+{
+  const std::vector<ProjectNode>       &nodes = project.nodes();
+  const std::vector<ProjectConnection> &cons  = project.connections();
+
+  // string blob (repeated strings stored once -- e.g. node types and param keys)
+  std::string strings;
+  std::unordered_map<std::string, ProjectBinaryString> stored;
+  auto addString = [&](const std::string &s)
+  {
+    auto iter = stored.find(s);
+    if(iter != stored.end()) { return iter->second; }
+    ProjectBinaryString bs;
+    bs.offset = strings.size();
+    bs.size   = s.size();
+    strings += s;
+    stored.emplace(s, bs);
+    return bs;
+  };
+
+  ProjectBinaryHeader header{};
+  std::memcpy(header.magic, PROJECT_BINARY_MAGIC, 4);
+  header.formatVersion   = PROJECT_BINARY_VERSION;
+  header.headerSize      = sizeof(ProjectBinaryHeader);
+  header.nodeCount       = nodes.size();
+  header.connectionCount = cons.size();
+  header.centerX         = project.center().x;
+  header.centerY         = project.center().y;
+  header.scale           = project.scale();
+  header.saveVersion     = addString(project.version());
+
+  std::vector<ProjectBinaryNode>  nodeTable(nodes.size());
+  std::vector<ProjectBinaryParam> paramTable;
+  for(int i = 0; i < nodes.size(); i++)
+    {
+      ProjectBinaryNode &bn = nodeTable[i];
+      bn.id         = nodes[i].id;
+      bn.type       = addString(nodes[i].type);
+      bn.name       = addString(nodes[i].name);
+      bn.firstParam = paramTable.size();
+      bn.paramCount = nodes[i].params.size();
+      for(const auto &p : nodes[i].params)
+        {
+          ProjectBinaryParam bp;
+          bp.key   = addString(p.first);
+          bp.value = addString(p.second);
+          paramTable.push_back(bp);
+        }
+    }
+  std::vector<ProjectBinaryConnection> conTable(cons.size());
+  for(int i = 0; i < cons.size(); i++)
+    { conTable[i] = ProjectBinaryConnection{cons[i].outNode, cons[i].outIndex, cons[i].inNode, cons[i].inIndex}; }
+  if(strings.size() > UINT32_MAX)
+    { std::cout << "WARNING: ProjectBinary::write() --> project too large for binary format\n"; return false; }
+
+  header.paramCount       = paramTable.size();
+  header.nodeOffset       = alignOffset(sizeof(ProjectBinaryHeader));
+  header.paramOffset      = alignOffset(header.nodeOffset  + nodeTable.size()*sizeof(ProjectBinaryNode));
+  header.connectionOffset = alignOffset(header.paramOffset + paramTable.size()*sizeof(ProjectBinaryParam));
+  header.stringOffset     = alignOffset(header.connectionOffset + conTable.size()*sizeof(ProjectBinaryConnection));
+  header.stringSize       = strings.size();
+
+  // write sections (zero padding between tables)
+  std::vector<char> data(header.stringOffset + header.stringSize, 0);
+  std::memcpy(data.data(), &header, sizeof(header));
+  if(!nodeTable.empty())  { std::memcpy(data.data() + header.nodeOffset,       nodeTable.data(),  nodeTable.size()*sizeof(ProjectBinaryNode)); }
+  if(!paramTable.empty()) { std::memcpy(data.data() + header.paramOffset,      paramTable.data(), paramTable.size()*sizeof(ProjectBinaryParam)); }
+  if(!conTable.empty())   { std::memcpy(data.data() + header.connectionOffset, conTable.data(),   conTable.size()*sizeof(ProjectBinaryConnection)); }
+  if(!strings.empty())    { std::memcpy(data.data() + header.stringOffset,     strings.data(),    strings.size()); }
+
+  std::ofstream f(path, std::ios::out | std::ios::binary);
+  if(!f) { std::cout << "WARNING: ProjectBinary::write() --> could not open file '" << path << "'\n"; return false; }
+  f.write(data.data(), data.size());
+  return (bool)f;
+}
+
+
+bool ProjectBinary::open(const std::string &path)
+{
+  close();
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) { std::cout << "WARNING: ProjectBinary::open() --> could not open '" << path << "'\n"; return false; }
+  struct stat st;
+  if(fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(ProjectBinaryHeader))
+    {
+      ::close(fd);
+      std::cout << "WARNING: ProjectBinary::open() --> invalid file '" << path << "'\n";
+      return false;
+    }
+  void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // (mapping stays valid)
+  if(data != MAP_FAILED)
+    {
+      mData   = (const char*)data;
+      mSize   = st.st_size;
+      mMapped = true;
+    }
+#endif
+  if(!mData)
+    { // read whole file
+      std::ifstream f(path, std::ios::in | std::ios::binary | std::ios::ate);
+      if(!f) { std::cout << "WARNING: ProjectBinary::open() --> could not open '" << path << "'\n"; return false; }
+      mBuffer.resize(f.tellg());
+      f.seekg(0);
+      f.read(mBuffer.data(), mBuffer.size());
+      mData = mBuffer.data();
+      mSize = mBuffer.size();
+    }
+
+  if(!validate())
+    {
+      std::cout << "WARNING: ProjectBinary::open() --> invalid or corrupt file '" << path << "'\n";
+      close();
+      return false;
+    }
+  return true;
+}
+
+// checks header and that every table/string lies inside the file
+bool ProjectBinary::validate()
+{
+  if(mSize < sizeof(ProjectBinaryHeader)) { return false; }
+  const ProjectBinaryHeader *header = (const ProjectBinaryHeader*)mData;
+  if(std::memcmp(header->magic, PROJECT_BINARY_MAGIC, 4) != 0) { return false; }
+  if(header->formatVersion != PROJECT_BINARY_VERSION)
+    {
+      std::cout << "WARNING: ProjectBinary --> unsupported format version " << header->formatVersion
+                << " (current version: " << PROJECT_BINARY_VERSION << ")\n";
+      return false;
+    }
+  if(header->headerSize != sizeof(ProjectBinaryHeader)) { return false; }
+
+  auto tableFits = [&](uint64_t offset, uint64_t count, uint64_t entrySize)
+  { return (offset % PROJECT_BINARY_ALIGN == 0 && offset <= mSize && count <= (mSize - offset) / entrySize); };
+  if(!tableFits(header->nodeOffset,       header->nodeCount,       sizeof(ProjectBinaryNode))       ||
+     !tableFits(header->paramOffset,      header->paramCount,      sizeof(ProjectBinaryParam))      ||
+     !tableFits(header->connectionOffset, header->connectionCount, sizeof(ProjectBinaryConnection)) ||
+     header->stringOffset > mSize || header->stringSize > mSize - header->stringOffset)
+    { return false; }
+
+  const ProjectBinaryNode  *nodes  = (const ProjectBinaryNode*)(mData + header->nodeOffset);
+  const ProjectBinaryParam *params = (const ProjectBinaryParam*)(mData + header->paramOffset);
+  auto strFits = [&](const ProjectBinaryString &s) { return ((uint64_t)s.offset + s.size <= header->stringSize); };
+  if(!strFits(header->saveVersion)) { return false; }
+  for(uint32_t i = 0; i < header->nodeCount; i++)
+    {
+      const ProjectBinaryNode &n = nodes[i];
+      if(!strFits(n.type) || !strFits(n.name) || (uint64_t)n.firstParam + n.paramCount > header->paramCount)
+        { return false; }
+    }
+  for(uint32_t i = 0; i < header->paramCount; i++)
+    { if(!strFits(params[i].key) || !strFits(params[i].value)) { return false; } }
+
+  mHeader      = header;
+  mNodes       = nodes;
+  mParams      = params;
+  mConnections = (const ProjectBinaryConnection*)(mData + header->connectionOffset);
+  mStrings     = mData + header->stringOffset;
+  return true;
+}
+
+void ProjectBinary::close()
+{
+#ifndef _WIN32
+  if(mMapped && mData) { munmap((void*)mData, mSize); }
+#endif
+  mBuffer.clear();
+  mBuffer.shrink_to_fit();
+  mData = nullptr; mSize = 0; mMapped = false;
+  mHeader = nullptr; mNodes = nullptr; mParams = nullptr; mConnections = nullptr; mStrings = nullptr;
+}
+
+std::string_view ProjectBinary::param(int nodeIndex, std::string_view key) const
+{
+  const ProjectBinaryNode  &n = mNodes[nodeIndex];
+  const ProjectBinaryParam *p = mParams + n.firstParam;
+  for(uint32_t i = 0; i < n.paramCount; i++)
+    { if(str(p[i].key) == key) { return str(p[i].value); } }
+  return std::string_view();
+}
+
+void ProjectBinary::toProject(ProjectFile &project) const
+{
+  project.clear();
+  project.setVersion(std::string(version()));
+  project.setCenter(center());
+  project.setScale(scale());
+  for(int i = 0; i < nodeCount(); i++)
+    {
+      const ProjectBinaryNode &bn = mNodes[i];
+      ProjectNode node;
+      node.id   = bn.id;
+      node.type = std::string(str(bn.type));
+      node.name = std::string(str(bn.name));
+      const ProjectBinaryParam *p = params(i);
+      for(uint32_t j = 0; j < bn.paramCount; j++)
+        { node.params.emplace(std::string(str(p[j].key)), std::string(str(p[j].value))); }
+      project.addNode(node);
+    }
+  for(int i = 0; i < connectionCount(); i++)
+    {
+      const ProjectBinaryConnection &c = mConnections[i];
+      project.addConnection(ProjectConnection{c.outNode, c.outIndex, c.inNode, c.inIndex});
+    }
+}
@@ -0,0 +1,139 @@
+#include "projectFile.hpp"
+using namespace astro;
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+#include "tools.hpp"
+#include "projectBinary.hpp"
+
+
+// (same parsing as Node::fromSaveString)
+std::map<std::string, std::string> ProjectFile::parseNodeParams(const std::string &line)
+{
+  std::map<std::string, std::string> params;
+  std::istringstream ss(line);
+  std::string temp;
+  ss >> temp; // "NODE {"
+  ss.ignore(2, '{');
+  std::string name, value;
+  do
+    {
+      name.clear(); value.clear();
+      ss >> name;
+      ss.ignore(2, ':');
+      ss >> std::quoted(value);
+      ss.ignore(2, ',');
+      if(!name.empty() && name != "\n" && name.find("}") == std::string::npos && value.find("}") == std::string::npos)
+        { params.emplace(name, value); }
+    } while(!name.empty() && name != "\n" && name.find("}") == std::string::npos && value.find("}") == std::string::npos);
+  return params;
+}
+
+void ProjectFile::clear()
+{
+  mVersion = SAVE_FILE_VERSION;
+  mCenter  = Vec2f();
+  mScale   = 1.0f;
+  mNodes.clear();
+  mConnections.clear();
+}
+
+bool ProjectFile::load(const std::string &path)
+{
+  if(!fileExists(path))
+    {
+      std::cout << "WARNING: ProjectFile::load() --> could not find file '" << path << "'\n";
+      return false;
+    }
+  if(ProjectBinary::isBinary(path))
+    {
+      ProjectBinary binary;
+      if(!binary.open(path)) { return false; }
+      binary.toProject(*this);
+      return true;
+    }
+  std::ifstream f(path, std::ios::in);
+  return load(f);
+}
+
+bool ProjectFile::save(const std::string &path) const
+{
+  if(getFileExtension(path) == PROJECT_BINARY_EXT) { return ProjectBinary::write(*this, path); }
+  std::ofstream f(path, std::ios::out);
+  if(!f) { std::cout << "WARNING: ProjectFile::save() --> could not open file '" << path << "'\n"; return false; }
+  save(f);
+  return (bool)f;
+}
+
+// (same format as NodeGraph::saveToFile -- connections from the same output share a CON line)
+void ProjectFile::save(std::ostream &os) const
+{
+  os << "VERSION " << mVersion << "\n";
+  os << "CENTER "  << mCenter  << "\n";
+  os << "SCALE "   << mScale   << "\n";
+  for(const auto &n : mNodes)
+    {
+      os << "NODE { ";
+      for(const auto &p : n.params) { os << p.first << " : " << std::quoted(p.second) << ", "; }
+      os << "}\n";
+    }
+  for(int i = 0; i < mConnections.size(); i++)
+    {
+      const ProjectConnection &con = mConnections[i];
+      if(i == 0 || con.outNode != mConnections[i-1].outNode || con.outIndex != mConnections[i-1].outIndex)
+        { os << (i > 0 ? "\n" : "") << "CON " << con.outNode << " OUTPUT " << con.outIndex; }
+      os << " " << con.inNode << " " << con.inIndex;
+    }
+  if(!mConnections.empty()) { os << "\n"; }
+}
+
+bool ProjectFile::load(std::istream &is)
+{
+  clear();
+  std::string line;
+  while(std::getline(is, line))
+    {
+      if(line.empty() || line == "\n") { continue; }
+      std::istringstream ss(line);
+      std::string lineType;
+      ss >> lineType;
+
+      if(lineType == "VERSION")     { ss >> mVersion; }
+      else if(lineType == "CENTER") { ss >> std::ws >> mCenter; } // (skip space before "<")
+      else if(lineType == "SCALE")  { ss >> mScale; }
+      else if(lineType == "NODE")
+        {
+          ProjectNode node;
+          node.params = parseNodeParams(line);
+          node.type   = node.param("nodeType");
+          node.name   = node.param("nodeName");
+          std::istringstream(node.param("nodeId", "-1")) >> node.id;
+          if(node.id < 0 || node.type.empty())
+            { std::cout << "WARNING: ProjectFile::load() --> skipping invalid node ('" << line << "')\n"; continue; }
+          mNodes.push_back(node);
+        }
+      else if(lineType == "CON")
+        { // CON [outNodeId] OUTPUT [outIndex] ([inNodeId] [inIndex])...
+          ProjectConnection con;
+          std::string io;
+          ss >> con.outNode >> io >> con.outIndex;
+          if(!ss) { std::cout << "WARNING: ProjectFile::load() --> skipping invalid connection ('" << line << "')\n"; continue; }
+          while(ss >> con.inNode >> con.inIndex)
+            { mConnections.push_back(con); }
+        }
+    }
+
+  if(mVersion != SAVE_FILE_VERSION)
+    { std::cout << "WARNING: Save file may be out of date! (version " << mVersion << " | current version: " << SAVE_FILE_VERSION << ")\n"; }
+  return true;
+}
+
+const ProjectNode* ProjectFile::getNode(int id) const
+{
+  for(const auto &n : mNodes)
+    { if(n.id == id) { return &n; } }
+  return nullptr;
+}
@@ -11,6 +11,9 @@ bool SettingBase::draw(float scale, bool busy)
       ImGui::TextUnformatted(mName.c_str());
       ImGui::SameLine(mParent->labelColWidth()*scale);
       ImGui::SetNextItemWidth(mParent->inputColWidth()*scale);
+      busy = onDraw(scale, busy);
+      mEditing = ImGui::IsItemActive();
+      return busy;
     }
   return onDraw(scale, busy);
 }
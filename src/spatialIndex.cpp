@@ -0,0 +1,128 @@
+#include "spatialIndex.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+#define SPATIAL_CELL_LIMIT (1 << 20) // (cell coordinates clamped -- keeps keys valid for huge/invalid rects)
+
+
+Vec2i SpatialIndex::cellOf(const Vec2f &p) const
+{
+  auto cell = [this](float v)
+  {
+    float c = std::floor(v / mCellSize);
+    if(!(c > -SPATIAL_CELL_LIMIT)) { return -SPATIAL_CELL_LIMIT; } // (also NaN)
+    if(c > SPATIAL_CELL_LIMIT)     { return  SPATIAL_CELL_LIMIT; }
+    return (int)c;
+  };
+  return Vec2i(cell(p.x), cell(p.y));
+}
+
+void SpatialIndex::addCells(int id, const Entry &e)
+{
+  for(int x = e.cell1.x; x <= e.cell2.x; x++)
+    for(int y = e.cell1.y; y <= e.cell2.y; y++)
+      { mCells[cellKey(x, y)].push_back(id); }
+}
+
+void SpatialIndex::removeCells(int id, const Entry &e)
+{
+  for(int x = e.cell1.x; x <= e.cell2.x; x++)
+    for(int y = e.cell1.y; y <= e.cell2.y; y++)
+      {
+        auto iter = mCells.find(cellKey(x, y));
+        if(iter == mCells.end()) { continue; }
+        std::vector<int> &ids = iter->second;
+        auto idIter = std::find(ids.begin(), ids.end(), id);
+        if(idIter != ids.end()) { *idIter = ids.back(); ids.pop_back(); } // (order doesn't matter)
+        if(ids.empty()) { mCells.erase(iter); }
+      }
+}
+
+void SpatialIndex::clear()
+{
+  mEntries.clear();
+  mCells.clear();
+}
+
+void SpatialIndex::insert(int id, const Rect2f &rect)
+{
+  if(!update(id, rect))
+    {
+      Entry e;
+      e.rect  = rect.fixed();
+      e.cell1 = cellOf(e.rect.p1);
+      e.cell2 = cellOf(e.rect.p2);
+      addCells(id, e);
+      mEntries.emplace(id, e);
+    }
+}
+
+void SpatialIndex::remove(int id)
+{
+  auto iter = mEntries.find(id);
+  if(iter != mEntries.end())
+    {
+      removeCells(id, iter->second);
+      mEntries.erase(iter);
+    }
+}
+
+bool SpatialIndex::update(int id, const Rect2f &rect)
+{
+  auto iter = mEntries.find(id);
+  if(iter == mEntries.end()) { return false; }
+  Entry &e = iter->second;
+  e.rect = rect.fixed();
+  Vec2i cell1 = cellOf(e.rect.p1);
+  Vec2i cell2 = cellOf(e.rect.p2);
+  if(cell1 != e.cell1 || cell2 != e.cell2)
+    { // moved into different cells
+      removeCells(id, e);
+      e.cell1 = cell1;
+      e.cell2 = cell2;
+      addCells(id, e);
+    }
+  return true;
+}
+
+const Rect2f* SpatialIndex::getRect(int id) const
+{
+  auto iter = mEntries.find(id);
+  return (iter != mEntries.end() ? &iter->second.rect : nullptr);
+}
+
+void SpatialIndex::query(const Rect2f &rect, std::vector<int> &ids) const
+{
+  Rect2f r = rect.fixed();
+  Vec2i cell1 = cellOf(r.p1);
+  Vec2i cell2 = cellOf(r.p2);
+  unsigned long stamp = ++mStamp;
+  if((double)(cell2.x - cell1.x + 1)*(double)(cell2.y - cell1.y + 1) > (double)mCells.size())
+    { // query covers more cells than are occupied -- check every entry instead
+      for(auto &e : mEntries)
+        { if(e.second.rect.intersects(r)) { ids.push_back(e.first); } }
+      return;
+    }
+  for(int x = cell1.x; x <= cell2.x; x++)
+    for(int y = cell1.y; y <= cell2.y; y++)
+      {
+        auto iter = mCells.find(cellKey(x, y));
+        if(iter == mCells.end()) { continue; }
+        for(int id : iter->second)
+          {
+            Entry &e = mEntries[id];
+            if(e.stamp != stamp && e.rect.intersects(r)) { e.stamp = stamp; ids.push_back(id); }
+          }
+      }
+}
+
+void SpatialIndex::queryPoint(const Vec2f &p, std::vector<int> &ids) const
+{
+  Vec2i cell = cellOf(p);
+  auto iter = mCells.find(cellKey(cell.x, cell.y));
+  if(iter == mCells.end()) { return; }
+  for(int id : iter->second)
+    { if(mEntries[id].rect.contains(p)) { ids.push_back(id); } } // (point is in one cell -- no duplicates)
+}
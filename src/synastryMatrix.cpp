@@ -0,0 +1,137 @@
+#include "synastryMatrix.hpp"
+using namespace astro;
+
+#include <algorithm>
+
+#include "chartCompare.hpp"
+#include "ephemerisPool.hpp"
+
+
+//// SYNASTRY SCORE ////
+
+void SynastryScore::add(const ChartAspect &asp)
+{
+  count++;
+  strength += asp.strength;
+  aspCount[asp.type]++;
+  aspStrength[asp.type] += asp.strength;
+}
+
+double SynastryScore::harmony() const
+{
+  return (aspStrength[ASPECT_TRINE] + aspStrength[ASPECT_SEXTILE] +
+          aspStrength[ASPECT_SEMISEXTILE] + aspStrength[ASPECT_NOVILE]);
+}
+
+double SynastryScore::tension() const
+{
+  return (aspStrength[ASPECT_OPPOSITION] + aspStrength[ASPECT_SQUARE] + aspStrength[ASPECT_QUINCUNX] +
+          aspStrength[ASPECT_SESQUIQUADRATE] + aspStrength[ASPECT_OCTILE]);
+}
+
+
+//// SYNASTRY MATRIX ////
+
+void SynastryMatrix::setCharts(const std::vector<Chart*> &charts)
+{
+  if(charts == mCharts) { return; }
+
+  // move cells of charts still in the list to their new indices
+  int k = charts.size();
+  std::vector<int> oldIndex(k);
+  for(int i = 0; i < k; i++) { oldIndex[i] = indexOf(charts[i]); }
+
+  std::vector<Cell> cells(k*k);
+  for(int i = 0; i < k; i++)
+    {
+      for(int j = 0; j < k; j++)
+        {
+          if(oldIndex[i] >= 0 && oldIndex[j] >= 0)
+            { cells[i*k + j] = std::move(cell(oldIndex[i], oldIndex[j])); }
+        }
+    }
+  mCells  = std::move(cells);
+  mCharts = charts;
+  mSweeps.resize(k);
+  mPoints.resize(k);
+  mVersion = Chart::nextVersion();
+}
+
+int SynastryMatrix::indexOf(const Chart *chart) const
+{
+  auto iter = std::find(mCharts.begin(), mCharts.end(), chart);
+  return (iter == mCharts.end() ? -1 : (iter - mCharts.begin()));
+}
+
+void SynastryMatrix::calcRow(int outer)
+{
+  int k = mCharts.size();
+  Cell &d = cell(outer, outer); // (diagonal left empty)
+  if(!d.valid)
+    {
+      d.aspects.clear();
+      d.score    = SynastryScore();
+      d.version1 = d.version2 = mCharts[outer]->version();
+      d.valid    = true;
+    }
+  // only cells right of the diagonal are calculated -- (inner, outer) is written from here as the mirrored cell
+  //  (each row only touches its own upper cells and their mirrors -- rows can still run in parallel)
+  for(int inner = outer+1; inner < k; inner++)
+    {
+      Cell &c = cell(outer, inner);
+      Cell &m = cell(inner, outer);
+      if(c.valid && m.valid) { continue; }
+      ChartCompare::findAspects(mPoints[outer], mPoints[inner], mParams, mSweeps[outer], c.aspects);
+      ChartCompare::mirrorAspects(c.aspects, m.aspects);
+      c.score = SynastryScore();
+      for(const auto &asp : c.aspects) { c.score.add(asp); }
+      m.score    = c.score; // (score is symmetric)
+      c.version1 = m.version2 = mCharts[outer]->version();
+      c.version2 = m.version1 = mCharts[inner]->version();
+      c.valid    = m.valid    = true;
+    }
+}
+
+int SynastryMatrix::update(const ChartParams &params, EphemerisPool *pool)
+{
+  int k = mCharts.size();
+  if(!mParamsValid || !AspectCache::sameParams(params, mParams))
+    { // all cells invalid
+      mParams      = params;
+      mParamsValid = true;
+      for(auto &c : mCells) { c.valid = false; }
+    }
+
+  // find changed cells (and rows that calculate them -- a cell below the diagonal belongs to its mirror's row)
+  int changed = 0;
+  std::vector<int> rows;
+  for(int i = 0; i < k; i++)
+    {
+      int rowChanged = 0;
+      for(int j = i; j < k; j++)
+        {
+          Cell &c = cell(i, j);
+          Cell &m = cell(j, i);
+          if(c.valid && (c.version1 != mCharts[i]->version() || c.version2 != mCharts[j]->version()))
+            { c.valid = false; }
+          if(m.valid && (m.version1 != mCharts[j]->version() || m.version2 != mCharts[i]->version()))
+            { m.valid = false; }
+          rowChanged += (c.valid ? 0 : 1) + (i == j || m.valid ? 0 : 1);
+        }
+      if(rowChanged > 0) { rows.push_back(i); }
+      changed += rowChanged;
+    }
+  if(changed == 0) { return 0; }
+
+  // points of every chart (read by all rows)
+  for(int i = 0; i < k; i++)
+    { ChartCompare::getPoints(mCharts[i], mParams, mPoints[i]); }
+
+  if(pool && rows.size() > 1)
+    { pool->parallel_for(rows.size(), [&](Ephemeris &swe, int r) { calcRow(rows[r]); }); }
+  else
+    { for(int r : rows) { calcRow(r); } }
+
+  mVersion = Chart::nextVersion();
+  return changed;
+}
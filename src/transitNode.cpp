@@ -0,0 +1,209 @@
+#include "transitNode.hpp"
+using namespace astro;
+
+#include <fstream>
+#include <chrono>
+
+#include "imgui.h"
+#include "tools.hpp"
+
+
+TransitNode::TransitNode()
+  : Node(CONNECTOR_INPUTS(), CONNECTOR_OUTPUTS(), "Transit Node"),
+    mJob([this](const SearchRequest &request, SearchResult &result) { runSearch(request, result); })
+{
+  setMinSize(Vec2f(640, 0));
+}
+
+// resolves search range from date inputs
+//  (cached until an input is reconnected/changed, or TRANSITNODE_NOW_REFRESH passes while start date is now)
+bool TransitNode::getRange(Chart *natal, double &jdStart, double &jdEnd)
+{
+  ConnectorBase *startCon = inputs()[TRANSITNODE_INPUT_STARTDATE];
+  ConnectorBase *endCon   = inputs()[TRANSITNODE_INPUT_ENDDATE];
+  DateTime *dtStartIn = startCon->get<DateTime>();
+  DateTime *dtEndIn   = endCon->get<DateTime>();
+  unsigned long startVersion = startCon->snapshotVersion<DateTime>();
+  unsigned long endVersion   = endCon->snapshotVersion<DateTime>();
+  auto t = std::chrono::steady_clock::now();
+  
+  if(!mRange.valid || dtStartIn != mRange.startIn || dtEndIn != mRange.endIn ||
+     startVersion != mRange.startVersion || endVersion != mRange.endVersion || mDays != mRange.days ||
+     (!dtStartIn && std::chrono::duration<double>(t - mRange.resolved).count() > TRANSITNODE_NOW_REFRESH))
+    {
+      Ephemeris &swe = natal->swe();
+      mRange.jdStart      = swe.getJulianDays(dtStartIn ? *dtStartIn : DateTime::now()).et;
+      mRange.jdEnd        = (dtEndIn ? swe.getJulianDays(*dtEndIn).et : mRange.jdStart + mDays);
+      mRange.startIn      = dtStartIn;
+      mRange.endIn        = dtEndIn;
+      mRange.startVersion = startVersion;
+      mRange.endVersion   = endVersion;
+      mRange.days         = mDays;
+      mRange.resolved     = t;
+      mRange.valid        = true;
+    }
+  jdStart = mRange.jdStart;
+  jdEnd   = mRange.jdEnd;
+  return (jdEnd > jdStart);
+}
+
+void TransitNode::search(Chart *natal)
+{
+  double jdStart, jdEnd;
+  mRange.valid = false; // (search from current time)
+  if(!getRange(natal, jdStart, jdEnd)) { mStatus = "Invalid date range"; return; }
+  std::shared_ptr<const ChartSnapshot> snapshot = inputs()[TRANSITNODE_INPUT_CHART]->snapshot<Chart>();
+  if(!snapshot) { mStatus = "Natal chart not updated"; return; }
+
+  SearchRequest request;
+  request.natal   = *snapshot;
+  request.params  = mParams;
+  request.jdStart = jdStart;
+  request.jdEnd   = jdEnd;
+  mJob.request(request); // (last complete result drawn until done)
+  mStatus.clear();
+}
+
+void TransitNode::runSearch(const SearchRequest &request, SearchResult &result)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  mNatal.setSnapshot(request.natal);
+  mNatal.update();
+  mSearch.search(&mNatal, request.params, request.jdStart, request.jdEnd, &EphemerisPool::global());
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+  result.hits          = mSearch.hits();
+  result.natalDate     = request.natal.date;
+  result.natalLocation = request.natal.location;
+  result.jdStart       = request.jdStart;
+  result.jdEnd         = request.jdEnd;
+  result.status        = std::to_string(result.hits.size()) + " transits (" + to_string(ms, 1) + " ms)";
+}
+
+bool TransitNode::exportCsv(Chart *natal, const std::vector<TransitHit> &hits, const std::string &path)
+{
+  std::ofstream f(path, std::ios::out);
+  if(!f.is_open())
+    {
+      std::cout << "WARNING: TransitNode::exportCsv() --> could not open file '" << path << "'\n";
+      return false;
+    }
+  const Ephemeris &swe = natal->swe();
+  f << "transit,aspect,natal,entry,exact,exit,entry_jd_et,exit_jd_et,open_start,open_end\n";
+  for(const auto &hit : hits)
+    {
+      std::string exact;
+      for(int i = 0; i < hit.exactCount; i++)
+        { exact += (i > 0 ? ";" : "") + swe.getDateET(hit.jdExact[i]).toString(); }
+      f << getObjName(hit.transit) << "," << getAspectName(hit.aspect) << "," << getObjName(hit.natal) << ","
+        << swe.getDateET(hit.jdEntry).toString() << "," << exact << "," << swe.getDateET(hit.jdExit).toString() << ","
+        << to_string(hit.jdEntry, 6) << "," << to_string(hit.jdExit, 6) << ","
+        << (hit.openStart ? 1 : 0) << "," << (hit.openEnd ? 1 : 0) << "\n";
+    }
+  return true;
+}
+
+void TransitNode::onUpdate()
+{ }
+
+void TransitNode::onDraw()
+{
+  float scale = getScale();
+  Chart *natal = inputs()[TRANSITNODE_INPUT_CHART]->get<Chart>();
+  ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_FramePadding | ImGuiTreeNodeFlags_Framed;
+
+  if(!natal)
+    { ImGui::TextUnformatted("(connect a natal chart)"); return; }
+
+  // search controls
+  if(!inputs()[TRANSITNODE_INPUT_ENDDATE]->get<DateTime>())
+    {
+      ImGui::TextUnformatted("Days: ");
+      ImGui::SameLine(); ImGui::SetNextItemWidth(120*scale);
+      if(ImGui::InputInt("##days", &mDays, 1, 30)) { mDays = std::max(1, mDays); }
+      ImGui::SameLine();
+    }
+  std::shared_ptr<const SearchResult> result = mJob.result(); // (last complete search)
+  static const std::vector<TransitHit> noHits;
+  const std::vector<TransitHit> &hits = (result ? result->hits : noHits);
+  
+  if(ImGui::Button("Search")) { search(natal); }
+  ImGui::SameLine();
+  if(mJob.busy())          { ImGui::TextUnformatted("Searching..."); }
+  else if(!mStatus.empty()) { ImGui::TextUnformatted(mStatus.c_str()); }
+  else if(result)           { ImGui::TextUnformatted(result->status.c_str()); }
+  if(result)
+    {
+      double jdStart, jdEnd;
+      if(natal->date() != result->natalDate || natal->location() != result->natalLocation ||
+         !getRange(natal, jdStart, jdEnd) || std::abs(jdStart - result->jdStart) > 1.0 || std::abs(jdEnd - result->jdEnd) > 1.0)
+        { ImGui::SameLine(); ImGui::TextUnformatted("(inputs changed)"); }
+    }
+
+  // export
+  ImGui::SetNextItemWidth(360*scale);
+  ImGui::InputText("##exportPath", mExportPath, TRANSITNODE_PATH_BUFLEN);
+  ImGui::SameLine();
+  if(ImGui::Button("Export CSV"))
+    {
+      if(exportCsv(natal, hits, mExportPath)) { mStatus = "Exported " + std::to_string(hits.size()) + " transits"; }
+      else                                    { mStatus = "Export failed"; }
+    }
+
+  // aspects
+  ImGui::SetNextTreeNodeOpen(mAspOpen);
+  if(ImGui::CollapsingHeader("aspects", nullptr, flags))
+    {
+      mAspOpen = true;
+      for(int a = 0; a < ASPECT_COUNT; a++)
+        {
+          bool visible = mParams.aspVisible[a];
+          if(ImGui::Checkbox(getAspectName((AspectType)a).c_str(), &visible)) { mParams.aspVisible[a] = visible; }
+          if(a % 5 != 4) { ImGui::SameLine(); }
+        }
+    }
+  else if(isBodyVisible())
+    { mAspOpen = false; }
+
+  // transit list
+  ImGui::SetNextTreeNodeOpen(mListOpen);
+  if(ImGui::CollapsingHeader("transitList", nullptr, flags))
+    {
+      mListOpen = true;
+      const Ephemeris &swe = natal->swe();
+      ImGui::PushStyleVar(ImGuiStyleVar_ScrollbarSize, ImGui::GetStyle().ScrollbarSize*scale);
+      ImGui::BeginChild("##transitChild", Vec2f(640, 512)*scale);
+      {
+        ImGui::SetWindowFontScale(scale);
+        if(ImGui::BeginTable("##transitCols", 5)) // COLUMNS --> transit(0), aspect(1), natal(2), entry/exit(3), exact(4)
+          {
+            ImGuiListClipper clipper;
+            clipper.Begin(hits.size());
+            while(clipper.Step())
+              {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                  {
+                    const TransitHit &hit = hits[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(getObjName(hit.transit).c_str());
+                    ImGui::TableSetColumnIndex(1); ImGui::TextColored(getAspectInfo(hit.aspect)->color, "%s", getAspectName(hit.aspect).c_str());
+                    ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted(getObjName(hit.natal).c_str());
+                    ImGui::TableSetColumnIndex(3);
+                    ImGui::Text("%s%s -> %s%s", (hit.openStart ? "<" : ""), swe.getDateET(hit.jdEntry).toString(true, false).c_str(),
+                                swe.getDateET(hit.jdExit).toString(true, false).c_str(), (hit.openEnd ? ">" : ""));
+                    ImGui::TableSetColumnIndex(4);
+                    std::string exact;
+                    for(int e = 0; e < hit.exactCount; e++)
+                      { exact += (e > 0 ? ", " : "") + swe.getDateET(hit.jdExact[e]).toString(true, false); }
+                    ImGui::TextUnformatted(exact.c_str());
+                  }
+              }
+            ImGui::EndTable();
+          }
+      }
+      ImGui::EndChild();
+      ImGui::PopStyleVar();
+    }
+  else if(isBodyVisible())
+    { mListOpen = false; }
+}
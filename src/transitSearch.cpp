@@ -0,0 +1,117 @@
+#include "transitSearch.hpp"
+using namespace astro;
+
+#include <cmath>
+#include <algorithm>
+
+
+const std::vector<TransitHit>& TransitSearch::search(Chart *natal, const ChartParams &params, double jdStart, double jdEnd, EphemerisPool *pool)
+{
+  mHits.clear();
+  if(!natal) { return mHits; }
+  if(natal->getZodiac() == ZODIAC_DRACONIC)
+    { std::cout << "WARNING: TransitSearch::search() --> draconic zodiac not supported\n"; return mHits; }
+
+  // transits are geocentric (same zodiac/position flags as natal chart)
+  long flags = (natal->swe().getSweFlags() & ~SEFLG_TOPOCTR);
+  mSearch.setFlags(flags);
+  mSearch.setRange(jdStart, jdEnd);
+  mSearch.clearQueries();
+
+  // fixed target longitudes for each transiting object
+  const int keyCount = OBJ_END*ASPECT_COUNT*2;
+  std::vector<ObjType> transits;
+  std::vector<std::vector<Target>> targets;
+  for(int t = OBJ_SUN; t < OBJ_COUNT; t++)
+    {
+      if(!params.objVisible[t]) { continue; }
+      std::vector<double> longitudes;
+      std::vector<Target> meta;
+      for(int n = OBJ_SUN; n < OBJ_END; n++)
+        {
+          ChartObject *obj = natal->getObject((ObjType)n);
+          if(!params.objVisible[n] || !obj->valid) { continue; }
+          for(int a = 0; a < ASPECT_COUNT; a++)
+            {
+              if(!params.aspVisible[a]) { continue; }
+              double angle = getAspectInfo((AspectType)a)->angle;
+              double orb   = std::min(params.aspOrbs[a], std::min(params.objOrbs[t], params.objOrbs[n]));
+              if(orb <= 0.0) { continue; }
+              for(int side = 0; side < ((angle > 0.0 && angle < 180.0) ? 2 : 1); side++)
+                {
+                  double exact = obj->angle + (side == 0 ? angle : -angle);
+                  int    key   = (n*ASPECT_COUNT + a)*2 + side;
+                  for(int b = -1; b <= 1; b++)
+                    {
+                      longitudes.push_back(exact + b*orb);
+                      meta.push_back(Target{(ObjType)n, (AspectType)a, key, b, exact, orb});
+                    }
+                }
+            }
+        }
+      if(longitudes.empty()) { continue; }
+      mSearch.addCrossings((ObjType)t, longitudes);
+      transits.push_back((ObjType)t);
+      targets.push_back(meta);
+    }
+  if(transits.empty()) { return mHits; }
+
+  // hits already open at start of range
+  ObjMask mask;
+  for(auto t : transits) { mask.set(t); }
+  ObjDataArray data;
+  mSwe.calcObjects(mSearch.rangeStart(), mask, flags, data);
+  std::vector<std::vector<int>> open(transits.size(), std::vector<int>(keyCount, -1)); // (index of open hit)
+  auto openHit = [&](int q, const Target &target, double jd, bool openStart)
+                 {
+                   TransitHit hit;
+                   hit.transit   = transits[q];
+                   hit.natal     = target.natal;
+                   hit.aspect    = target.aspect;
+                   hit.jdEntry   = jd;
+                   hit.openStart = openStart;
+                   open[q][target.key] = mHits.size();
+                   mHits.push_back(hit);
+                 };
+  for(int q = 0; q < transits.size(); q++)
+    {
+      for(const auto &target : targets[q])
+        {
+          if(target.boundary != 0 || !data.valid[transits[q]]) { continue; }
+          if(std::abs(angleDiffSignedDegrees(data.longitude[transits[q]], target.exact)) < target.orb)
+            { openHit(q, target, mSearch.rangeStart(), true); }
+        }
+    }
+
+  // walk crossings in time order (orb edges open/close hits)
+  for(const auto &e : mSearch.search(pool))
+    {
+      const Target &target = targets[e.query][e.index];
+      int &hi = open[e.query][target.key];
+      if(target.boundary == 0)
+        {
+          if(hi >= 0 && mHits[hi].exactCount < TRANSIT_MAX_PASSES)
+            { mHits[hi].jdExact[mHits[hi].exactCount++] = e.jd; }
+        }
+      else if(hi < 0)
+        { openHit(e.query, target, e.jd, false); }
+      else
+        {
+          mHits[hi].jdExit = e.jd;
+          hi = -1;
+        }
+    }
+  // hits still open at end of range
+  for(auto &o : open)
+    {
+      for(auto hi : o)
+        {
+          if(hi < 0) { continue; }
+          mHits[hi].jdExit  = mSearch.rangeEnd();
+          mHits[hi].openEnd = true;
+        }
+    }
+
+  std::stable_sort(mHits.begin(), mHits.end(), [](const TransitHit &h1, const TransitHit &h2) { return h1.jdEntry < h2.jdEntry; });
+  return mHits;
+}
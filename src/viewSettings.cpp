@@ -5,6 +5,8 @@ using namespace astro;
 
 #include "imgui.h"
 #include "glfwKeys.hpp"
+#include "objectRegistry.hpp"
+#include "ephemeris.hpp"
 
 
 ViewSettings::ViewSettings()
@@ -26,9 +28,18 @@ ViewSettings::ViewSettings()
                                  new Setting<bool> ("Draw Lines",       "gDrawLn",  &drawGraphLines),
                                  new Setting<bool> ("Draw Axes",        "gDrawAx",  &drawGraphAxes),
                                  new Setting<Vec2f>("Line Spacing",     "gLnSpace", &graphLineSpacing),
-                                 new Setting<float>("Line Width",       "gLnWidth", &graphLineWidth) }));
+                                 new Setting<float>("Line Width",       "gLnWidth", &graphLineWidth),
+                                 new Setting<int>  ("Worker Threads",   "gThreads", &graphThreads),
+                                 new Setting<int>  ("Undo History",     "gHistory", &graphHistory) }));
   mForm.add(new SettingGroup("Nodes", "node",
                              {   new Setting<Vec4f>("Background Color", "nBgCol",   &nodeBgColor) }));
+  mStarMagSetting = new Setting<float>("Star Magnitude", "cStarMag", &starMagnitude);
+  mForm.add(new SettingGroup("Charts", "chart",
+                             {   new Setting<bool> ("Fixed Stars",      "cStars",   &showStars),
+                                 mStarMagSetting,
+                                 new Setting<bool> ("Asteroids",        "cAst",     &showAsteroids) }));
+  mForm.add(new SettingGroup("Ephemeris", "ephem",
+                             {   new Setting<bool> ("Memory-Mapped Files", "eMmap", &mmapEphemeris) }));
 }
 ViewSettings::~ViewSettings()
 { }
@@ -87,8 +98,41 @@ bool ViewSettings::colorSetting(const std::string &name, const std::string &id,
   return busy;
 }
 
+void ViewSettings::updateObjects()
+{
+  ObjectRegistry &registry = ObjectRegistry::instance();
+  // (reloading clears and re-parses the catalogue, and every chart recalculates its extras -- wait until magnitude edit ends)
+  bool magEditing  = (mState && mStarMagSetting->editing());
+  bool reloadStars = (showStars != mStarsLoaded || (showStars && !magEditing && starMagnitude != mStarsMagnitude));
+  if(reloadStars)
+    {
+      registry.clear(EXTRA_STAR);
+      if(showStars) { registry.loadStars(starMagnitude); }
+      mStarsLoaded    = showStars;
+      mStarsMagnitude = starMagnitude;
+    }
+  if(showAsteroids != mAsteroidsLoaded)
+    {
+      registry.clear(EXTRA_ASTEROID);
+      if(showAsteroids) { registry.loadAsteroids(); }
+      mAsteroidsLoaded = showAsteroids;
+    }
+}
+
+void ViewSettings::updateEphemeris()
+{
+  if(mmapEphemeris != Ephemeris::getMemoryMapped())
+    {
+      Ephemeris::setMemoryMapped(mmapEphemeris);
+      mmapEphemeris = Ephemeris::getMemoryMapped(); // (unsupported --> stays off)
+    }
+}
+
 bool ViewSettings::draw(const Vec2f &frameSize)
 {
+  updateObjects();
+  updateEphemeris();
+
   ImGuiWindowFlags wFlags = (ImGuiWindowFlags_NoMove           |
                              ImGuiWindowFlags_NoTitleBar       |
                              ImGuiWindowFlags_NoResize );